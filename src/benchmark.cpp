@@ -0,0 +1,298 @@
+#include "ray_tracing_lib/all.h"
+
+#include <atomic>
+#include <chrono>
+#include <random>
+
+using namespace NRayTracingLib;
+
+namespace {
+
+// particle-like cloud of small polyhedra spread evenly over a cube
+std::vector<TPolyhedron> createCloud(size_t count, double size) {
+    std::mt19937 generator{1};
+    std::uniform_real_distribution<double> coordinate{-size, size};
+    std::vector<TPolyhedron> cloud;
+    for (size_t i = 0; i < count; i++) {
+        cloud.push_back(createRegularHexahedron(
+            TPoint{coordinate(generator), coordinate(generator), coordinate(generator)}, 0.3));
+    }
+    return cloud;
+}
+
+std::vector<TRay> createRays(size_t count, double size) {
+    std::mt19937 generator{2};
+    std::uniform_real_distribution<double> coordinate{-size, size};
+    std::vector<TRay> rays;
+    for (size_t i = 0; i < count; i++) {
+        const TPoint target{coordinate(generator), coordinate(generator), coordinate(generator)};
+        const TPoint origin{coordinate(generator), coordinate(generator), 3 * size};
+        rays.emplace_back(origin, target - origin);
+    }
+    return rays;
+}
+
+// occlusion measures any hit queries, as shadow rays use them
+void measure(const std::string& name, const TFigure& figure, const std::vector<TRay>& rays, bool occlusion = false) {
+    size_t hits = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (const auto& ray : rays) {
+        hits += (occlusion ? figure.anyHit(ray, 0.0, INF) : figure.hit(ray, 0.0, INF)).has_value();
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    const double seconds = std::chrono::duration<double>(end - start).count();
+    print(name, ":", static_cast<size_t>(rays.size() / seconds), "rays/s,", hits, "hits");
+}
+
+// renders the figure from outside the cloud, unlit or lit by a point and a directional light
+void measurePicture(const std::string& name, const TFigure& figure, double size, bool lit,
+                    const TPhongMaterial& material = {}, TRenderMode mode = TRenderMode::PerPixel,
+                    TPixelOrder order = TPixelOrder::RowMajor, uint16_t resolution = 256) {
+    TCamera camera{TPoint{2 * size, 2 * size, 2 * size}, TVector{-1, -1, -1}, {TAngle{40.0}, TAngle{40.0}},
+                   {resolution, resolution}};
+    camera.setRenderMode(mode);
+    camera.setPixelOrder(order);
+    if (lit) {
+        const double intensity = 4 * size * size;
+        camera.setLights({TLight::point(TPoint{0, 0, 3 * size}, TColor{intensity, intensity, intensity}),
+                          TLight::directional(TVector{1, 2, -3}, TColor{0.3, 0.3, 0.4})});
+        camera.setMaterial(material);
+    }
+    // the camera reports its progress row by row, it is muted while measuring
+    std::streambuf* output = std::cout.rdbuf(nullptr);
+    const auto start = std::chrono::steady_clock::now();
+    camera.makePicture(figure);
+    const auto end = std::chrono::steady_clock::now();
+    std::cout.rdbuf(output);
+    std::cout.clear();
+
+    print(name, ":", std::chrono::duration<double>(end - start).count(), "s for", resolution, "x", resolution, ",",
+          camera.getRenderStats());
+}
+
+// lit progressive pictures within latency budgets: how far refinement gets and how late the picture comes
+void measureProgressive(const TFigure& figure, double size, uint16_t resolution) {
+    TCamera camera{TPoint{2 * size, 2 * size, 2 * size}, TVector{-1, -1, -1}, {TAngle{40.0}, TAngle{40.0}},
+                   {resolution, resolution}};
+    const double intensity = 4 * size * size;
+    camera.setLights({TLight::point(TPoint{0, 0, 3 * size}, TColor{intensity, intensity, intensity})});
+    for (const size_t milliseconds : {0, 50, 200, 1000}) {
+        const auto start = std::chrono::steady_clock::now();
+        const TProgressiveStats stats = camera.makeProgressivePicture(figure, std::chrono::milliseconds{milliseconds});
+        const auto end = std::chrono::steady_clock::now();
+        print("progressive picture within", milliseconds, "ms:", std::chrono::duration<double>(end - start).count(),
+              "s,", stats.PassesCount, "passes, step", stats.Step, ",", stats.TracedPixelsCount, "of",
+              resolution * resolution, "pixels traced");
+    }
+}
+
+// lit picture in Hilbert order with its tiles published: how soon a preview gets the first tile of the picture
+void measureFirstTile(const TFigure& figure, double size, uint16_t resolution) {
+    TCamera camera{TPoint{2 * size, 2 * size, 2 * size}, TVector{-1, -1, -1}, {TAngle{40.0}, TAngle{40.0}},
+                   {resolution, resolution}};
+    const double intensity = 4 * size * size;
+    camera.setLights({TLight::point(TPoint{0, 0, 3 * size}, TColor{intensity, intensity, intensity})});
+    camera.setPixelOrder(TPixelOrder::Hilbert);
+    std::atomic<size_t> tilesCount = 0;
+    std::chrono::steady_clock::time_point firstTile;
+    camera.setTileCallback([&](const TPixelRect&) {
+        if (tilesCount++ == 0) {
+            firstTile = std::chrono::steady_clock::now();
+        }
+    });
+    std::streambuf* output = std::cout.rdbuf(nullptr);
+    const auto start = std::chrono::steady_clock::now();
+    camera.makePicture(figure);
+    const auto end = std::chrono::steady_clock::now();
+    std::cout.rdbuf(output);
+    std::cout.clear();
+
+    print("first of", tilesCount.load(), "tiles published in", std::chrono::duration<double>(firstTile - start).count(),
+          "s, picture done in", std::chrono::duration<double>(end - start).count(), "s");
+}
+
+// lit frames of a camera orbiting the figure, which sits in the middle of the view with empty borders around it
+void measureOrbit(const TFigure& figure, double size, bool costScheduling) {
+    static constexpr size_t FRAMES_COUNT = 16;
+    const auto position = [size](size_t frame) {
+        const double angle = std::numbers::pi * frame / FRAMES_COUNT / 4;
+        return TPoint{4 * size * std::cos(angle), 4 * size * std::sin(angle), 2 * size};
+    };
+    TCamera camera{position(0), TPoint{0, 0, 0} - position(0), {TAngle{40.0}, TAngle{40.0}}, {512, 512}};
+    const double intensity = 4 * size * size;
+    camera.setLights({TLight::point(TPoint{0, 0, 3 * size}, TColor{intensity, intensity, intensity})});
+    camera.setPixelOrder(TPixelOrder::Hilbert);
+    camera.setCostScheduling(costScheduling);
+    std::streambuf* output = std::cout.rdbuf(nullptr);
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t frame = 0; frame < FRAMES_COUNT; frame++) {
+        camera.setPose(position(frame), TPoint{0, 0, 0} - position(frame));
+        camera.makePicture(figure);
+    }
+    const auto end = std::chrono::steady_clock::now();
+    std::cout.rdbuf(output);
+    std::cout.clear();
+
+    print("orbit of", FRAMES_COUNT, "frames", costScheduling ? "costliest tiles first" : "in Hilbert order", ":",
+          std::chrono::duration<double>(end - start).count() / FRAMES_COUNT, "s per frame, last",
+          camera.getSpanCostHistogram(8));
+}
+
+// secondary-like rays starting on the cloud surfaces in random directions
+std::vector<TRay> createSecondaryRays(const TFigure& figure, const std::vector<TRay>& rays) {
+    std::mt19937 generator{5};
+    std::uniform_real_distribution<double> coordinate{-1.0, 1.0};
+    std::vector<TRay> secondary;
+    while (secondary.size() < 200'000) {
+        for (const auto& ray : rays) {
+            const std::optional<THit> hit = figure.hit(ray, 0.0, INF);
+            if (hit.has_value()) {
+                const TVector direction{coordinate(generator), coordinate(generator), coordinate(generator)};
+                secondary.emplace_back(hit.value().Point + hit.value().Normal * 1e-6,
+                                       direction * (direction * hit.value().Normal < 0.0 ? -1.0 : 1.0));
+            }
+        }
+    }
+    return secondary;
+}
+
+// shadow-like occlusion of secondary rays in packets, the sorted order includes the sorting time
+void measureSorting(const TMesh& mesh, std::vector<TRay> rays) {
+    const std::vector<double> tMaxs(rays.size(), 10.0);
+    std::vector<uint8_t> occluded(rays.size());
+    for (const bool sorted : {false, true}) {
+        std::fill(occluded.begin(), occluded.end(), false);
+        const auto start = std::chrono::steady_clock::now();
+        if (sorted) {
+            const std::vector<uint32_t> order = coherentOrder(rays);
+            std::vector<TRay> sortedRays(rays.size());
+            for (size_t i = 0; i < order.size(); i++) {
+                sortedRays[i] = rays[order[i]];
+            }
+            rays = std::move(sortedRays);
+        }
+        mesh.occluded(rays, tMaxs, occluded);
+        const auto end = std::chrono::steady_clock::now();
+        const double seconds = std::chrono::duration<double>(end - start).count();
+        print(sorted ? "sorted" : "unsorted", "secondary rays packet occlusion :",
+              static_cast<size_t>(rays.size() / seconds), "rays/s,",
+              std::count(occluded.begin(), occluded.end(), true), "occluded");
+    }
+
+    std::mt19937 generator{6};
+    std::uniform_int_distribution<uint32_t> key;
+    std::vector<uint32_t> keys(10'000'000);
+    for (auto& value : keys) {
+        value = key(generator);
+    }
+    std::vector<uint32_t> order;
+    for (const size_t threadsCount : {size_t{1}, threadPool().getThreadsCount()}) {
+        const auto start = std::chrono::steady_clock::now();
+        radixSort(keys, order, threadsCount);
+        const auto end = std::chrono::steady_clock::now();
+        const double seconds = std::chrono::duration<double>(end - start).count();
+        print("radix sort of 10M keys on", threadsCount, "threads :", seconds, "s");
+    }
+}
+
+// boxes of small triangles spread over a cube, the polygons themselves are not needed to build a BVH
+std::vector<TBoundingBox> createTriangleBoxes(size_t count, double size) {
+    std::mt19937 generator{3};
+    std::uniform_real_distribution<double> coordinate{-size, size};
+    std::uniform_real_distribution<double> extent{0.0, 0.05};
+    std::vector<TBoundingBox> boxes;
+    boxes.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        const TPoint min{coordinate(generator), coordinate(generator), coordinate(generator)};
+        boxes.emplace_back(min, min + TVector{extent(generator), extent(generator), extent(generator)});
+    }
+    return boxes;
+}
+
+} // namespace
+
+int main() {
+    try {
+        const double size = 20.0;
+        const std::vector<TPolyhedron> cloud = createCloud(2000, size);
+        const std::vector<TRay> rays = createRays(20000, size);
+
+        TFigureSet figures;
+        std::vector<TPolygon> polygons;
+        for (const auto& polyhedron : cloud) {
+            figures.add(polyhedron);
+            polygons.insert(polygons.end(), polyhedron.getFaces().begin(), polyhedron.getFaces().end());
+        }
+        const TUniformGrid grid{polygons};
+        const TSpatialHashGrid hashGrid{polygons};
+        const TMesh mesh{polygons, threadPool().getThreadsCount(), TBvhLayout::Binary};
+        const TMesh wideMesh{polygons, threadPool().getThreadsCount(), TBvhLayout::CompressedWide};
+        print("thread pool:", threadPool().getThreadsCount(), "threads on", threadPool().getNodesCount(), "NUMA nodes");
+        print("mesh BVH:", mesh.getBvh().getStats());
+        print("binary BVH:", mesh.getBvh().getNodes().size(), "nodes of", sizeof(TBvhNode), "bytes,",
+              mesh.getBvh().getMemorySize(), "bytes total");
+        print("compressed wide BVH:", wideMesh.getWideBvh().getNodes().size(), "nodes of", sizeof(TWideBvhNode),
+              "bytes,", wideMesh.getWideBvh().getMemorySize(), "bytes total");
+
+        measure("figure set", figures, rays);
+        measure("uniform grid", grid, rays);
+        measure("spatial hash grid", hashGrid, rays);
+        measure("mesh binary BVH", mesh, rays);
+        measure("mesh compressed wide BVH", wideMesh, rays);
+        measure("mesh compressed wide BVH occlusion", wideMesh, rays, true);
+        measureSorting(mesh, createSecondaryRays(mesh, rays));
+        measurePicture("unlit picture", wideMesh, size, false);
+        measurePicture("lit picture, 2 lights", wideMesh, size, true);
+        measurePicture("lit mirror cubes", wideMesh, size, true, TPhongMaterial::mirror());
+        measurePicture("lit glass cubes", wideMesh, size, true, TPhongMaterial::glass());
+        measurePicture("wavefront unlit picture", wideMesh, size, false, {}, TRenderMode::Wavefront);
+        measurePicture("wavefront lit glass cubes", wideMesh, size, true, TPhongMaterial::glass(),
+                       TRenderMode::Wavefront);
+        measureOrbit(wideMesh, size, false);
+        measureOrbit(wideMesh, size, true);
+
+        const auto dodecahedron = std::make_shared<const TPolyhedron>(createRegularDodecahedron(TPoint{0, 0, 0}, 0.3));
+        std::mt19937 generator{4};
+        std::uniform_real_distribution<double> coordinate{-size, size};
+        std::vector<TInstance> instances;
+        for (size_t i = 0; i < 10'000; i++) {
+            const TVector position{coordinate(generator), coordinate(generator), coordinate(generator)};
+            instances.emplace_back(dodecahedron, TTransform::translation(position));
+        }
+        const TScene scene{instances};
+        print("10000 dodecahedron instances:", sizeof(TInstance), "bytes per instance, one shared",
+              sizeof(TPolyhedron) + dodecahedron->getFaces().size() * sizeof(TPolygon), "bytes figure");
+        measure("instanced scene", scene, rays);
+        measure("instanced scene occlusion", scene, rays, true);
+
+        // a scene whose polygons and nodes do not fit into the caches, pixel orders keep nearby rays together
+        std::vector<TPolygon> largePolygons;
+        for (const auto& polyhedron : createCloud(100'000, size)) {
+            largePolygons.insert(largePolygons.end(), polyhedron.getFaces().begin(), polyhedron.getFaces().end());
+        }
+        const TMesh largeMesh{largePolygons};
+        for (const auto& [name, order] : {std::pair{"row-major", TPixelOrder::RowMajor},
+                                          std::pair{"Morton", TPixelOrder::Morton},
+                                          std::pair{"Hilbert", TPixelOrder::Hilbert}}) {
+            for (const bool lit : {false, true}) {
+                measurePicture(std::string{"600k polygons "} + (lit ? "lit" : "unlit") + " picture, " + name + " order",
+                               largeMesh, size, lit, {}, TRenderMode::PerPixel, order, 1024);
+            }
+        }
+        measureProgressive(largeMesh, size, 1024);
+        measureFirstTile(largeMesh, size, 1024);
+
+        std::vector<TBoundingBox> boxes = createTriangleBoxes(1'000'000, size);
+        TBvh bvh{boxes};
+        print("1M triangles BVH on", threadPool().getThreadsCount(), "threads:", bvh.getStats());
+        for (auto& box : boxes) {
+            box = TBoundingBox{box.Min + TVector{0.1, 0, 0}, box.Max + TVector{0.1, 0, 0}};
+        }
+        const bool rebuilt = bvh.update(boxes);
+        print("1M triangles BVH refit:", bvh.getStats().RefitSeconds, "s, rebuilt =", rebuilt);
+
+    } catch (const std::exception& e) {
+        print(e.what());
+    }
+}
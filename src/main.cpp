@@ -24,7 +24,8 @@ int main() {
                 {1000, 1000},
             };
 
-            const TPolyhedron figure = createRegularDodecahedron(TPoint{0.0, 0.0, 0.0}, 1.0);
+            TPolyhedron figure = createRegularDodecahedron(TPoint{0.0, 0.0, 0.0}, 1.0);
+            figure.setBackFaceCulling(true);
             camera.makePicture(figure);
 
             char filename[256];
@@ -1,13 +1,31 @@
 #pragma once
 
 #include "angle.h"
+#include "bounds.h"
+#include "bvh.h"
 #include "camera.h"
 #include "edge.h"
 #include "figure.h"
+#include "figure_set.h"
+#include "frustum.h"
+#include "grid.h"
+#include "instance.h"
+#include "light.h"
 #include "line.h"
+#include "mesh.h"
+#include "mpsc_queue.h"
+#include "parallel.h"
+#include "pixel_order.h"
 #include "plane.h"
 #include "point.h"
 #include "polygon.h"
 #include "polyhedron.h"
+#include "progressive.h"
+#include "ray_batch.h"
+#include "ray_sort.h"
+#include "render_async.h"
 #include "safe_double.h"
+#include "transform.h"
 #include "vector.h"
+#include "wavefront.h"
+#include "wide_bvh.h"
@@ -0,0 +1,134 @@
+#include "bounds.h"
+
+namespace NRayTracingLib {
+
+TBoundingBox::TBoundingBox() : Min{INF, INF, INF}, Max{-INF, -INF, -INF} {}
+TBoundingBox::TBoundingBox(const TPoint& min, const TPoint& max) : Min(min), Max(max) {}
+
+TBoundingBox TBoundingBox::infinite() { return TBoundingBox{TPoint{-INF, -INF, -INF}, TPoint{INF, INF, INF}}; }
+
+void TBoundingBox::extend(const TPoint& point) {
+    Min = TPoint{std::min(Min.X.Value, point.X.Value), std::min(Min.Y.Value, point.Y.Value),
+                 std::min(Min.Z.Value, point.Z.Value)};
+    Max = TPoint{std::max(Max.X.Value, point.X.Value), std::max(Max.Y.Value, point.Y.Value),
+                 std::max(Max.Z.Value, point.Z.Value)};
+}
+void TBoundingBox::extend(const TBoundingBox& other) {
+    if (!other.isEmpty()) {
+        extend(other.Min);
+        extend(other.Max);
+    }
+}
+
+bool TBoundingBox::isEmpty() const {
+    return Min.X.Value > Max.X.Value || Min.Y.Value > Max.Y.Value || Min.Z.Value > Max.Z.Value;
+}
+bool TBoundingBox::isInfinite() const {
+    for (const double coordinate : {Min.X.Value, Min.Y.Value, Min.Z.Value, Max.X.Value, Max.Y.Value, Max.Z.Value}) {
+        if (std::isinf(coordinate)) {
+            return true;
+        }
+    }
+    return false;
+}
+TPoint TBoundingBox::center() const {
+    return TPoint{(Min.X.Value + Max.X.Value) / 2.0, (Min.Y.Value + Max.Y.Value) / 2.0,
+                  (Min.Z.Value + Max.Z.Value) / 2.0};
+}
+TVector TBoundingBox::diagonal() const {
+    return TVector{Max.X.Value - Min.X.Value, Max.Y.Value - Min.Y.Value, Max.Z.Value - Min.Z.Value};
+}
+TSafeDouble TBoundingBox::surfaceArea() const {
+    if (isEmpty()) {
+        return 0.0;
+    }
+    const TVector size = diagonal();
+    return 2.0 * (size.X.Value * size.Y.Value + size.Y.Value * size.Z.Value + size.Z.Value * size.X.Value);
+}
+
+bool TBoundingBox::intersects(const TPoint& origin, const TVector& direction, TSafeDouble tMin,
+                              TSafeDouble tMax) const {
+    return clip(origin, direction, tMin, tMax).has_value();
+}
+std::optional<std::pair<double, double>> TBoundingBox::clip(const TPoint& origin, const TVector& direction,
+                                                            TSafeDouble tMin, TSafeDouble tMax) const {
+    // plain doubles on purpose: division by a zero direction coordinate must give an infinity, not an error
+    const double origins[3] = {origin.X.Value, origin.Y.Value, origin.Z.Value};
+    const double directions[3] = {direction.X.Value, direction.Y.Value, direction.Z.Value};
+    const double mins[3] = {Min.X.Value - ACCURACY, Min.Y.Value - ACCURACY, Min.Z.Value - ACCURACY};
+    const double maxs[3] = {Max.X.Value + ACCURACY, Max.Y.Value + ACCURACY, Max.Z.Value + ACCURACY};
+
+    double tNear = tMin.Value;
+    double tFar = tMax.Value;
+    for (size_t axis = 0; axis < 3; axis++) {
+        if (directions[axis] == 0.0) {
+            if (origins[axis] < mins[axis] || origins[axis] > maxs[axis]) {
+                return std::nullopt;
+            }
+            continue;
+        }
+        const double inverse = 1.0 / directions[axis];
+        double t1 = (mins[axis] - origins[axis]) * inverse;
+        double t2 = (maxs[axis] - origins[axis]) * inverse;
+        if (t1 > t2) {
+            std::swap(t1, t2);
+        }
+        tNear = std::max(tNear, t1);
+        tFar = std::min(tFar, t2);
+        if (tNear > tFar) {
+            return std::nullopt;
+        }
+    }
+    return std::make_pair(tNear, tFar);
+}
+
+std::ostream& operator<<(std::ostream& os, const TBoundingBox& box) {
+    return os << "bounding box:\n" << box.Min << box.Max;
+}
+
+TBoundingSphere::TBoundingSphere() : Radius(0.0) {}
+TBoundingSphere::TBoundingSphere(const TPoint& center, TSafeDouble radius) : Center(center), Radius(radius) {
+    if (radius < 0.0) {
+        throw std::runtime_error("Error: creating bounding sphere with radius < 0");
+    }
+}
+
+TBoundingSphere TBoundingSphere::infinite() { return TBoundingSphere{TPoint{0.0, 0.0, 0.0}, INF}; }
+
+bool TBoundingSphere::intersects(const TPoint& origin, const TVector& direction, TSafeDouble tMin,
+                                 TSafeDouble tMax) const {
+    if (std::isinf(Radius.Value)) {
+        return true;
+    }
+    // squared distance from the center to the nearest point of the line piece, no square root needed
+    const TVector toCenter = Center - origin;
+    const double directionSquare = (direction * direction).Value;
+    const double tClosest = std::clamp((toCenter * direction).Value / directionSquare, tMin.Value, tMax.Value);
+    const TVector fromClosest = toCenter - direction * tClosest;
+    return (fromClosest * fromClosest).Value <= Radius.Value * Radius.Value + ACCURACY;
+}
+
+TBounds::TBounds() {}
+TBounds::TBounds(const std::vector<TPoint>& points, TSafeDouble margin) {
+    for (const auto& point : points) {
+        Box.extend(point);
+    }
+    const TVector inflation{margin, margin, margin};
+    Box = TBoundingBox{Box.Min + (-inflation), Box.Max + inflation};
+
+    double radius = 0.0;
+    const TPoint center = Box.center();
+    for (const auto& point : points) {
+        radius = std::max(radius, center.distToPoint(point).Value);
+    }
+    Sphere = TBoundingSphere{center, radius + margin.Value};
+}
+TBounds::TBounds(const TBoundingBox& box)
+    : Box(box),
+      Sphere(box.isEmpty()      ? TBoundingSphere{}
+             : box.isInfinite() ? TBoundingSphere::infinite()
+                                : TBoundingSphere{box.center(), box.diagonal().length() / 2.0}) {}
+
+TBounds TBounds::infinite() { return TBounds{TBoundingBox::infinite()}; }
+
+} // namespace NRayTracingLib
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "common.h"
+#include "point.h"
+#include "vector.h"
+
+namespace NRayTracingLib {
+
+class TBoundingBox {
+  public:
+    TPoint Min, Max;
+
+    // empty box, extending it by a point gives the box of this point
+    TBoundingBox();
+    explicit TBoundingBox(const TPoint& min, const TPoint& max);
+
+    static TBoundingBox infinite();
+
+    void extend(const TPoint& point);
+    void extend(const TBoundingBox& other);
+
+    bool isEmpty() const;
+    bool isInfinite() const;
+    TPoint center() const;
+    TVector diagonal() const;
+    TSafeDouble surfaceArea() const;
+
+    // slab test: whether some point origin + direction * T with T in [tMin, tMax] lies in the box
+    bool intersects(const TPoint& origin, const TVector& direction, TSafeDouble tMin, TSafeDouble tMax) const;
+    // the same test returning the part of [tMin, tMax] inside the box
+    std::optional<std::pair<double, double>> clip(const TPoint& origin, const TVector& direction, TSafeDouble tMin,
+                                                  TSafeDouble tMax) const;
+
+    friend std::ostream& operator<<(std::ostream& os, const TBoundingBox& box);
+};
+
+class TBoundingSphere {
+  public:
+    TPoint Center;
+    TSafeDouble Radius;
+
+    TBoundingSphere();
+    explicit TBoundingSphere(const TPoint& center, TSafeDouble radius);
+
+    static TBoundingSphere infinite();
+
+    // whether some point origin + direction * T with T in [tMin, tMax] lies in the sphere
+    bool intersects(const TPoint& origin, const TVector& direction, TSafeDouble tMin, TSafeDouble tMax) const;
+};
+
+class TBounds {
+  public:
+    TBoundingBox Box;
+    TBoundingSphere Sphere;
+
+    TBounds();
+    // box of the points and sphere around its center, both inflated by margin
+    explicit TBounds(const std::vector<TPoint>& points, TSafeDouble margin = 0.0);
+    explicit TBounds(const TBoundingBox& box);
+
+    static TBounds infinite();
+};
+
+} // namespace NRayTracingLib
@@ -0,0 +1,392 @@
+#include "bvh.h"
+#include "parallel.h"
+
+#include <atomic>
+#include <chrono>
+
+namespace NRayTracingLib {
+
+static constexpr size_t BVH_BINS_COUNT = 16;
+static constexpr size_t BVH_MAX_LEAF_SIZE = 8;
+// a primitive test is a polygon hit, which costs a few node slab tests
+static constexpr double BVH_TRAVERSAL_COST = 1.0;
+static constexpr double BVH_INTERSECTION_COST = 2.0;
+// nodes smaller than this are binned by one thread, splitting them further is cheaper than the threads start
+static constexpr size_t BVH_PARALLEL_BINNING_MIN_SIZE = 1 << 14;
+static constexpr size_t BVH_SUBTREE_TASK_MIN_SIZE = 1 << 10;
+static constexpr size_t BVH_REFIT_CHUNK_MIN_SIZE = 1 << 12;
+
+TBvhRay::TBvhRay(const TPoint& origin, const TVector& direction)
+    : Origin{origin.X.Value, origin.Y.Value, origin.Z.Value},
+      InverseDirection{1.0 / direction.X.Value, 1.0 / direction.Y.Value, 1.0 / direction.Z.Value} {}
+
+TBoundingBox TBvhNode::box() const {
+    return TBoundingBox{TPoint{Min[0], Min[1], Min[2]}, TPoint{Max[0], Max[1], Max[2]}};
+}
+
+std::ostream& operator<<(std::ostream& os, const TBvhStats& stats) {
+    os << "build time = " << stats.BuildSeconds << " s, SAH cost = " << stats.SahCost
+       << ", nodes = " << stats.NodesCount << ", leaves = " << stats.LeavesCount << ", depth = " << stats.Depth
+       << ", leaf size = " << stats.MinLeafSize << ".." << stats.MaxLeafSize << " (" << stats.AverageLeafSize
+       << " on average), refits = " << stats.RefitsCount << " (last " << stats.RefitSeconds
+       << " s), rebuilds = " << stats.RebuildsCount;
+    return os;
+}
+
+// box over plain doubles for the builder, its extend is called a few times per primitive and level
+class TBinBox {
+  public:
+    std::array<double, 3> Min = {INF, INF, INF};
+    std::array<double, 3> Max = {-INF, -INF, -INF};
+
+    TBinBox() {}
+    explicit TBinBox(const TBoundingBox& box)
+        : Min{box.Min.X.Value, box.Min.Y.Value, box.Min.Z.Value},
+          Max{box.Max.X.Value, box.Max.Y.Value, box.Max.Z.Value} {}
+    explicit TBinBox(const TBvhNode& node) : Min(node.Min), Max(node.Max) {}
+
+    void extend(const std::array<double, 3>& point) {
+        for (size_t axis = 0; axis < 3; axis++) {
+            Min[axis] = std::min(Min[axis], point[axis]);
+            Max[axis] = std::max(Max[axis], point[axis]);
+        }
+    }
+    void extend(const TBinBox& other) {
+        for (size_t axis = 0; axis < 3; axis++) {
+            Min[axis] = std::min(Min[axis], other.Min[axis]);
+            Max[axis] = std::max(Max[axis], other.Max[axis]);
+        }
+    }
+    double surfaceArea() const {
+        if (Min[0] > Max[0]) {
+            return 0.0;
+        }
+        const double x = Max[0] - Min[0];
+        const double y = Max[1] - Min[1];
+        const double z = Max[2] - Min[2];
+        return 2.0 * (x * y + y * z + z * x);
+    }
+};
+
+class TBin {
+  public:
+    TBinBox Box;
+    size_t Count = 0;
+};
+
+using TAxisBins = std::array<std::array<TBin, BVH_BINS_COUNT>, 3>;
+
+class TBvhBuilder {
+  public:
+    explicit TBvhBuilder(const std::vector<TBoundingBox>& boxes, size_t threadsCount, std::vector<TBvhNode>& nodes,
+                         std::vector<uint32_t>& primitives)
+        : ThreadsCount_(std::max<size_t>(threadsCount, 1)), Nodes_(nodes), Primitives_(primitives) {
+        Boxes_.resize(boxes.size());
+        Centroids_.resize(boxes.size());
+        for (size_t i = 0; i < boxes.size(); i++) {
+            Boxes_[i] = TBinBox{boxes[i]};
+            for (size_t axis = 0; axis < 3; axis++) {
+                Centroids_[i][axis] = 0.5 * (Boxes_[i].Min[axis] + Boxes_[i].Max[axis]);
+            }
+        }
+    }
+
+    void build() {
+        Primitives_.resize(Boxes_.size());
+        for (size_t i = 0; i < Primitives_.size(); i++) {
+            Primitives_[i] = static_cast<uint32_t>(i);
+        }
+        // a binary tree with leaves of at least one primitive has at most 2N - 1 nodes, so the array never moves
+        Nodes_.resize(2 * Boxes_.size() - 1);
+        NodesUsed_ = 1;
+        buildNode(0, 0, static_cast<uint32_t>(Boxes_.size()), 0);
+        Nodes_.resize(NodesUsed_);
+    }
+
+  private:
+    std::vector<TBinBox> Boxes_;
+    std::vector<std::array<double, 3>> Centroids_;
+    size_t ThreadsCount_;
+    std::vector<TBvhNode>& Nodes_;
+    std::vector<uint32_t>& Primitives_;
+    std::atomic<uint32_t> NodesUsed_ = 0;
+
+    static size_t binOf(double centroid, double min, double scale) {
+        return std::min(static_cast<size_t>((centroid - min) * scale), BVH_BINS_COUNT - 1);
+    }
+
+    void makeLeaf(TBvhNode& node, uint32_t begin, uint32_t end) {
+        node.First = begin;
+        node.Count = end - begin;
+    }
+
+    void buildNode(uint32_t nodeIdx, uint32_t begin, uint32_t end, size_t depth) {
+        TBvhNode& node = Nodes_[nodeIdx];
+        const uint32_t count = end - begin;
+        // nodes of one level are built concurrently, so threads are shared among them
+        const size_t levelWidth = depth < 32 ? size_t{1} << depth : ThreadsCount_;
+        const size_t chunksCount =
+            count >= BVH_PARALLEL_BINNING_MIN_SIZE ? std::max<size_t>(ThreadsCount_ / levelWidth, 1) : 1;
+
+        std::vector<TBinBox> nodeBoxes(chunksCount);
+        std::vector<TBinBox> centroidBoxes(chunksCount);
+        forChunks(begin, end, chunksCount, [&](uint32_t chunkBegin, uint32_t chunkEnd, size_t chunk) {
+            for (uint32_t i = chunkBegin; i < chunkEnd; i++) {
+                nodeBoxes[chunk].extend(Boxes_[Primitives_[i]]);
+                centroidBoxes[chunk].extend(Centroids_[Primitives_[i]]);
+            }
+        });
+        TBinBox nodeBox;
+        TBinBox centroidBox;
+        for (size_t chunk = 0; chunk < chunksCount; chunk++) {
+            nodeBox.extend(nodeBoxes[chunk]);
+            centroidBox.extend(centroidBoxes[chunk]);
+        }
+        node.Min = nodeBox.Min;
+        node.Max = nodeBox.Max;
+
+        if (count == 1 || depth + 1 >= BVH_MAX_DEPTH) {
+            makeLeaf(node, begin, end);
+            return;
+        }
+
+        std::array<double, 3> scales;
+        for (size_t axis = 0; axis < 3; axis++) {
+            const double extent = centroidBox.Max[axis] - centroidBox.Min[axis];
+            scales[axis] = extent > 0.0 ? BVH_BINS_COUNT / extent : 0.0;
+        }
+
+        std::vector<TAxisBins> chunkBins(chunksCount);
+        forChunks(begin, end, chunksCount, [&](uint32_t chunkBegin, uint32_t chunkEnd, size_t chunk) {
+            for (uint32_t i = chunkBegin; i < chunkEnd; i++) {
+                const uint32_t primitive = Primitives_[i];
+                for (size_t axis = 0; axis < 3; axis++) {
+                    TBin& bin = chunkBins[chunk][axis][binOf(Centroids_[primitive][axis], centroidBox.Min[axis],
+                                                             scales[axis])];
+                    bin.Box.extend(Boxes_[primitive]);
+                    bin.Count++;
+                }
+            }
+        });
+        TAxisBins bins = chunkBins[0];
+        for (size_t chunk = 1; chunk < chunksCount; chunk++) {
+            for (size_t axis = 0; axis < 3; axis++) {
+                for (size_t b = 0; b < BVH_BINS_COUNT; b++) {
+                    bins[axis][b].Box.extend(chunkBins[chunk][axis][b].Box);
+                    bins[axis][b].Count += chunkBins[chunk][axis][b].Count;
+                }
+            }
+        }
+
+        // sweep every axis: split after bin b puts bins [0, b] to the left child
+        const double nodeArea = nodeBox.surfaceArea();
+        double bestCost = INF;
+        size_t bestAxis = 3;
+        size_t bestBin = 0;
+        for (size_t axis = 0; axis < 3; axis++) {
+            if (scales[axis] == 0.0) {
+                continue;
+            }
+            std::array<double, BVH_BINS_COUNT> rightAreas;
+            std::array<size_t, BVH_BINS_COUNT> rightCounts;
+            TBinBox rightBox;
+            size_t rightCount = 0;
+            for (size_t b = BVH_BINS_COUNT - 1; b > 0; b--) {
+                rightBox.extend(bins[axis][b].Box);
+                rightCount += bins[axis][b].Count;
+                rightAreas[b] = rightBox.surfaceArea();
+                rightCounts[b] = rightCount;
+            }
+            TBinBox leftBox;
+            size_t leftCount = 0;
+            for (size_t b = 0; b + 1 < BVH_BINS_COUNT; b++) {
+                leftBox.extend(bins[axis][b].Box);
+                leftCount += bins[axis][b].Count;
+                if (leftCount == 0 || rightCounts[b + 1] == 0) {
+                    continue;
+                }
+                const double cost = BVH_TRAVERSAL_COST + BVH_INTERSECTION_COST *
+                                                             (leftBox.surfaceArea() * leftCount +
+                                                              rightAreas[b + 1] * rightCounts[b + 1]) /
+                                                             nodeArea;
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestBin = b;
+                }
+            }
+        }
+
+        const double leafCost = BVH_INTERSECTION_COST * count;
+        if (count <= BVH_MAX_LEAF_SIZE && (bestAxis == 3 || bestCost >= leafCost)) {
+            makeLeaf(node, begin, end);
+            return;
+        }
+
+        uint32_t middle = begin + count / 2;
+        if (bestAxis != 3) {
+            const auto split = std::partition(
+                Primitives_.begin() + begin, Primitives_.begin() + end, [&](uint32_t primitive) {
+                    return binOf(Centroids_[primitive][bestAxis], centroidBox.Min[bestAxis], scales[bestAxis]) <=
+                           bestBin;
+                });
+            middle = static_cast<uint32_t>(split - Primitives_.begin());
+        }
+        // otherwise all centroids coincide and any split of the too large leaf is as good as another
+
+        const uint32_t left = NodesUsed_.fetch_add(2);
+        node.First = left;
+        node.Count = 0;
+
+        if (ThreadsCount_ > 1 && count >= BVH_SUBTREE_TASK_MIN_SIZE && levelWidth < 4 * ThreadsCount_) {
+            threadPool().run(2, [&](size_t child) {
+                if (child == 0) {
+                    buildNode(left, begin, middle, depth + 1);
+                } else {
+                    buildNode(left + 1, middle, end, depth + 1);
+                }
+            });
+        } else {
+            buildNode(left, begin, middle, depth + 1);
+            buildNode(left + 1, middle, end, depth + 1);
+        }
+    }
+};
+
+TBvh::TBvh() {}
+TBvh::TBvh(const std::vector<TBoundingBox>& boxes, size_t threadsCount)
+    : ThreadsCount_(std::max<size_t>(threadsCount, 1)) {
+    if (boxes.size() >= std::numeric_limits<uint32_t>::max() / 2) {
+        throw std::runtime_error("Error: too many primitives for BVH");
+    }
+    build(boxes);
+}
+
+void TBvh::build(const std::vector<TBoundingBox>& boxes) {
+    Nodes_.clear();
+    Primitives_.clear();
+    Levels_.clear();
+    const TBvhStats previous = Stats_;
+    Stats_ = TBvhStats{};
+    if (boxes.empty()) {
+        return;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    TBvhBuilder{boxes, ThreadsCount_, Nodes_, Primitives_}.build();
+    const auto end = std::chrono::steady_clock::now();
+
+    collectStats();
+    Stats_.BuildSeconds = std::chrono::duration<double>(end - start).count();
+    Stats_.RefitSeconds = previous.RefitSeconds;
+    Stats_.RefitsCount = previous.RefitsCount;
+    Stats_.RebuildsCount = previous.RebuildsCount;
+    BuildSahCost_ = Stats_.SahCost;
+}
+
+void TBvh::refit(const std::vector<TBoundingBox>& boxes) {
+    if (boxes.size() != Primitives_.size()) {
+        throw std::runtime_error("Error: refitting BVH with different primitives count");
+    }
+    if (boxes.empty()) {
+        return;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    // children of a level are the next level, so the nodes of one level are independent of each other;
+    // areas weighted by node costs are summed on the way up to get the new SAH cost without another pass
+    double weightedArea = 0.0;
+    for (size_t depth = Levels_.size(); depth-- > 0;) {
+        const std::vector<uint32_t>& level = Levels_[depth];
+        const size_t chunksCount =
+            std::clamp<size_t>(level.size() / BVH_REFIT_CHUNK_MIN_SIZE, 1, ThreadsCount_);
+        std::vector<double> chunkAreas(chunksCount, 0.0);
+        forChunks(0, static_cast<uint32_t>(level.size()), chunksCount,
+                  [&](uint32_t chunkBegin, uint32_t chunkEnd, size_t chunk) {
+                      for (uint32_t i = chunkBegin; i < chunkEnd; i++) {
+                          TBvhNode& node = Nodes_[level[i]];
+                          TBinBox box;
+                          if (node.isLeaf()) {
+                              for (uint32_t j = node.First; j < node.First + node.Count; j++) {
+                                  box.extend(TBinBox{boxes[Primitives_[j]]});
+                              }
+                              chunkAreas[chunk] += box.surfaceArea() * BVH_INTERSECTION_COST * node.Count;
+                          } else {
+                              box.extend(TBinBox{Nodes_[node.First]});
+                              box.extend(TBinBox{Nodes_[node.First + 1]});
+                              chunkAreas[chunk] += box.surfaceArea() * BVH_TRAVERSAL_COST;
+                          }
+                          node.Min = box.Min;
+                          node.Max = box.Max;
+                      }
+                  });
+        for (const double area : chunkAreas) {
+            weightedArea += area;
+        }
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    const double rootArea = TBinBox{Nodes_[0]}.surfaceArea();
+    Stats_.SahCost = rootArea > 0.0 ? weightedArea / rootArea : Stats_.SahCost;
+    Stats_.RefitSeconds = std::chrono::duration<double>(end - start).count();
+    Stats_.RefitsCount++;
+}
+
+bool TBvh::update(const std::vector<TBoundingBox>& boxes) {
+    refit(boxes);
+    if (Stats_.SahCost <= BVH_REBUILD_SAH_RATIO * BuildSahCost_) {
+        return false;
+    }
+    build(boxes);
+    Stats_.RebuildsCount++;
+    return true;
+}
+
+const std::vector<TBvhNode>& TBvh::getNodes() const { return Nodes_; }
+const std::vector<uint32_t>& TBvh::getPrimitives() const { return Primitives_; }
+const TBvhStats& TBvh::getStats() const { return Stats_; }
+size_t TBvh::getMemorySize() const {
+    return Nodes_.size() * sizeof(TBvhNode) + Primitives_.size() * sizeof(uint32_t);
+}
+
+TBoundingBox TBvh::bounds() const {
+    if (Nodes_.empty()) {
+        return TBoundingBox{};
+    }
+    return Nodes_[0].box();
+}
+
+void TBvh::collectStats() {
+    Stats_ = TBvhStats{};
+    Stats_.NodesCount = Nodes_.size();
+    Stats_.MinLeafSize = Primitives_.size();
+
+    const double rootArea = TBinBox{Nodes_[0]}.surfaceArea();
+
+    std::vector<std::pair<uint32_t, size_t>> stack = {{0, 1}};
+    while (!stack.empty()) {
+        const auto [nodeIdx, depth] = stack.back();
+        stack.pop_back();
+        const TBvhNode& node = Nodes_[nodeIdx];
+        const double areaRatio = rootArea > 0.0 ? TBinBox{node}.surfaceArea() / rootArea : 1.0;
+
+        Stats_.Depth = std::max(Stats_.Depth, depth);
+        if (Levels_.size() < depth) {
+            Levels_.resize(depth);
+        }
+        Levels_[depth - 1].push_back(nodeIdx);
+        if (node.isLeaf()) {
+            Stats_.SahCost += areaRatio * BVH_INTERSECTION_COST * node.Count;
+            Stats_.LeavesCount++;
+            Stats_.MinLeafSize = std::min<size_t>(Stats_.MinLeafSize, node.Count);
+            Stats_.MaxLeafSize = std::max<size_t>(Stats_.MaxLeafSize, node.Count);
+            continue;
+        }
+        Stats_.SahCost += areaRatio * BVH_TRAVERSAL_COST;
+        stack.emplace_back(node.First, depth + 1);
+        stack.emplace_back(node.First + 1, depth + 1);
+    }
+    Stats_.AverageLeafSize = static_cast<double>(Primitives_.size()) / Stats_.LeavesCount;
+}
+
+} // namespace NRayTracingLib
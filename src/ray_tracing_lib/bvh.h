@@ -0,0 +1,261 @@
+#pragma once
+
+#include "bounds.h"
+#include "common.h"
+#include "parallel.h"
+
+#include <array>
+#include <type_traits>
+
+namespace NRayTracingLib {
+
+static constexpr size_t BVH_MAX_DEPTH = 64;
+// rays of a packet for traversePacket: larger packets of incoherent rays open most of the tree
+static constexpr size_t BVH_PACKET_SIZE = 64;
+// a refitted tree whose SAH cost grew by more than this ratio since its build is rebuilt
+static constexpr double BVH_REBUILD_SAH_RATIO = 1.5;
+
+// ray prepared for node tests: the inverse direction is computed once per ray instead of once per node
+class TBvhRay {
+  public:
+    std::array<double, 3> Origin;
+    std::array<double, 3> InverseDirection;
+
+    // uninitialized, for packets on the stack
+    TBvhRay() = default;
+    explicit TBvhRay(const TPoint& origin, const TVector& direction);
+};
+
+class TBvhNode {
+  public:
+    std::array<double, 3> Min;
+    std::array<double, 3> Max;
+    // leaf: range [First, First + Count) of the primitives order; inner node: index of the left child,
+    // the right child directly follows it
+    uint32_t First = 0;
+    uint32_t Count = 0;
+
+    bool isLeaf() const { return Count > 0; }
+    TBoundingBox box() const;
+
+    // slab test over plain doubles, it is the innermost loop of every traversal; entry is the start of the part
+    // of [tMin, tMax] inside the box
+    bool intersects(const TBvhRay& ray, double tMin, double tMax, double& entry) const {
+        for (size_t axis = 0; axis < 3; axis++) {
+            const double t1 = (Min[axis] - ray.Origin[axis]) * ray.InverseDirection[axis];
+            const double t2 = (Max[axis] - ray.Origin[axis]) * ray.InverseDirection[axis];
+            tMin = std::max(tMin, std::min(t1, t2));
+            tMax = std::min(tMax, std::max(t1, t2));
+        }
+        entry = tMin;
+        return tMin <= tMax;
+    }
+};
+
+// traversal visitors return void, or bool to stop the traversal by returning true
+template <typename TVisitor>
+bool visitBvhPrimitive(TVisitor& visitor, uint32_t primitive, double& tMin, double& tMax) {
+    if constexpr (std::is_same_v<std::invoke_result_t<TVisitor&, uint32_t, double&, double&>, bool>) {
+        return visitor(primitive, tMin, tMax);
+    } else {
+        visitor(primitive, tMin, tMax);
+        return false;
+    }
+}
+
+// traversal stack entry: nodes are skipped when popped if the interval shrank past their entry
+template <typename TIndex>
+class TBvhStackEntry {
+  public:
+    TIndex Node;
+    double Entry;
+};
+
+// where a node box lies against the region of a query
+enum class TBoxOverlap {
+    Outside,
+    // partly inside or not known to be fully inside
+    Partial,
+    Inside,
+};
+
+class TBvhStats {
+  public:
+    double BuildSeconds = 0.0;
+    // time of the last refit, refits and rebuilds by update are counted over the whole life of the tree
+    double RefitSeconds = 0.0;
+    size_t RefitsCount = 0;
+    size_t RebuildsCount = 0;
+    // surface area heuristic estimate of a ray cost in node test units, lower is better
+    double SahCost = 0.0;
+    size_t NodesCount = 0;
+    size_t LeavesCount = 0;
+    size_t Depth = 0;
+    size_t MinLeafSize = 0;
+    size_t MaxLeafSize = 0;
+    double AverageLeafSize = 0.0;
+
+    friend std::ostream& operator<<(std::ostream& os, const TBvhStats& stats);
+};
+
+// bounding volume hierarchy over primitive boxes built with binned surface area heuristic;
+// large nodes are binned by several threads at once, smaller ones are built as independent subtree tasks
+class TBvh {
+  public:
+    TBvh();
+    explicit TBvh(const std::vector<TBoundingBox>& boxes, size_t threadsCount = threadPool().getThreadsCount());
+
+    const std::vector<TBvhNode>& getNodes() const;
+    // primitive indices in leaves order
+    const std::vector<uint32_t>& getPrimitives() const;
+    const TBvhStats& getStats() const;
+    size_t getMemorySize() const;
+    TBoundingBox bounds() const;
+
+    // moves primitives keeping the tree: node boxes are recomputed bottom-up level by level in parallel
+    void refit(const std::vector<TBoundingBox>& boxes);
+    // refits and rebuilds the tree if refitting made it too loose, returns whether it was rebuilt
+    bool update(const std::vector<TBoundingBox>& boxes);
+
+    // primitives of the leaves whose boxes overlap(box) does not put Outside, subtrees put Inside are taken
+    // without more calls; culling by a region, as the frustum does, is built on it
+    template <typename TOverlap>
+    std::vector<uint32_t> query(const TOverlap& overlap) const {
+        std::vector<uint32_t> found;
+        if (Nodes_.empty()) {
+            return found;
+        }
+        // second of the pair tells that the node is known to be inside the region
+        std::vector<std::pair<uint32_t, bool>> stack = {{0, false}};
+        while (!stack.empty()) {
+            const auto [nodeIdx, inside] = stack.back();
+            stack.pop_back();
+            const TBvhNode& node = Nodes_[nodeIdx];
+
+            bool nodeInside = inside;
+            if (!inside) {
+                const TBoxOverlap nodeOverlap = overlap(node.box());
+                if (nodeOverlap == TBoxOverlap::Outside) {
+                    continue;
+                }
+                nodeInside = nodeOverlap == TBoxOverlap::Inside;
+            }
+            if (node.isLeaf()) {
+                found.insert(found.end(), Primitives_.begin() + node.First,
+                             Primitives_.begin() + node.First + node.Count);
+                continue;
+            }
+            stack.emplace_back(node.First + 1, nodeInside);
+            stack.emplace_back(node.First, nodeInside);
+        }
+        return found;
+    }
+
+    // calls visitor(primitive, tMin, tMax) for the primitives of every leaf crossed by the ray in [tMin, tMax],
+    // nearer children first; the visitor may narrow the interval by its references to skip farther nodes
+    // and stop the traversal by returning true, see visitBvhPrimitive
+    template <typename TVisitor>
+    void traverse(const TPoint& origin, const TVector& direction, double tMin, double tMax,
+                  TVisitor&& visitor) const {
+        const TBvhRay ray{origin, direction};
+        double rootEntry;
+        if (Nodes_.empty() || !Nodes_[0].intersects(ray, tMin, tMax, rootEntry)) {
+            return;
+        }
+        std::array<TBvhStackEntry<uint32_t>, BVH_MAX_DEPTH + 1> stack;
+        size_t stackSize = 0;
+        stack[stackSize++] = {0, rootEntry};
+        while (stackSize > 0) {
+            const TBvhStackEntry<uint32_t> current = stack[--stackSize];
+            if (current.Entry > tMax) {
+                continue;
+            }
+            const TBvhNode& node = Nodes_[current.Node];
+            if (node.isLeaf()) {
+                for (uint32_t i = node.First; i < node.First + node.Count; i++) {
+                    if (visitBvhPrimitive(visitor, Primitives_[i], tMin, tMax)) {
+                        return;
+                    }
+                }
+                continue;
+            }
+
+            double leftEntry;
+            double rightEntry;
+            const bool left = Nodes_[node.First].intersects(ray, tMin, tMax, leftEntry);
+            const bool right = Nodes_[node.First + 1].intersects(ray, tMin, tMax, rightEntry);
+            if (left && right) {
+                // the nearer child goes on top of the stack
+                if (leftEntry <= rightEntry) {
+                    stack[stackSize++] = {node.First + 1, rightEntry};
+                    stack[stackSize++] = {node.First, leftEntry};
+                } else {
+                    stack[stackSize++] = {node.First, leftEntry};
+                    stack[stackSize++] = {node.First + 1, rightEntry};
+                }
+            } else if (left) {
+                stack[stackSize++] = {node.First, leftEntry};
+            } else if (right) {
+                stack[stackSize++] = {node.First + 1, rightEntry};
+            }
+        }
+    }
+
+    // packet traversal for coherent rays, like shadow rays towards one light: a node is fetched once for the whole
+    // packet and opened when any live ray crosses it in [0, tMaxs[ray]]; visitor(primitive, ray) is called for the
+    // live rays crossing a leaf and returns true when the ray is done, done rays leave the packet
+    template <typename TVisitor>
+    void traversePacket(std::span<const TBvhRay> rays, std::span<const double> tMaxs, std::span<uint8_t> done,
+                        TVisitor&& visitor) const {
+        size_t liveCount = std::count(done.begin(), done.end(), 0);
+        if (Nodes_.empty() || liveCount == 0) {
+            return;
+        }
+        std::array<uint32_t, BVH_MAX_DEPTH + 1> stack;
+        size_t stackSize = 0;
+        stack[stackSize++] = 0;
+        while (stackSize > 0 && liveCount > 0) {
+            const TBvhNode& node = Nodes_[stack[--stackSize]];
+            if (!node.isLeaf()) {
+                bool crossed = false;
+                for (size_t ray = 0; ray < rays.size() && !crossed; ray++) {
+                    double entry;
+                    crossed = !done[ray] && node.intersects(rays[ray], 0.0, tMaxs[ray], entry);
+                }
+                if (crossed) {
+                    stack[stackSize++] = node.First + 1;
+                    stack[stackSize++] = node.First;
+                }
+                continue;
+            }
+            for (size_t ray = 0; ray < rays.size(); ray++) {
+                double entry;
+                if (done[ray] || !node.intersects(rays[ray], 0.0, tMaxs[ray], entry)) {
+                    continue;
+                }
+                for (uint32_t i = node.First; i < node.First + node.Count; i++) {
+                    if (visitor(Primitives_[i], ray)) {
+                        done[ray] = true;
+                        liveCount--;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+  private:
+    std::vector<TBvhNode> Nodes_;
+    std::vector<uint32_t> Primitives_;
+    TBvhStats Stats_;
+    size_t ThreadsCount_ = 1;
+    double BuildSahCost_ = 0.0;
+    // node indices grouped by depth, refit walks them from the deepest level up
+    std::vector<std::vector<uint32_t>> Levels_;
+
+    void build(const std::vector<TBoundingBox>& boxes);
+    // fills Stats_ and Levels_ of a just built tree
+    void collectStats();
+};
+
+} // namespace NRayTracingLib
@@ -1,4 +1,8 @@
 #include "camera.h"
+#include "bvh.h"
+
+#include <atomic>
+#include <mutex>
 
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include "stb/stb_image_write.h"
@@ -40,7 +44,23 @@ TCamera::TCamera(const TPoint& position, const TVector& direction, const std::pa
       HeightViewAngle_{viewAngles.second}, WidthResolution_{resolution.first}, HeightResolution_{resolution.second} {
     Direction_.normalize();
 
-    ImageData_.resize(WidthResolution_ * HeightResolution_ * 3);
+    // a span is an image row or a tile
+    const size_t spanSize = std::max(WidthResolution_, TILE_SIZE * TILE_SIZE);
+    Contexts_.resize(threadPool().getThreadsCount());
+    for (TSpanContext& context : Contexts_) {
+        context.Pixels.reserve(spanSize);
+        context.Hits.resize(spanSize);
+        context.Directions.resize(spanSize);
+        context.Colors.resize(spanSize);
+        context.Figures.resize(spanSize);
+        context.ShadowRays.reserve(spanSize);
+        context.ShadowMaxs.reserve(spanSize);
+        context.ShadowOccluded.reserve(spanSize);
+        context.ShadowPixels.reserve(spanSize);
+    }
+    // places the image for the default order
+    setPixelOrder(PixelOrder_);
+    setSecondaryRaysOptions(SecondaryRaysOptions_);
 
     initHalfUpVector();
     initHalfLeftVector();
@@ -53,35 +73,709 @@ uint8_t coordinateToByte(double coord) {
     return static_cast<uint8_t>(normalized * 255.0);
 }
 
-void TCamera::makePicture(const TFigure& figure) {
-    const size_t iMax = HeightResolution_ - 1;
-    const size_t jMax = WidthResolution_ - 1;
-
-    for (size_t i = 0; i < HeightResolution_; i++) {
-        const double upProgress = static_cast<double>(i) / iMax;
-        print("Progress =", upProgress * 100, "%");
-        const double upCoeff = 1.0 - 2.0 * upProgress;
-        for (size_t j = 0; j < WidthResolution_; j++) {
-            const double leftProgress = static_cast<double>(j) / jMax;
-            const double leftCoeff = 1.0 - 2.0 * leftProgress;
-            const TRay ray{Position_, Direction_ + HalfUpVector_ * upCoeff + HalfLeftVector_ * leftCoeff};
-            const std::optional<std::pair<TPoint, TPointContainment>> intersection = figure.intersection(ray);
-            const size_t idx = (i * WidthResolution_ + j) * 3;
-            if (!intersection.has_value()) {
+// progress lines of the pool threads rendering one picture do not interleave
+static std::mutex PROGRESS_MUTEX;
+
+bool TPixelRect::contains(size_t row, size_t column) const {
+    return row >= Row && row < Row + Height && column >= Column && column < Column + Width;
+}
+bool TPixelRect::overlaps(const TPixelRect& other) const {
+    return Row < other.Row + other.Height && other.Row < Row + Height && Column < other.Column + other.Width &&
+           other.Column < Column + Width;
+}
+
+TVector TCamera::pixelDirection(double row, double column) const {
+    const double upCoeff = 1.0 - 2.0 * (row / (HeightResolution_ - 1));
+    const double leftCoeff = 1.0 - 2.0 * (column / (WidthResolution_ - 1));
+    return Direction_ + HalfUpVector_ * upCoeff + HalfLeftVector_ * leftCoeff;
+}
+
+static void resetStats(TRenderStats& stats) {
+    std::fill(stats.RaysPerBounce.begin(), stats.RaysPerBounce.end(), 0);
+    stats.ShadowRaysCount = 0;
+    stats.DepthCutRaysCount = 0;
+    stats.ContributionCutRaysCount = 0;
+    stats.BudgetCutRaysCount = 0;
+}
+
+void TCamera::resetRenderStats() {
+    for (TSpanContext& context : Contexts_) {
+        resetStats(context.Stats);
+    }
+    resetStats(RenderStats_);
+    SecondaryRaysCount_ = 0;
+    DroppedTilesCount_ = 0;
+}
+
+void TCamera::collectRenderStats() {
+    for (const TSpanContext& context : Contexts_) {
+        for (size_t depth = 0; depth < RenderStats_.RaysPerBounce.size(); depth++) {
+            RenderStats_.RaysPerBounce[depth] += context.Stats.RaysPerBounce[depth];
+        }
+        RenderStats_.ShadowRaysCount += context.Stats.ShadowRaysCount;
+        RenderStats_.DepthCutRaysCount += context.Stats.DepthCutRaysCount;
+        RenderStats_.ContributionCutRaysCount += context.Stats.ContributionCutRaysCount;
+        RenderStats_.BudgetCutRaysCount += context.Stats.BudgetCutRaysCount;
+    }
+}
+
+TSpanContext& TCamera::currentContext() { return Contexts_[threadPool().currentThread()]; }
+
+void TCamera::writeBackgroundPixel(size_t pixel) { std::fill_n(ImageData_.begin() + pixel * 3, 3, 0); }
+
+void TCamera::writeUnlitPixel(size_t pixel, const THit& hit) {
+    const size_t idx = pixel * 3;
+    if (hit.Containment == TPointContainment::OnBoundary) {
+        ImageData_[idx] = 255;
+        ImageData_[idx + 1] = 255;
+        ImageData_[idx + 2] = 128;
+    } else if (hit.Containment == TPointContainment::Inside) {
+        ImageData_[idx] = coordinateToByte(hit.Point.X.Value);
+        ImageData_[idx + 1] = coordinateToByte(hit.Point.Y.Value);
+        ImageData_[idx + 2] = coordinateToByte(hit.Point.Z.Value);
+    } else {
+        writeBackgroundPixel(pixel);
+    }
+}
+
+void TCamera::setRegions(const std::vector<TPixelRect>& regions) {
+    for (size_t i = 0; i < regions.size(); i++) {
+        const TPixelRect& region = regions[i];
+        if (region.Height == 0 || region.Width == 0) {
+            throw std::runtime_error("Error: empty picture region");
+        }
+        if (region.Row + region.Height > HeightResolution_ || region.Column + region.Width > WidthResolution_) {
+            throw std::runtime_error("Error: picture region out of the picture");
+        }
+        for (size_t k = 0; k < i; k++) {
+            if (region.overlaps(regions[k])) {
+                throw std::runtime_error("Error: overlapping picture regions");
+            }
+        }
+    }
+    Regions_ = regions;
+    // row spans take the columns of the regions crossing the row from left to right
+    std::sort(Regions_->begin(), Regions_->end(),
+              [](const TPixelRect& a, const TPixelRect& b) { return a.Column < b.Column; });
+}
+
+bool TCamera::inRegions(size_t row, size_t column) const {
+    if (!Regions_.has_value()) {
+        return true;
+    }
+    return std::any_of(Regions_->begin(), Regions_->end(),
+                       [row, column](const TPixelRect& region) { return region.contains(row, column); });
+}
+
+size_t TCamera::spansCount() const {
+    return PixelOrder_ == TPixelOrder::RowMajor ? HeightResolution_ : TileOrder_.size();
+}
+
+void TCamera::fillSpan(size_t span, size_t firstRow, size_t rowsEnd, std::vector<size_t>& pixels) const {
+    pixels.clear();
+    if (PixelOrder_ == TPixelOrder::RowMajor) {
+        const size_t i = span;
+        if (i < firstRow || i >= rowsEnd) {
+            return;
+        }
+        if (!Regions_.has_value()) {
+            for (size_t j = 0; j < WidthResolution_; j++) {
+                pixels.push_back(i * WidthResolution_ + j);
+            }
+            return;
+        }
+        for (const TPixelRect& region : Regions_.value()) {
+            if (i < region.Row || i >= region.Row + region.Height) {
+                continue;
+            }
+            for (size_t j = region.Column; j < region.Column + region.Width; j++) {
+                pixels.push_back(i * WidthResolution_ + j);
+            }
+        }
+        return;
+    }
+    const size_t tilesCountX = (WidthResolution_ + TILE_SIZE - 1) / TILE_SIZE;
+    const size_t tileRow = TileOrder_[span] / tilesCountX * TILE_SIZE;
+    const size_t tileColumn = TileOrder_[span] % tilesCountX * TILE_SIZE;
+    if (tileRow < firstRow || tileRow >= rowsEnd) {
+        return;
+    }
+    for (const uint32_t pixel : TilePixelOrder_) {
+        const size_t i = tileRow + pixel / TILE_SIZE;
+        const size_t j = tileColumn + pixel % TILE_SIZE;
+        if (i < rowsEnd && j < WidthResolution_ && inRegions(i, j)) {
+            pixels.push_back(i * WidthResolution_ + j);
+        }
+    }
+}
+
+TPixelRect TCamera::spanRect(const std::vector<size_t>& pixels) const {
+    size_t minRow = HeightResolution_;
+    size_t maxRow = 0;
+    size_t minColumn = WidthResolution_;
+    size_t maxColumn = 0;
+    for (const size_t pixel : pixels) {
+        minRow = std::min(minRow, pixel / WidthResolution_);
+        maxRow = std::max(maxRow, pixel / WidthResolution_);
+        minColumn = std::min(minColumn, pixel % WidthResolution_);
+        maxColumn = std::max(maxColumn, pixel % WidthResolution_);
+    }
+    return TPixelRect{minRow, minColumn, maxRow - minRow + 1, maxColumn - minColumn + 1};
+}
+
+void TCamera::placeImage() {
+    TImageData imageData(WidthResolution_ * HeightResolution_ * 3);
+    const bool keepPixels = ImageData_.size() == imageData.size();
+    const size_t tilesCountX = (WidthResolution_ + TILE_SIZE - 1) / TILE_SIZE;
+    // task to span mapping of tracePicture without cost scheduling, whole spans whatever the regions are
+    threadPool().run(spansCount(), [&](size_t span) {
+        TPixelRect rect{span, 0, 1, WidthResolution_};
+        if (PixelOrder_ != TPixelOrder::RowMajor) {
+            rect.Row = TileOrder_[span] / tilesCountX * TILE_SIZE;
+            rect.Column = TileOrder_[span] % tilesCountX * TILE_SIZE;
+            rect.Height = std::min(TILE_SIZE, HeightResolution_ - rect.Row);
+            rect.Width = std::min(TILE_SIZE, WidthResolution_ - rect.Column);
+        }
+        for (size_t i = rect.Row; i < rect.Row + rect.Height; i++) {
+            const size_t begin = (i * WidthResolution_ + rect.Column) * 3;
+            if (keepPixels) {
+                std::copy_n(ImageData_.begin() + begin, rect.Width * 3, imageData.begin() + begin);
+            } else {
+                std::fill_n(imageData.begin() + begin, rect.Width * 3, 0);
+            }
+        }
+    });
+    ImageData_ = std::move(imageData);
+}
+
+void TCamera::publishTile(const TPixelRect& rect) {
+    // the release store of the queue makes the pixels written before visible to the consumer
+    if (TileQueue_ != nullptr && !TileQueue_->push(rect)) {
+        std::atomic_ref<size_t>{DroppedTilesCount_}.fetch_add(1);
+    }
+    if (TileCallback_) {
+        TileCallback_(rect);
+    }
+}
+
+template <typename THitFunc, typename TOccludedFunc>
+void TCamera::tracePicture(const THitFunc& hitFunc, const TOccludedFunc& occludedFunc) {
+    resetRenderStats();
+    const size_t spansCount = this->spansCount();
+    // progress is reported once per image row or per row of tiles
+    const size_t tilesCountX = (WidthResolution_ + TILE_SIZE - 1) / TILE_SIZE;
+    const size_t progressStep = PixelOrder_ == TPixelOrder::RowMajor ? 1 : tilesCountX;
+    std::atomic<size_t> doneSpansCount = 0;
+    std::atomic<bool> stopped = false;
+    if (CostScheduling_) {
+        // spans stay in the node blocks of the pool threads that first touched their pixels
+        costliestFirst(SpanCosts_, SpanSchedule_, threadPool().getNodesCount());
+    }
+    // spans are independent, every pool thread shades the spans it takes with its own context
+    threadPool().run(spansCount, [&](size_t task) {
+        if (StopToken_.stop_requested()) {
+            stopped = true;
+            return;
+        }
+        const size_t span = CostScheduling_ ? SpanSchedule_[task] : task;
+        const auto start = std::chrono::steady_clock::now();
+        TSpanContext& context = currentContext();
+        fillSpan(span, 0, HeightResolution_, context.Pixels);
+        if (!context.Pixels.empty()) {
+            traceSpan(context, hitFunc, occludedFunc);
+            publishTile(spanRect(context.Pixels));
+        }
+        SpanCosts_[span] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        const size_t doneCount = ++doneSpansCount;
+        if (doneCount % progressStep == 0) {
+            const std::lock_guard lock{PROGRESS_MUTEX};
+            print("Progress =", static_cast<double>(doneCount) / spansCount * 100, "%");
+        }
+    });
+    Stopped_ = stopped;
+    collectRenderStats();
+}
+
+template <typename THitFunc, typename TOccludedFunc>
+void TCamera::traceSpan(TSpanContext& context, const THitFunc& hitFunc, const TOccludedFunc& occludedFunc) {
+    for (size_t k = 0; k < context.Pixels.size(); k++) {
+        const size_t pixel = context.Pixels[k];
+        const TRay ray{Position_, pixelDirection(pixel / WidthResolution_, pixel % WidthResolution_)};
+        const TFigure* hitFigure = nullptr;
+        const std::optional<THit> intersection = hitFunc(ray, hitFigure);
+        context.Stats.RaysPerBounce[0]++;
+        if (!Lights_.empty()) {
+            context.Hits[k] = intersection;
+            context.Figures[k] = hitFigure;
+            context.Directions[k] = ray.Vector;
+            continue;
+        }
+        if (intersection.has_value()) {
+            writeUnlitPixel(pixel, intersection.value());
+        } else {
+            writeBackgroundPixel(pixel);
+        }
+    }
+    if (!Lights_.empty()) {
+        shadeSpan(context, hitFunc, occludedFunc);
+    }
+}
+
+template <typename THitFunc, typename TOccludedFunc>
+void TCamera::shadeSpan(TSpanContext& context, const THitFunc& hitFunc, const TOccludedFunc& occludedFunc) {
+    for (size_t j = 0; j < context.Pixels.size(); j++) {
+        if (context.Hits[j].has_value()) {
+            THit& hit = context.Hits[j].value();
+            // shading uses the side of the face looking at the camera
+            if (hit.Normal * context.Directions[j] > 0.0) {
+                hit.Normal = -hit.Normal;
+            }
+            context.Colors[j] = getMaterial(context.Figures[j]).Ambient;
+        }
+    }
+
+    for (const auto& light : Lights_) {
+        context.ShadowRays.clear();
+        context.ShadowMaxs.clear();
+        context.ShadowPixels.clear();
+        for (size_t j = 0; j < context.Pixels.size(); j++) {
+            if (!context.Hits[j].has_value() || context.Hits[j].value().Containment != TPointContainment::Inside) {
+                continue;
+            }
+            const THit& hit = context.Hits[j].value();
+            const auto [toLight, tMax] = light.shadowRay(hit.Point);
+            // faces turned away from the light and perfect mirrors are not lit and need no shadow ray
+            if (toLight.isZero() || hit.Normal * toLight <= 0.0 ||
+                getMaterial(context.Figures[j]).localWeight() == 0.0) {
                 continue;
             }
-            if (intersection.value().second == TPointContainment::OnBoundary) {
-                ImageData_[idx] = 255;
-                ImageData_[idx + 1] = 255;
-                ImageData_[idx + 2] = 128;
-            } else if (intersection.value().second == TPointContainment::Inside) {
-                const TPoint point = intersection.value().first;
-                ImageData_[idx] = coordinateToByte(point.X.Value);     // static_cast<uint8_t>(upProgress * 256);
-                ImageData_[idx + 1] = coordinateToByte(point.Y.Value); // static_cast<uint8_t>(leftProgress * 256);
-                ImageData_[idx + 2] = coordinateToByte(point.Z.Value); // 128;
+            context.ShadowRays.emplace_back(hit.Point + hit.Normal * RAY_OFFSET, toLight);
+            context.ShadowMaxs.push_back(tMax);
+            context.ShadowPixels.push_back(j);
+        }
+        context.ShadowOccluded.assign(context.ShadowRays.size(), false);
+        occludedFunc(std::span<const TRay>{context.ShadowRays}, std::span<const double>{context.ShadowMaxs},
+                     std::span<uint8_t>{context.ShadowOccluded.data(), context.ShadowRays.size()});
+        context.Stats.ShadowRaysCount += context.ShadowRays.size();
+
+        for (size_t k = 0; k < context.ShadowPixels.size(); k++) {
+            if (context.ShadowOccluded[k]) {
+                continue;
             }
+            const size_t j = context.ShadowPixels[k];
+            const THit& hit = context.Hits[j].value();
+            context.Colors[j] += getMaterial(context.Figures[j])
+                                     .reflect(light.intensityAt(hit.Point), hit.Normal,
+                                              context.ShadowRays[k].Vector.getNormalized(),
+                                              -context.Directions[j].getNormalized());
         }
     }
+
+    for (size_t j = 0; j < context.Pixels.size(); j++) {
+        if (!context.Hits[j].has_value() || context.Hits[j].value().Containment == TPointContainment::Outside) {
+            writeBackgroundPixel(context.Pixels[j]);
+            continue;
+        }
+        const size_t idx = context.Pixels[j] * 3;
+        if (context.Hits[j].value().Containment == TPointContainment::OnBoundary) {
+            ImageData_[idx] = 255;
+            ImageData_[idx + 1] = 255;
+            ImageData_[idx + 2] = 128;
+        } else if (context.Hits[j].value().Containment == TPointContainment::Inside) {
+            const TPhongMaterial& material = getMaterial(context.Figures[j]);
+            context.Colors[j] = context.Colors[j] * material.localWeight();
+            const TSecondaryRay primary{TRay{Position_, context.Directions[j]}, j, 0, 1.0, false};
+            std::array<TSecondaryRay, 2> spawned;
+            const size_t spawnedCount =
+                spawnSecondaryRays(context.Stats, context.Hits[j].value(), context.Directions[j], material, primary,
+                                   spawned);
+            context.RayStack.insert(context.RayStack.end(), spawned.begin(), spawned.begin() + spawnedCount);
+            traceSecondaryRays(context, hitFunc, occludedFunc);
+            const std::array<uint8_t, 3> bytes = context.Colors[j].toBytes();
+            std::copy(bytes.begin(), bytes.end(), ImageData_.begin() + idx);
+        }
+    }
+}
+
+template <typename THitFunc, typename TOccludedFunc>
+void TCamera::traceSecondaryRays(TSpanContext& context, const THitFunc& hitFunc, const TOccludedFunc& occludedFunc) {
+    while (!context.RayStack.empty()) {
+        const TSecondaryRay current = context.RayStack.back();
+        context.RayStack.pop_back();
+        context.Stats.RaysPerBounce[current.Depth]++;
+
+        const TFigure* hitFigure = nullptr;
+        std::optional<THit> hit;
+        try {
+            hit = hitFunc(current.Ray, hitFigure);
+        } catch (const TLineInPlaneError&) {
+            // a ray lying in a plane of a figure sees nothing
+        }
+        if (!hit.has_value() || hit.value().Containment != TPointContainment::Inside) {
+            continue;
+        }
+        if (hit.value().Normal * current.Ray.Vector > 0.0) {
+            hit.value().Normal = -hit.value().Normal;
+        }
+        const TPhongMaterial& material = getMaterial(hitFigure);
+        context.Colors[current.Pixel] +=
+            shadeHit(context.Stats, hit.value(), current.Ray.Vector, material, occludedFunc) *
+            (current.Weight * material.localWeight());
+        std::array<TSecondaryRay, 2> spawned;
+        const size_t spawnedCount =
+            spawnSecondaryRays(context.Stats, hit.value(), current.Ray.Vector, material, current, spawned);
+        context.RayStack.insert(context.RayStack.end(), spawned.begin(), spawned.begin() + spawnedCount);
+    }
+}
+
+template <typename TOccludedFunc>
+TColor TCamera::shadeHit(TRenderStats& stats, const THit& hit, const TVector& direction,
+                         const TPhongMaterial& material, const TOccludedFunc& occludedFunc) {
+    TColor color = material.Ambient;
+    if (material.localWeight() == 0.0) {
+        return color;
+    }
+    for (const auto& light : Lights_) {
+        const auto [toLight, tMax] = light.shadowRay(hit.Point);
+        if (toLight.isZero() || hit.Normal * toLight <= 0.0) {
+            continue;
+        }
+        const TRay shadowRay{hit.Point + hit.Normal * RAY_OFFSET, toLight};
+        uint8_t occluded = false;
+        occludedFunc(std::span<const TRay>{&shadowRay, 1}, std::span<const double>{&tMax, 1},
+                     std::span<uint8_t>{&occluded, 1});
+        stats.ShadowRaysCount++;
+        if (!occluded) {
+            color += material.reflect(light.intensityAt(hit.Point), hit.Normal, toLight.getNormalized(),
+                                      -direction.getNormalized());
+        }
+    }
+    return color;
+}
+
+size_t TCamera::spawnSecondaryRays(TRenderStats& stats, const THit& hit, const TVector& direction,
+                                   const TPhongMaterial& material, const TSecondaryRay& parent,
+                                   std::array<TSecondaryRay, 2>& rays) {
+    size_t count = 0;
+    double reflectedWeight = parent.Weight * material.Reflectivity;
+    const double refractedWeight = parent.Weight * material.Transparency;
+    std::optional<TVector> refracted;
+    if (refractedWeight > 0.0) {
+        const double eta = parent.Inside ? material.RefractiveIndex : 1.0 / material.RefractiveIndex;
+        refracted = refractDirection(direction, hit.Normal, eta);
+        if (!refracted.has_value()) {
+            // total internal reflection
+            reflectedWeight += refractedWeight;
+        }
+    }
+
+    const auto limit = [&](const TRay& ray, double weight, bool inside) {
+        if (weight <= 0.0) {
+            return;
+        }
+        if (parent.Depth >= SecondaryRaysOptions_.MaxDepth) {
+            stats.DepthCutRaysCount++;
+        } else if (weight < SecondaryRaysOptions_.MinContribution) {
+            stats.ContributionCutRaysCount++;
+        } else if (std::atomic_ref<size_t>{SecondaryRaysCount_}.fetch_add(1) >= SecondaryRaysOptions_.RaysBudget) {
+            // the budget is shared by the pool threads, so the rays are counted before they are pushed
+            stats.BudgetCutRaysCount++;
+        } else {
+            rays[count++] = TSecondaryRay{ray, parent.Pixel, parent.Depth + 1, weight, inside};
+        }
+    };
+    limit(TRay{hit.Point + hit.Normal * RAY_OFFSET, reflectDirection(direction, hit.Normal)}, reflectedWeight,
+          parent.Inside);
+    if (refracted.has_value()) {
+        limit(TRay{hit.Point + hit.Normal * -RAY_OFFSET, refracted.value()}, refractedWeight, !parent.Inside);
+    }
+    return count;
+}
+
+const TPhongMaterial& TCamera::getMaterial(const TFigure* figure) const {
+    const auto it = FigureMaterials_.find(figure);
+    return it == FigureMaterials_.end() ? Material_ : it->second;
+}
+
+void TCamera::setRenderMode(TRenderMode mode) { RenderMode_ = mode; }
+void TCamera::setPixelOrder(TPixelOrder order) {
+    const bool placed = !ImageData_.empty() && order == PixelOrder_;
+    PixelOrder_ = order;
+    const size_t tilesCountX = (WidthResolution_ + TILE_SIZE - 1) / TILE_SIZE;
+    const size_t tilesCountY = (HeightResolution_ + TILE_SIZE - 1) / TILE_SIZE;
+    TileOrder_ = gridOrder(tilesCountX, tilesCountY, order);
+    TilePixelOrder_ = gridOrder(TILE_SIZE, TILE_SIZE, order);
+    SpanCosts_.assign(spansCount(), 0.0);
+    SpanSchedule_.reserve(spansCount());
+    if (!placed) {
+        placeImage();
+    }
+}
+void TCamera::setPose(const TPoint& position, const TVector& direction) {
+    Position_ = position;
+    Direction_ = direction;
+    Direction_.normalize();
+    initHalfUpVector();
+    initHalfLeftVector();
+}
+void TCamera::setCostScheduling(bool enabled) { CostScheduling_ = enabled; }
+void TCamera::setRaySorting(bool enabled) { RaySorting_ = enabled; }
+void TCamera::setStopToken(std::stop_token token) { StopToken_ = std::move(token); }
+void TCamera::setTileQueue(TMpscQueue<TPixelRect>* queue) { TileQueue_ = queue; }
+void TCamera::setTileCallback(std::function<void(const TPixelRect&)> callback) { TileCallback_ = std::move(callback); }
+void TCamera::setLights(const std::vector<TLight>& lights) { Lights_ = lights; }
+void TCamera::setMaterial(const TPhongMaterial& material) { Material_ = material; }
+void TCamera::setMaterial(const TFigure& figure, const TPhongMaterial& material) {
+    FigureMaterials_[&figure] = material;
+}
+void TCamera::setSecondaryRaysOptions(const TSecondaryRaysOptions& options) {
+    SecondaryRaysOptions_ = options;
+    RenderStats_.RaysPerBounce.assign(SecondaryRaysOptions_.MaxDepth + 1, 0);
+    for (TSpanContext& context : Contexts_) {
+        context.Stats.RaysPerBounce.assign(SecondaryRaysOptions_.MaxDepth + 1, 0);
+        // depth first tracing keeps at most two rays per bounce on the stack
+        context.RayStack.reserve(2 * SecondaryRaysOptions_.MaxDepth + 2);
+    }
+}
+
+void TCamera::makePicture(const TFigure& figure) {
+    Regions_.reset();
+    renderFigure(figure, std::nullopt);
+}
+void TCamera::makePicture(const std::vector<const TFigure*>& figures) {
+    Regions_.reset();
+    renderFigures(figures, std::nullopt);
+}
+void TCamera::makePicture(const TFigure& figure, const std::vector<TPixelRect>& regions) {
+    setRegions(regions);
+    renderFigure(figure, std::nullopt);
+}
+void TCamera::makePicture(const std::vector<const TFigure*>& figures, const std::vector<TPixelRect>& regions) {
+    setRegions(regions);
+    renderFigures(figures, std::nullopt);
+}
+
+TProgressiveStats TCamera::makeProgressivePicture(const TFigure& figure, std::chrono::steady_clock::duration budget) {
+    Regions_.reset();
+    renderFigure(figure, std::chrono::steady_clock::now() + budget);
+    return ProgressiveStats_;
+}
+TProgressiveStats TCamera::makeProgressivePicture(const std::vector<const TFigure*>& figures,
+                                                  std::chrono::steady_clock::duration budget) {
+    Regions_.reset();
+    renderFigures(figures, std::chrono::steady_clock::now() + budget);
+    return ProgressiveStats_;
+}
+
+void TCamera::renderFigure(const TFigure& figure, std::optional<std::chrono::steady_clock::time_point> deadline) {
+    const auto occludedFunc = [&figure](std::span<const TRay> rays, std::span<const double> tMaxs,
+                                        std::span<uint8_t> occluded) { figure.occluded(rays, tMaxs, occluded); };
+    if (RenderMode_ == TRenderMode::Wavefront && !deadline.has_value()) {
+        // every chunk of the queue goes to the batch intersection of the figure
+        Wavefront_.render(
+            *this,
+            [&figure](const TRayBatch& rays, std::span<std::optional<THit>> hits, std::span<const TFigure*> figures) {
+                figure.intersect(rays, hits);
+                std::fill(figures.begin(), figures.end(), &figure);
+            },
+            occludedFunc);
+        return;
+    }
+    const auto hitFunc = [&figure](const TRay& ray, const TFigure*& hitFigure) {
+        hitFigure = &figure;
+        return figure.hit(ray, ray.minParameter(), INF);
+    };
+    if (deadline.has_value()) {
+        ProgressiveStats_ = TProgressiveRenderer::render(*this, hitFunc, occludedFunc, deadline.value());
+        return;
+    }
+    tracePicture(hitFunc, occludedFunc);
+}
+
+void TCamera::renderFigures(const std::vector<const TFigure*>& figures,
+                            std::optional<std::chrono::steady_clock::time_point> deadline) {
+    // regions are seen through frustums bounded by the outer edges of their border pixels
+    std::vector<TFrustum> frustums;
+    if (!Regions_.has_value()) {
+        frustums.push_back(getFrustum());
+    } else {
+        for (const TPixelRect& region : Regions_.value()) {
+            const double top = region.Row - 0.5;
+            const double bottom = region.Row + region.Height - 0.5;
+            const double left = region.Column - 0.5;
+            const double right = region.Column + region.Width - 0.5;
+            // the frustum axis must go through the window to orient the side planes
+            const TVector axis = pixelDirection((top + bottom) / 2.0, (left + right) / 2.0);
+            frustums.emplace_back(Position_, axis,
+                                  std::array<TVector, 4>{pixelDirection(top, left), pixelDirection(top, right),
+                                                         pixelDirection(bottom, right), pixelDirection(bottom, left)});
+        }
+    }
+    const auto inView = [&frustums](const TBoundingBox& box) {
+        return std::any_of(frustums.begin(), frustums.end(),
+                           [&box](const TFrustum& frustum) { return frustum.intersects(box); });
+    };
+    std::vector<const TFigure*> active;
+    std::vector<TBoundingBox> activeBoxes;
+    // planes and other unbounded figures can not be put into the BVH and are tested by every ray
+    std::vector<const TFigure*> unbounded;
+    for (const TFigure* figure : figures) {
+        const TBoundingBox box = figure->bounds().Box;
+        if (box.isInfinite()) {
+            unbounded.push_back(figure);
+        } else if (!Lights_.empty() || inView(box)) {
+            active.push_back(figure);
+            activeBoxes.push_back(box);
+        }
+    }
+    ActiveFiguresCount_ = active.size() + unbounded.size();
+    const TBvh bvh{activeBoxes};
+
+    const auto hitFunc = [&](const TRay& ray, const TFigure*& hitFigure) {
+        std::optional<THit> nearest;
+        double tMax = INF;
+        bvh.traverse(ray.Point, ray.Vector, ray.minParameter().Value, tMax,
+                     [&](uint32_t figureIdx, double& currentMin, double& currentMax) {
+                         std::optional<THit> figureHit = active[figureIdx]->hit(ray, currentMin, currentMax);
+                         if (figureHit != std::nullopt) {
+                             currentMax = figureHit.value().T.Value;
+                             nearest = figureHit;
+                             hitFigure = active[figureIdx];
+                         }
+                     });
+        if (nearest != std::nullopt) {
+            tMax = nearest.value().T.Value;
+        }
+        for (const TFigure* figure : unbounded) {
+            std::optional<THit> figureHit = figure->hit(ray, ray.minParameter(), tMax);
+            if (figureHit != std::nullopt) {
+                tMax = figureHit.value().T.Value;
+                nearest = figureHit;
+                hitFigure = figure;
+            }
+        }
+        return nearest;
+    };
+    // shadow rays lying in a plane of a figure are not occluded by it, as in TFigure::occluded, the other figures
+    // are still tested
+    const auto figureOccludes = [](const TFigure* figure, const TRay& ray, double tMin, double tMax) {
+        try {
+            return figure->anyHit(ray, tMin, tMax).has_value();
+        } catch (const TLineInPlaneError&) {
+            return false;
+        }
+    };
+    const auto occludedFunc = [&](std::span<const TRay> rays, std::span<const double> tMaxs,
+                                  std::span<uint8_t> occluded) {
+        // bounded figures take the rays in packets, as a mesh takes its shadow rays
+        std::array<TBvhRay, BVH_PACKET_SIZE> packet;
+        for (size_t first = 0; first < rays.size(); first += BVH_PACKET_SIZE) {
+            const size_t count = std::min(BVH_PACKET_SIZE, rays.size() - first);
+            for (size_t i = 0; i < count; i++) {
+                packet[i] = TBvhRay{rays[first + i].Point, rays[first + i].Vector};
+            }
+            bvh.traversePacket(std::span<const TBvhRay>{packet.data(), count}, tMaxs.subspan(first, count),
+                               occluded.subspan(first, count), [&](uint32_t figureIdx, size_t ray) {
+                                   return figureOccludes(active[figureIdx], rays[first + ray], 0.0,
+                                                         tMaxs[first + ray]);
+                               });
+        }
+        for (size_t i = 0; i < rays.size(); i++) {
+            for (size_t k = 0; k < unbounded.size() && !occluded[i]; k++) {
+                occluded[i] = figureOccludes(unbounded[k], rays[i], 0.0, tMaxs[i]);
+            }
+        }
+    };
+    if (deadline.has_value()) {
+        ProgressiveStats_ = TProgressiveRenderer::render(*this, hitFunc, occludedFunc, deadline.value());
+        return;
+    }
+    if (RenderMode_ == TRenderMode::Wavefront) {
+        Wavefront_.render(
+            *this,
+            [&hitFunc](const TRayBatch& rays, std::span<std::optional<THit>> hits, std::span<const TFigure*> figures) {
+                for (size_t i = 0; i < rays.size(); i++) {
+                    try {
+                        hits[i] = hitFunc(TRay{rays.origin(i), rays.direction(i)}, figures[i]);
+                    } catch (const TLineInPlaneError&) {
+                        hits[i] = std::nullopt;
+                    }
+                }
+            },
+            occludedFunc);
+        return;
+    }
+    tracePicture(hitFunc, occludedFunc);
+}
+
+// progressive pictures trace their grid rows with the functions they are given
+template void TCamera::traceSpan(TSpanContext& context, const TProgressiveRenderer::THitFunc& hitFunc,
+                                 const TProgressiveRenderer::TOccludedFunc& occludedFunc);
+
+TFrustum TCamera::getFrustum() const {
+    return TFrustum{Position_,
+                    Direction_,
+                    {Direction_ + HalfUpVector_ + HalfLeftVector_, Direction_ + HalfUpVector_ - HalfLeftVector_,
+                     Direction_ - HalfUpVector_ - HalfLeftVector_, Direction_ - HalfUpVector_ + HalfLeftVector_}};
+}
+const TImageData& TCamera::getImageData() const { return ImageData_; }
+std::vector<uint8_t> TCamera::getRegionData(const TPixelRect& region) const {
+    if (region.Row + region.Height > HeightResolution_ || region.Column + region.Width > WidthResolution_) {
+        throw std::runtime_error("Error: picture region out of the picture");
+    }
+    std::vector<uint8_t> data;
+    data.reserve(region.Height * region.Width * 3);
+    for (size_t i = region.Row; i < region.Row + region.Height; i++) {
+        const auto rowBegin = ImageData_.begin() + (i * WidthResolution_ + region.Column) * 3;
+        data.insert(data.end(), rowBegin, rowBegin + region.Width * 3);
+    }
+    return data;
+}
+size_t TCamera::getActiveFiguresCount() const { return ActiveFiguresCount_; }
+const TRenderStats& TCamera::getRenderStats() const { return RenderStats_; }
+size_t TCamera::getDroppedTilesCount() const { return DroppedTilesCount_; }
+bool TCamera::isStopped() const { return Stopped_; }
+const std::vector<double>& TCamera::getSpanCosts() const { return SpanCosts_; }
+
+TCostHistogram TCamera::getSpanCostHistogram(size_t bucketsCount) const {
+    if (bucketsCount == 0) {
+        throw std::runtime_error("Error: cost histogram without buckets");
+    }
+    TCostHistogram histogram;
+    histogram.Counts.assign(bucketsCount, 0);
+    if (SpanCosts_.empty()) {
+        return histogram;
+    }
+    const auto [minCost, maxCost] = std::minmax_element(SpanCosts_.begin(), SpanCosts_.end());
+    histogram.MinCost = *minCost;
+    histogram.MaxCost = *maxCost;
+    const bool geometric = histogram.MinCost > 0.0;
+    const double range = geometric ? std::log(histogram.MaxCost / histogram.MinCost)
+                                   : histogram.MaxCost - histogram.MinCost;
+    for (const double cost : SpanCosts_) {
+        const double offset = geometric ? std::log(cost / histogram.MinCost) : cost - histogram.MinCost;
+        const size_t bucket = range > 0.0 ? static_cast<size_t>(offset / range * bucketsCount) : 0;
+        histogram.Counts[std::min(bucket, bucketsCount - 1)]++;
+    }
+    return histogram;
+}
+
+std::ostream& operator<<(std::ostream& os, const TRenderStats& stats) {
+    os << "rays per bounce:";
+    for (const size_t count : stats.RaysPerBounce) {
+        os << ' ' << count;
+    }
+    os << ", shadow rays: " << stats.ShadowRaysCount << ", cut by depth: " << stats.DepthCutRaysCount
+       << ", by contribution: " << stats.ContributionCutRaysCount << ", by budget: " << stats.BudgetCutRaysCount;
+    return os;
+}
+
+std::ostream& operator<<(std::ostream& os, const TCostHistogram& histogram) {
+    os << "span costs from " << histogram.MinCost * 1e6 << " to " << histogram.MaxCost * 1e6 << " us:";
+    for (const size_t count : histogram.Counts) {
+        os << ' ' << count;
+    }
+    return os;
 }
 
 void TCamera::savePicture(const char* filename) const {
@@ -1,19 +1,171 @@
 #pragma once
 
 #include "angle.h"
+#include "figure.h"
+#include "frustum.h"
+#include "light.h"
 #include "line.h"
+#include "mpsc_queue.h"
+#include "parallel.h"
+#include "pixel_order.h"
+#include "progressive.h"
+#include "wavefront.h"
+
+#include <chrono>
+#include <functional>
+#include <stop_token>
 
 namespace NRayTracingLib {
 
+// limits of the mirrored and refracted rays traced per frame
+class TSecondaryRaysOptions {
+  public:
+    // bounces after the primary ray, 0 disables secondary rays
+    size_t MaxDepth = 4;
+    // secondary rays traced per frame at most, the rays spawned after it is spent are dropped
+    size_t RaysBudget = 1 << 20;
+    // rays whose share of their pixel color would be below it are not traced
+    double MinContribution = 0.01;
+};
+
+class TRenderStats {
+  public:
+    // rays traced at every depth: primary rays first, then the rays of each bounce
+    std::vector<size_t> RaysPerBounce;
+    size_t ShadowRaysCount = 0;
+    // secondary rays not traced because of the depth, contribution and budget limits
+    size_t DepthCutRaysCount = 0;
+    size_t ContributionCutRaysCount = 0;
+    size_t BudgetCutRaysCount = 0;
+
+    friend std::ostream& operator<<(std::ostream& os, const TRenderStats& stats);
+};
+
+// mirrored or refracted ray waiting on the camera ray stack
+class TSecondaryRay {
+  public:
+    TRay Ray;
+    // pixel the ray brings color to, counted within the buffer being shaded
+    size_t Pixel = 0;
+    size_t Depth = 0;
+    // share of the pixel color the ray brings
+    double Weight = 1.0;
+    // whether the ray goes inside a transparent figure
+    bool Inside = false;
+};
+
+// span costs in buckets from MinCost to MaxCost, of a constant ratio, or of a constant width when MinCost is 0
+class TCostHistogram {
+  public:
+    double MinCost = 0.0;
+    double MaxCost = 0.0;
+    std::vector<size_t> Counts;
+
+    friend std::ostream& operator<<(std::ostream& os, const TCostHistogram& histogram);
+};
+
+// rectangle of pixels: Height rows from Row and Width columns from Column
+class TPixelRect {
+  public:
+    size_t Row = 0;
+    size_t Column = 0;
+    size_t Height = 0;
+    size_t Width = 0;
+
+    bool contains(size_t row, size_t column) const;
+    bool overlaps(const TPixelRect& other) const;
+};
+
+// shadow and secondary rays start this far off the surface, so they do not hit the surface they start on
+static constexpr double RAY_OFFSET = 1e-6;
+
+// buffers and counters of one pool thread shading a span of pixels, an image row or a tile
+class TSpanContext {
+  public:
+    std::vector<size_t> Pixels;
+    std::vector<std::optional<THit>> Hits;
+    std::vector<const TFigure*> Figures;
+    std::vector<TVector> Directions;
+    std::vector<TColor> Colors;
+    std::vector<TRay> ShadowRays;
+    std::vector<double> ShadowMaxs;
+    std::vector<uint8_t> ShadowOccluded;
+    std::vector<size_t> ShadowPixels;
+    // secondary rays are traced depth first from this stack instead of by recursion
+    std::vector<TSecondaryRay> RayStack;
+    TRenderStats Stats;
+};
+
+// RGB bytes of the picture row by row
+using TImageData = std::vector<uint8_t, TFirstTouchAllocator<uint8_t>>;
+
+enum class TRenderMode {
+    // every pixel is traced to the end before the next one
+    PerPixel,
+    // by TWavefrontRenderer
+    Wavefront,
+};
+
 class TCamera {
   public:
     TCamera(const TPoint& position, const TVector& direction, const std::pair<TAngle, TAngle>& viewAngles,
             const std::pair<uint16_t, uint16_t>& resolution);
 
+    // moves the camera for the next frame of a sequence, the span costs of the last frame are kept
+    void setPose(const TPoint& position, const TVector& direction);
+
     void makePicture(const TFigure& figure);
+    // figures out of the view are culled unless there are lights, the rest are put into a BVH for the frame
+    void makePicture(const std::vector<const TFigure*>& figures);
+    // traces only the pixels of the regions, which must not overlap, and keeps the rest of the picture
+    void makePicture(const TFigure& figure, const std::vector<TPixelRect>& regions);
+    void makePicture(const std::vector<const TFigure*>& figures, const std::vector<TPixelRect>& regions);
+    // by TProgressiveRenderer whatever the render mode and the pixel order are
+    TProgressiveStats makeProgressivePicture(const TFigure& figure, std::chrono::steady_clock::duration budget);
+    TProgressiveStats makeProgressivePicture(const std::vector<const TFigure*>& figures,
+                                             std::chrono::steady_clock::duration budget);
     void savePicture(const char* filename) const;
 
+    // hits are Phong shaded with lights and colored by their coordinates without them
+    void setLights(const std::vector<TLight>& lights);
+    void setMaterial(const TPhongMaterial& material);
+    // material of one figure, the others keep the common one; mirror and glass are traced when lights are set
+    void setMaterial(const TFigure& figure, const TPhongMaterial& material);
+    void setSecondaryRaysOptions(const TSecondaryRaysOptions& options);
+    void setRenderMode(TRenderMode mode);
+    // order primary rays are issued in, a new order moves the image to pages first touched by the span threads
+    void setPixelOrder(TPixelOrder order);
+    // wavefront mode sorts secondary and shadow rays by coherentOrder before intersecting them
+    void setRaySorting(bool enabled);
+    // per-pixel pictures take the spans of every node block costliest first by the costs of the previous picture
+    void setCostScheduling(bool enabled);
+    // finished spans, waves or progressive passes are pushed, dropped when the queue is full; nullptr stops it
+    void setTileQueue(TMpscQueue<TPixelRect>* queue);
+    // called by the pool thread finishing a part, so it must be thread-safe
+    void setTileCallback(std::function<void(const TPixelRect&)> callback);
+
+    // a stop skips the parts of the picture not started yet, they keep their old pixels
+    void setStopToken(std::stop_token token);
+
+    TFrustum getFrustum() const;
+    const TImageData& getImageData() const;
+    // compact copy of a region of the picture, row by row
+    std::vector<uint8_t> getRegionData(const TPixelRect& region) const;
+    // size of the active set of the last picture made over a figures list
+    size_t getActiveFiguresCount() const;
+    const TRenderStats& getRenderStats() const;
+    // parts of the last picture dropped because the tile queue was full, the callback gets every part
+    size_t getDroppedTilesCount() const;
+    // whether the last picture was ended early by a stop request
+    bool isStopped() const;
+    // seconds spent on every span by the last per-pixel picture tracing it, zeros after the pixel order is set
+    const std::vector<double>& getSpanCosts() const;
+    TCostHistogram getSpanCostHistogram(size_t bucketsCount) const;
+
   private:
+    friend class TProgressiveRenderer;
+    friend class TWavefrontRenderer;
+
     TPoint Position_;
     TVector Direction_;
     TAngle WidthViewAngle_;
@@ -24,10 +176,93 @@ class TCamera {
     TVector HalfUpVector_;
     TVector HalfLeftVector_;
 
-    std::vector<uint8_t> ImageData_;
+    TImageData ImageData_;
+    size_t ActiveFiguresCount_ = 0;
+
+    std::vector<TLight> Lights_;
+    TPhongMaterial Material_;
+    std::unordered_map<const TFigure*, TPhongMaterial> FigureMaterials_;
+    TSecondaryRaysOptions SecondaryRaysOptions_;
+    // sum of the counters of the contexts, collected after every picture
+    TRenderStats RenderStats_;
+    // secondary rays of the picture, counted atomically by the pool threads
+    size_t SecondaryRaysCount_ = 0;
+    // context of every pool thread by its index in the pool
+    std::vector<TSpanContext> Contexts_;
+
+    TMpscQueue<TPixelRect>* TileQueue_ = nullptr;
+    // counted atomically by the pool threads
+    size_t DroppedTilesCount_ = 0;
+    std::function<void(const TPixelRect&)> TileCallback_;
+
+    std::stop_token StopToken_;
+    bool Stopped_ = false;
+
+    TRenderMode RenderMode_ = TRenderMode::PerPixel;
+    bool RaySorting_ = true;
+    TPixelOrder PixelOrder_ = TPixelOrder::RowMajor;
+    // tiles of the picture and pixels of a tile in the pixel order
+    std::vector<uint32_t> TileOrder_;
+    std::vector<uint32_t> TilePixelOrder_;
+    bool CostScheduling_ = false;
+    // span costs of the last picture and the spans ordered by them for the next one
+    std::vector<double> SpanCosts_;
+    std::vector<uint32_t> SpanSchedule_;
+    TWavefrontRenderer Wavefront_;
 
     void initHalfUpVector();
     void initHalfLeftVector();
+
+    TProgressiveStats ProgressiveStats_;
+    // regions traced by the current picture sorted by column, the whole picture without them
+    std::optional<std::vector<TPixelRect>> Regions_;
+
+    // fractional coordinates give directions between pixel centers
+    TVector pixelDirection(double row, double column) const;
+    // checks and sorts the regions of the next picture
+    void setRegions(const std::vector<TPixelRect>& regions);
+    bool inRegions(size_t row, size_t column) const;
+    void resetRenderStats();
+    // sums the counters of the contexts into RenderStats_
+    void collectRenderStats();
+    // context of the pool thread calling it
+    TSpanContext& currentContext();
+
+    // makes the picture in the render mode, or progressively when a deadline is given
+    void renderFigure(const TFigure& figure, std::optional<std::chrono::steady_clock::time_point> deadline);
+    void renderFigures(const std::vector<const TFigure*>& figures,
+                       std::optional<std::chrono::steady_clock::time_point> deadline);
+    template <typename THitFunc, typename TOccludedFunc>
+    void tracePicture(const THitFunc& hitFunc, const TOccludedFunc& occludedFunc);
+    // traces the primary rays of the context pixels and shades them
+    template <typename THitFunc, typename TOccludedFunc>
+    void traceSpan(TSpanContext& context, const THitFunc& hitFunc, const TOccludedFunc& occludedFunc);
+    // image rows in row-major order, tiles otherwise
+    size_t spansCount() const;
+    // allocates the image anew, keeping its pixels, with every span first touched by the thread tracing it
+    void placeImage();
+    // pixels of the span in the rows [firstRow, rowsEnd) and the regions, in the pixel order
+    void fillSpan(size_t span, size_t firstRow, size_t rowsEnd, std::vector<size_t>& pixels) const;
+    // publishes a finished part of the picture to the tile queue and the tile callback
+    void publishTile(const TPixelRect& rect);
+    // bounding rectangle of the pixels of a span
+    TPixelRect spanRect(const std::vector<size_t>& pixels) const;
+    template <typename THitFunc, typename TOccludedFunc>
+    void shadeSpan(TSpanContext& context, const THitFunc& hitFunc, const TOccludedFunc& occludedFunc);
+    template <typename THitFunc, typename TOccludedFunc>
+    void traceSecondaryRays(TSpanContext& context, const THitFunc& hitFunc, const TOccludedFunc& occludedFunc);
+    // local shading of a hit with the normal facing the ray, shadow rays are traced one by one
+    template <typename TOccludedFunc>
+    TColor shadeHit(TRenderStats& stats, const THit& hit, const TVector& direction, const TPhongMaterial& material,
+                    const TOccludedFunc& occludedFunc);
+    // puts the mirrored and refracted rays left after the limits into rays and returns their count
+    size_t spawnSecondaryRays(TRenderStats& stats, const THit& hit, const TVector& direction,
+                              const TPhongMaterial& material, const TSecondaryRay& parent,
+                              std::array<TSecondaryRay, 2>& rays);
+    const TPhongMaterial& getMaterial(const TFigure* figure) const;
+    // pixels seeing no figure are written too, so no color of an earlier picture or pass is left in them
+    void writeBackgroundPixel(size_t pixel);
+    void writeUnlitPixel(size_t pixel, const THit& hit);
 };
 
 } // namespace NRayTracingLib
@@ -0,0 +1,62 @@
+#include "figure.h"
+#include "line.h"
+
+namespace NRayTracingLib {
+
+std::optional<std::pair<TPoint, TPointContainment>> TFigure::intersection(const TLine& line) const {
+    const std::optional<THit> lineHit = hit(line, line.minParameter(), INF);
+    if (lineHit == std::nullopt) {
+        return std::nullopt;
+    }
+    return std::make_pair(lineHit.value().Point, lineHit.value().Containment);
+}
+
+std::optional<THit> TFigure::anyHit(const TLine& line, TSafeDouble tMin, TSafeDouble tMax) const {
+    return hit(line, tMin, tMax);
+}
+
+TBounds TFigure::bounds() const { return TBounds::infinite(); }
+
+template <typename TRays>
+static void intersectOneByOne(const TFigure& figure, const TRays& rays, std::span<std::optional<THit>> hits,
+                              bool anyHit) {
+    checkBatchSizes(raysCount(rays), hits.size());
+    for (size_t i = 0; i < hits.size(); i++) {
+        try {
+            const TRay ray{rayOrigin(rays, i), rayDirection(rays, i)};
+            hits[i] = anyHit ? figure.anyHit(ray, 0.0, INF) : figure.hit(ray, 0.0, INF);
+        } catch (const TLineInPlaneError&) {
+            hits[i] = std::nullopt;
+        }
+    }
+}
+
+void TFigure::intersect(std::span<const TRay> rays, std::span<std::optional<THit>> hits) const {
+    intersectOneByOne(*this, rays, hits, false);
+}
+void TFigure::intersect(const TRayBatch& rays, std::span<std::optional<THit>> hits) const {
+    intersectOneByOne(*this, rays, hits, false);
+}
+void TFigure::intersectAny(std::span<const TRay> rays, std::span<std::optional<THit>> hits) const {
+    intersectOneByOne(*this, rays, hits, true);
+}
+void TFigure::intersectAny(const TRayBatch& rays, std::span<std::optional<THit>> hits) const {
+    intersectOneByOne(*this, rays, hits, true);
+}
+
+void TFigure::occluded(std::span<const TRay> rays, std::span<const double> tMaxs, std::span<uint8_t> occluded) const {
+    checkBatchSizes(rays.size(), tMaxs.size());
+    checkBatchSizes(rays.size(), occluded.size());
+    for (size_t i = 0; i < rays.size(); i++) {
+        if (occluded[i]) {
+            continue;
+        }
+        try {
+            occluded[i] = anyHit(rays[i], 0.0, tMaxs[i]).has_value();
+        } catch (const TLineInPlaneError&) {
+            occluded[i] = false;
+        }
+    }
+}
+
+} // namespace NRayTracingLib
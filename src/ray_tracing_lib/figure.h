@@ -1,14 +1,61 @@
 #pragma once
 
+#include "bounds.h"
 #include "point.h"
+#include "ray_batch.h"
 
 namespace NRayTracingLib {
 
 enum class TPointContainment { Outside, Inside, OnBoundary };
 
+static constexpr size_t NO_INDEX = std::numeric_limits<size_t>::max();
+
+class THit {
+  public:
+    // line parameter of the hit: Point == line.Point + line.Vector * T
+    TSafeDouble T;
+    TPoint Point;
+    // unit geometric normal of the hit face
+    TVector Normal;
+    size_t FaceIndex = NO_INDEX;
+    TPointContainment Containment = TPointContainment::Inside;
+    // nearest face edge, from face point EdgeIndex to the next one, and distance from Point to it
+    size_t EdgeIndex = NO_INDEX;
+    TSafeDouble EdgeDistance = INF;
+    // instance of a two-level scene the hit belongs to
+    size_t InstanceIndex = NO_INDEX;
+};
+
+// thrown by intersections of a line lying in a plane of a figure, where the hit point is not defined
+class TLineInPlaneError : public std::runtime_error {
+  public:
+    TLineInPlaneError() : std::runtime_error("Error: itersection of plane and line in it") {}
+};
+
+class TRay;
+
 class TFigure {
   public:
-    virtual std::optional<std::pair<TPoint, TPointContainment>> intersection(const TLine& line) const = 0;
+    // closest to line.Point hit with T in [tMin, tMax]
+    virtual std::optional<THit> hit(const TLine& line, TSafeDouble tMin, TSafeDouble tMax) const = 0;
+    // any hit with T in [tMin, tMax], not necessarily the closest one
+    virtual std::optional<THit> anyHit(const TLine& line, TSafeDouble tMin, TSafeDouble tMax) const;
+
+    // spatial extent of the figure, unbounded unless a figure knows better
+    virtual TBounds bounds() const;
+
+    // batch queries: hits[i] receives the closest (or any) hit of rays[i] with T >= 0,
+    // rays lying in a plane of the figure are counted as misses instead of throwing TLineInPlaneError,
+    // other errors are thrown
+    virtual void intersect(std::span<const TRay> rays, std::span<std::optional<THit>> hits) const;
+    virtual void intersect(const TRayBatch& rays, std::span<std::optional<THit>> hits) const;
+    virtual void intersectAny(std::span<const TRay> rays, std::span<std::optional<THit>> hits) const;
+    virtual void intersectAny(const TRayBatch& rays, std::span<std::optional<THit>> hits) const;
+    // occlusion only batch query for shadow rays: occluded[i] is set when rays[i] hits the figure with T in
+    // [0, tMaxs[i]], no hit is built; rays already marked occluded are skipped
+    virtual void occluded(std::span<const TRay> rays, std::span<const double> tMaxs, std::span<uint8_t> occluded) const;
+
+    std::optional<std::pair<TPoint, TPointContainment>> intersection(const TLine& line) const;
 
     virtual ~TFigure() = default;
 };
@@ -0,0 +1,84 @@
+#include "figure_set.h"
+
+namespace NRayTracingLib {
+
+TFigureSet::TFigureSet() {}
+TFigureSet::TFigureSet(const std::vector<TFigureVariant>& figures) {
+    for (const auto& figure : figures) {
+        add(figure);
+    }
+}
+
+void TFigureSet::add(const TFigureVariant& figure) {
+    Box_.extend(std::visit([](const auto& concreteFigure) { return concreteFigure.bounds().Box; }, figure));
+    std::visit(
+        [this](const auto& concreteFigure) {
+            using TConcreteFigure = std::decay_t<decltype(concreteFigure)>;
+            if constexpr (std::is_same_v<TConcreteFigure, TPlane>) {
+                Planes_.push_back(concreteFigure);
+            } else if constexpr (std::is_same_v<TConcreteFigure, TPolygon>) {
+                Polygons_.push_back(concreteFigure);
+            } else {
+                Polyhedrons_.push_back(concreteFigure);
+            }
+        },
+        figure);
+}
+size_t TFigureSet::size() const { return Planes_.size() + Polygons_.size() + Polyhedrons_.size(); }
+
+TBounds TFigureSet::bounds() const { return TBounds{Box_}; }
+
+template <typename TConcreteFigure>
+static void hitNearest(const std::vector<TConcreteFigure>& figures, const TLine& line, TSafeDouble& tMin,
+                       TSafeDouble& tMax, std::optional<THit>& nearest) {
+    for (const auto& figure : figures) {
+        // TConcreteFigure::hit is final, so this call is resolved statically
+        std::optional<THit> figureHit = figure.hit(line, tMin, tMax);
+        if (figureHit == std::nullopt) {
+            continue;
+        }
+        const TSafeDouble distance = figureHit.value().T.abs();
+        tMin = std::max(tMin.Value, -distance.Value);
+        tMax = std::min(tMax.Value, distance.Value);
+        nearest = figureHit;
+    }
+}
+
+template <typename TConcreteFigure>
+static std::optional<THit> hitAny(const std::vector<TConcreteFigure>& figures, const TLine& line, TSafeDouble tMin,
+                                  TSafeDouble tMax) {
+    for (const auto& figure : figures) {
+        std::optional<THit> figureHit = figure.anyHit(line, tMin, tMax);
+        if (figureHit != std::nullopt) {
+            return figureHit;
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<THit> TFigureSet::hit(const TLine& line, TSafeDouble tMin, TSafeDouble tMax) const {
+    std::optional<THit> nearest;
+    if (!Box_.intersects(line.Point, line.Vector, tMin, tMax)) {
+        return nearest;
+    }
+    hitNearest(Planes_, line, tMin, tMax, nearest);
+    hitNearest(Polygons_, line, tMin, tMax, nearest);
+    hitNearest(Polyhedrons_, line, tMin, tMax, nearest);
+    return nearest;
+}
+
+std::optional<THit> TFigureSet::anyHit(const TLine& line, TSafeDouble tMin, TSafeDouble tMax) const {
+    if (!Box_.intersects(line.Point, line.Vector, tMin, tMax)) {
+        return std::nullopt;
+    }
+    std::optional<THit> found = hitAny(Planes_, line, tMin, tMax);
+    if (found == std::nullopt) {
+        found = hitAny(Polygons_, line, tMin, tMax);
+    }
+    if (found == std::nullopt) {
+        found = hitAny(Polyhedrons_, line, tMin, tMax);
+    }
+    return found;
+}
+
+} // namespace NRayTracingLib
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "common.h"
+#include "figure.h"
+#include "plane.h"
+#include "polygon.h"
+#include "polyhedron.h"
+
+#include <variant>
+
+namespace NRayTracingLib {
+
+// statically dispatched set of figures: every known figure type is kept in its own contiguous array,
+// so hit queries loop over each array without virtual calls and the face loops can be inlined
+class TFigureSet : public TFigure {
+  public:
+    using TFigureVariant = std::variant<TPlane, TPolygon, TPolyhedron>;
+
+    TFigureSet();
+    explicit TFigureSet(const std::vector<TFigureVariant>& figures);
+
+    void add(const TFigureVariant& figure);
+    size_t size() const;
+
+    TBounds bounds() const final;
+
+    std::optional<THit> hit(const TLine& line, TSafeDouble tMin, TSafeDouble tMax) const final;
+    std::optional<THit> anyHit(const TLine& line, TSafeDouble tMin, TSafeDouble tMax) const final;
+
+  private:
+    std::vector<TPlane> Planes_;
+    std::vector<TPolygon> Polygons_;
+    std::vector<TPolyhedron> Polyhedrons_;
+    TBoundingBox Box_;
+};
+
+} // namespace NRayTracingLib
@@ -0,0 +1,81 @@
+#include "frustum.h"
+
+namespace NRayTracingLib {
+
+static TVector inwardNormal(const TVector& normal, const TVector& direction) {
+    return (normal * direction < 0.0) ? -normal : normal;
+}
+
+TFrustum::TFrustum(const TPoint& apex, const TVector& direction, const std::array<TVector, 4>& corners) {
+    Planes[0] = TPlane{apex, direction};
+    for (size_t i = 0; i < 4; i++) {
+        const TVector normal = corners[i] ^ corners[(i + 1) % 4];
+        if (normal.isZero()) {
+            throw std::runtime_error("Error: creating frustum with parallel corners");
+        }
+        Planes[i + 1] = TPlane{apex, inwardNormal(normal, direction)};
+    }
+}
+
+// positive inside
+static double signedDistance(const TPlane& plane, const TPoint& point) {
+    return ((point - plane.Point) * plane.Normal).Value;
+}
+
+// the box corner farthest along the direction and the opposite one
+static std::pair<TPoint, TPoint> extremeCorners(const TBoundingBox& box, const TVector& direction) {
+    const TPoint farthest{direction.X >= 0.0 ? box.Max.X : box.Min.X, direction.Y >= 0.0 ? box.Max.Y : box.Min.Y,
+                          direction.Z >= 0.0 ? box.Max.Z : box.Min.Z};
+    const TPoint nearest{direction.X >= 0.0 ? box.Min.X : box.Max.X, direction.Y >= 0.0 ? box.Min.Y : box.Max.Y,
+                         direction.Z >= 0.0 ? box.Min.Z : box.Max.Z};
+    return {farthest, nearest};
+}
+
+bool TFrustum::containsPoint(const TPoint& point) const {
+    for (const auto& plane : Planes) {
+        if (signedDistance(plane, point) < -ACCURACY) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool TFrustum::intersects(const TBoundingBox& box) const {
+    if (box.isEmpty()) {
+        return false;
+    }
+    if (box.isInfinite()) {
+        return true;
+    }
+    for (const auto& plane : Planes) {
+        if (signedDistance(plane, extremeCorners(box, plane.Normal).first) < -ACCURACY) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool TFrustum::contains(const TBoundingBox& box) const {
+    if (box.isEmpty() || box.isInfinite()) {
+        return false;
+    }
+    for (const auto& plane : Planes) {
+        if (signedDistance(plane, extremeCorners(box, plane.Normal).second) < -ACCURACY) {
+            return false;
+        }
+    }
+    return true;
+}
+
+TBoxOverlap TFrustum::overlap(const TBoundingBox& box) const {
+    if (!intersects(box)) {
+        return TBoxOverlap::Outside;
+    }
+    return contains(box) ? TBoxOverlap::Inside : TBoxOverlap::Partial;
+}
+
+std::vector<uint32_t> cull(const TBvh& bvh, const TFrustum& frustum) {
+    return bvh.query([&frustum](const TBoundingBox& box) { return frustum.overlap(box); });
+}
+
+} // namespace NRayTracingLib
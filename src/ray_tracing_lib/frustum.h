@@ -0,0 +1,31 @@
+#pragma once
+
+#include "bounds.h"
+#include "bvh.h"
+#include "common.h"
+#include "plane.h"
+
+#include <array>
+
+namespace NRayTracingLib {
+
+// part of space seen from the apex through a rectangular window: in front of the apex and inside four side planes
+class TFrustum {
+  public:
+    // normals point inside the frustum, the first plane is the one through the apex facing the view direction
+    std::array<TPlane, 5> Planes;
+
+    // corners are directions from the apex to the window corners going around it
+    explicit TFrustum(const TPoint& apex, const TVector& direction, const std::array<TVector, 4>& corners);
+
+    bool containsPoint(const TPoint& point) const;
+    // conservative test: boxes near the frustum edges may be kept while being outside
+    bool intersects(const TBoundingBox& box) const;
+    bool contains(const TBoundingBox& box) const;
+    TBoxOverlap overlap(const TBoundingBox& box) const;
+};
+
+// primitives of the BVH leaves intersecting the frustum, subtrees lying inside it are taken without more tests
+std::vector<uint32_t> cull(const TBvh& bvh, const TFrustum& frustum);
+
+} // namespace NRayTracingLib
@@ -0,0 +1,234 @@
+#include "grid.h"
+#include "line.h"
+
+namespace NRayTracingLib {
+
+static constexpr size_t MAX_GRID_RESOLUTION = 512;
+
+void TDenseCells::build(size_t cellsCount, std::vector<std::pair<size_t, uint32_t>>& cellPolygons) {
+    Offsets_.assign(cellsCount + 1, 0);
+    for (const auto& [cell, polygon] : cellPolygons) {
+        Offsets_[cell + 1]++;
+    }
+    for (size_t cell = 0; cell < cellsCount; cell++) {
+        Offsets_[cell + 1] += Offsets_[cell];
+    }
+
+    std::vector<uint32_t> filled(Offsets_.begin(), Offsets_.end() - 1);
+    Polygons_.resize(cellPolygons.size());
+    for (const auto& [cell, polygon] : cellPolygons) {
+        Polygons_[filled[cell]++] = polygon;
+    }
+}
+std::span<const uint32_t> TDenseCells::at(size_t cell) const {
+    return std::span<const uint32_t>{Polygons_.data() + Offsets_[cell], Offsets_[cell + 1] - Offsets_[cell]};
+}
+size_t TDenseCells::getStoredCellsCount() const { return Offsets_.size() - 1; }
+
+void THashedCells::build(size_t, std::vector<std::pair<size_t, uint32_t>>& cellPolygons) {
+    for (const auto& [cell, polygon] : cellPolygons) {
+        Cells_[cell].push_back(polygon);
+    }
+}
+std::span<const uint32_t> THashedCells::at(size_t cell) const {
+    const auto found = Cells_.find(cell);
+    if (found == Cells_.end()) {
+        return {};
+    }
+    return found->second;
+}
+size_t THashedCells::getStoredCellsCount() const { return Cells_.size(); }
+
+template <typename TCells>
+void TVoxelGrid<TCells>::chooseResolution() {
+    const TVector size = Box_.diagonal();
+    std::array<double, 3> sizes = {size.X.Value, size.Y.Value, size.Z.Value};
+    // flat scenes get a thin slab instead of zero volume
+    const double maxSize = std::max({sizes[0], sizes[1], sizes[2]});
+    for (double& axisSize : sizes) {
+        axisSize = std::max(axisSize, maxSize / static_cast<double>(MAX_GRID_RESOLUTION));
+    }
+    const double volume = sizes[0] * sizes[1] * sizes[2];
+    const double cellsPerUnit = std::cbrt(GRID_DENSITY * static_cast<double>(Polygons_.size()) / volume);
+
+    for (size_t axis = 0; axis < 3; axis++) {
+        const double resolution = std::round(sizes[axis] * cellsPerUnit);
+        Resolution_[axis] = std::clamp(static_cast<size_t>(resolution), size_t{1}, MAX_GRID_RESOLUTION);
+        CellSize_[axis] = sizes[axis] / static_cast<double>(Resolution_[axis]);
+    }
+}
+
+template <typename TCells>
+std::array<size_t, 3> TVoxelGrid<TCells>::cellOf(const TPoint& point) const {
+    const std::array<double, 3> coordinates = {point.X.Value - Box_.Min.X.Value, point.Y.Value - Box_.Min.Y.Value,
+                                               point.Z.Value - Box_.Min.Z.Value};
+    std::array<size_t, 3> cell;
+    for (size_t axis = 0; axis < 3; axis++) {
+        const double index = std::floor(coordinates[axis] / CellSize_[axis]);
+        cell[axis] = static_cast<size_t>(std::clamp(index, 0.0, static_cast<double>(Resolution_[axis] - 1)));
+    }
+    return cell;
+}
+
+template <typename TCells>
+TVoxelGrid<TCells>::TVoxelGrid(const std::vector<TPolygon>& polygons) : Polygons_(polygons) {
+    if (Polygons_.empty()) {
+        throw std::runtime_error("Error: creating voxel grid without polygons");
+    }
+    for (const auto& polygon : Polygons_) {
+        Box_.extend(polygon.bounds().Box);
+    }
+
+    chooseResolution();
+
+    std::vector<std::pair<size_t, uint32_t>> cellPolygons;
+    for (size_t i = 0; i < Polygons_.size(); i++) {
+        const TBoundingBox box = Polygons_[i].bounds().Box;
+        const std::array<size_t, 3> first = cellOf(box.Min);
+        const std::array<size_t, 3> last = cellOf(box.Max);
+        for (size_t z = first[2]; z <= last[2]; z++) {
+            for (size_t y = first[1]; y <= last[1]; y++) {
+                for (size_t x = first[0]; x <= last[0]; x++) {
+                    const size_t cell = (z * Resolution_[1] + y) * Resolution_[0] + x;
+                    cellPolygons.emplace_back(cell, static_cast<uint32_t>(i));
+                }
+            }
+        }
+    }
+    Cells_.build(Resolution_[0] * Resolution_[1] * Resolution_[2], cellPolygons);
+}
+
+template <typename TCells>
+const std::vector<TPolygon>& TVoxelGrid<TCells>::getPolygons() const {
+    return Polygons_;
+}
+template <typename TCells>
+const std::array<size_t, 3>& TVoxelGrid<TCells>::getResolution() const {
+    return Resolution_;
+}
+template <typename TCells>
+size_t TVoxelGrid<TCells>::getStoredCellsCount() const {
+    return Cells_.getStoredCellsCount();
+}
+
+template <typename TCells>
+TBounds TVoxelGrid<TCells>::bounds() const {
+    return TBounds{Box_};
+}
+
+template <typename TCells>
+std::optional<THit> TVoxelGrid<TCells>::march(const TPoint& origin, const TVector& direction, double tMin,
+                                              double tMax, bool anyHit) const {
+    // hits with T in [tMin, tMax] in order of increasing T
+    const std::optional<std::pair<double, double>> inside = Box_.clip(origin, direction, tMin, tMax);
+    if (inside == std::nullopt) {
+        return std::nullopt;
+    }
+
+    const std::array<double, 3> origins = {origin.X.Value, origin.Y.Value, origin.Z.Value};
+    const std::array<double, 3> directions = {direction.X.Value, direction.Y.Value, direction.Z.Value};
+    const std::array<double, 3> mins = {Box_.Min.X.Value, Box_.Min.Y.Value, Box_.Min.Z.Value};
+
+    const std::array<size_t, 3> startCell = cellOf(origin + direction * inside.value().first);
+    std::array<long long, 3> cell;
+    std::array<long long, 3> step;
+    std::array<double, 3> tNext;
+    std::array<double, 3> tDelta;
+    for (size_t axis = 0; axis < 3; axis++) {
+        cell[axis] = static_cast<long long>(startCell[axis]);
+        if (directions[axis] > 0.0) {
+            step[axis] = 1;
+            tNext[axis] = (mins[axis] + (cell[axis] + 1) * CellSize_[axis] - origins[axis]) / directions[axis];
+            tDelta[axis] = CellSize_[axis] / directions[axis];
+        } else if (directions[axis] < 0.0) {
+            step[axis] = -1;
+            tNext[axis] = (mins[axis] + cell[axis] * CellSize_[axis] - origins[axis]) / directions[axis];
+            tDelta[axis] = -CellSize_[axis] / directions[axis];
+        } else {
+            step[axis] = 0;
+            tNext[axis] = INF;
+            tDelta[axis] = INF;
+        }
+    }
+
+    while (true) {
+        const double cellExit = std::min({tNext[0], tNext[1], tNext[2]});
+        const size_t cellIdx = (cell[2] * Resolution_[1] + cell[1]) * Resolution_[0] + cell[0];
+
+        // only hits inside the current voxel are confirmed, farther ones may be hidden by the next voxels
+        double tLimit = anyHit ? inside.value().second : std::min(cellExit + ACCURACY, inside.value().second);
+        std::optional<THit> nearest;
+        for (const uint32_t polygonIdx : Cells_.at(cellIdx)) {
+            std::optional<THit> polygonHit = Polygons_[polygonIdx].rayHitWithoutEdge(origin, direction, tMin, tLimit);
+            if (polygonHit != std::nullopt && anyHit) {
+                Polygons_[polygonIdx].fillEdgeData(polygonHit.value());
+                polygonHit.value().FaceIndex = polygonIdx;
+                return polygonHit;
+            }
+            if (polygonHit != std::nullopt) {
+                tLimit = polygonHit.value().T.Value;
+                nearest = polygonHit;
+                nearest.value().FaceIndex = polygonIdx;
+            }
+        }
+        if (nearest != std::nullopt) {
+            Polygons_[nearest.value().FaceIndex].fillEdgeData(nearest.value());
+            return nearest;
+        }
+
+        if (cellExit > inside.value().second) {
+            return std::nullopt;
+        }
+        const size_t axis = (tNext[0] < tNext[1]) ? (tNext[0] < tNext[2] ? 0 : 2) : (tNext[1] < tNext[2] ? 1 : 2);
+        cell[axis] += step[axis];
+        if (cell[axis] < 0 || cell[axis] >= static_cast<long long>(Resolution_[axis])) {
+            return std::nullopt;
+        }
+        tNext[axis] += tDelta[axis];
+    }
+}
+
+template <typename TCells>
+std::optional<THit> TVoxelGrid<TCells>::hit(const TLine& line, TSafeDouble tMin, TSafeDouble tMax) const {
+    // voxels are marched by increasing T, so the part of the line before its point is marched backwards
+    std::optional<THit> forward;
+    if (tMax.Value >= 0.0) {
+        forward = march(line.Point, line.Vector, std::max(tMin.Value, 0.0), tMax.Value, false);
+    }
+    std::optional<THit> backward;
+    if (tMin.Value < 0.0) {
+        backward = march(line.Point, -line.Vector, std::max(-tMax.Value, 0.0), -tMin.Value, false);
+        if (backward != std::nullopt) {
+            backward.value().T = -backward.value().T;
+        }
+    }
+
+    if (backward != std::nullopt && (forward == std::nullopt || -backward.value().T < forward.value().T)) {
+        return backward;
+    }
+    return forward;
+}
+
+template <typename TCells>
+std::optional<THit> TVoxelGrid<TCells>::anyHit(const TLine& line, TSafeDouble tMin, TSafeDouble tMax) const {
+    if (tMax.Value >= 0.0) {
+        std::optional<THit> forward = march(line.Point, line.Vector, std::max(tMin.Value, 0.0), tMax.Value, true);
+        if (forward != std::nullopt) {
+            return forward;
+        }
+    }
+    if (tMin.Value < 0.0) {
+        std::optional<THit> backward =
+            march(line.Point, -line.Vector, std::max(-tMax.Value, 0.0), -tMin.Value, true);
+        if (backward != std::nullopt) {
+            backward.value().T = -backward.value().T;
+            return backward;
+        }
+    }
+    return std::nullopt;
+}
+
+template class TVoxelGrid<TDenseCells>;
+template class TVoxelGrid<THashedCells>;
+
+} // namespace NRayTracingLib
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "bounds.h"
+#include "common.h"
+#include "figure.h"
+#include "polygon.h"
+
+#include <array>
+
+namespace NRayTracingLib {
+
+// voxel contents stored densely: one offsets entry per voxel, suits evenly filled scenes
+class TDenseCells {
+  public:
+    // cellPolygons holds (voxel index, polygon index) pairs
+    void build(size_t cellsCount, std::vector<std::pair<size_t, uint32_t>>& cellPolygons);
+    std::span<const uint32_t> at(size_t cell) const;
+    size_t getStoredCellsCount() const;
+
+  private:
+    std::vector<uint32_t> Offsets_;
+    std::vector<uint32_t> Polygons_;
+};
+
+// voxel contents stored in a hash table: memory grows with occupied voxels only, suits sparse scenes
+class THashedCells {
+  public:
+    void build(size_t cellsCount, std::vector<std::pair<size_t, uint32_t>>& cellPolygons);
+    std::span<const uint32_t> at(size_t cell) const;
+    size_t getStoredCellsCount() const;
+
+  private:
+    std::unordered_map<size_t, std::vector<uint32_t>> Cells_;
+};
+
+// acceleration structure over polygons: polygons are binned into equal voxels of their common box,
+// rays march through the voxels front to back with 3D-DDA and stop at the first voxel confirming a hit
+template <typename TCells>
+class TVoxelGrid : public TFigure {
+  public:
+    // voxels per axis are chosen from the polygons count, about GRID_DENSITY voxels per polygon
+    explicit TVoxelGrid(const std::vector<TPolygon>& polygons);
+
+    const std::vector<TPolygon>& getPolygons() const;
+    const std::array<size_t, 3>& getResolution() const;
+    size_t getStoredCellsCount() const;
+
+    TBounds bounds() const final;
+
+    // FaceIndex of the hit is the polygon index
+    std::optional<THit> hit(const TLine& line, TSafeDouble tMin, TSafeDouble tMax) const final;
+    std::optional<THit> anyHit(const TLine& line, TSafeDouble tMin, TSafeDouble tMax) const final;
+
+  private:
+    std::vector<TPolygon> Polygons_;
+    TBoundingBox Box_;
+    std::array<size_t, 3> Resolution_;
+    std::array<double, 3> CellSize_;
+    TCells Cells_;
+
+    void chooseResolution();
+    std::array<size_t, 3> cellOf(const TPoint& point) const;
+    // any hit is returned from the first voxel holding one when anyHit is set, the nearest one otherwise
+    std::optional<THit> march(const TPoint& origin, const TVector& direction, double tMin, double tMax,
+                              bool anyHit) const;
+};
+
+static constexpr double GRID_DENSITY = 4.0;
+
+using TUniformGrid = TVoxelGrid<TDenseCells>;
+using TSpatialHashGrid = TVoxelGrid<THashedCells>;
+
+} // namespace NRayTracingLib
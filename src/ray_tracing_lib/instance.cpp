@@ -0,0 +1,101 @@
+#include "instance.h"
+#include "line.h"
+
+namespace NRayTracingLib {
+
+TInstance::TInstance(std::shared_ptr<const TFigure> figure, const TTransform& objectToWorld)
+    : Figure_(std::move(figure)), ObjectToWorld_(objectToWorld), WorldToObject_(objectToWorld.inverse()) {
+    if (Figure_ == nullptr) {
+        throw std::runtime_error("Error: creating instance without figure");
+    }
+    Box_ = ObjectToWorld_.apply(Figure_->bounds().Box);
+}
+
+const TFigure& TInstance::getFigure() const { return *Figure_; }
+const TTransform& TInstance::getTransform() const { return ObjectToWorld_; }
+
+TBounds TInstance::bounds() const { return TBounds{Box_}; }
+
+TLine TInstance::toObject(const TLine& line) const {
+    return TLine{WorldToObject_.apply(line.Point), WorldToObject_.apply(line.Vector)};
+}
+std::optional<THit> TInstance::toWorld(std::optional<THit> objectHit) const {
+    if (objectHit != std::nullopt) {
+        objectHit.value().Point = ObjectToWorld_.apply(objectHit.value().Point);
+        objectHit.value().Normal = WorldToObject_.applyTransposed(objectHit.value().Normal).getNormalized();
+    }
+    return objectHit;
+}
+
+std::optional<THit> TInstance::hit(const TLine& line, TSafeDouble tMin, TSafeDouble tMax) const {
+    if (!Box_.intersects(line.Point, line.Vector, tMin, tMax)) {
+        return std::nullopt;
+    }
+    return toWorld(Figure_->hit(toObject(line), tMin, tMax));
+}
+std::optional<THit> TInstance::anyHit(const TLine& line, TSafeDouble tMin, TSafeDouble tMax) const {
+    if (!Box_.intersects(line.Point, line.Vector, tMin, tMax)) {
+        return std::nullopt;
+    }
+    return toWorld(Figure_->anyHit(toObject(line), tMin, tMax));
+}
+
+static std::vector<TBoundingBox> instanceBoxes(const std::vector<TInstance>& instances) {
+    std::vector<TBoundingBox> boxes;
+    boxes.reserve(instances.size());
+    for (const auto& instance : instances) {
+        boxes.push_back(instance.bounds().Box);
+        if (boxes.back().isInfinite()) {
+            throw std::runtime_error("Error: creating scene with unbounded instance");
+        }
+    }
+    return boxes;
+}
+
+TScene::TScene(const std::vector<TInstance>& instances, size_t threadsCount)
+    : Instances_(instances), Bvh_(instanceBoxes(instances), threadsCount) {}
+
+const std::vector<TInstance>& TScene::getInstances() const { return Instances_; }
+const TBvh& TScene::getBvh() const { return Bvh_; }
+
+std::vector<const TFigure*> TScene::visibleInstances(const TFrustum& frustum) const {
+    std::vector<const TFigure*> visible;
+    for (const uint32_t instanceIdx : cull(Bvh_, frustum)) {
+        visible.push_back(&Instances_[instanceIdx]);
+    }
+    return visible;
+}
+
+TBounds TScene::bounds() const { return TBounds{Bvh_.bounds()}; }
+
+std::optional<THit> TScene::hit(const TLine& line, TSafeDouble tMin, TSafeDouble tMax) const {
+    std::optional<THit> nearest;
+    Bvh_.traverse(line.Point, line.Vector, tMin.Value, tMax.Value,
+                  [&](uint32_t instanceIdx, double& currentMin, double& currentMax) {
+                      std::optional<THit> instanceHit = Instances_[instanceIdx].hit(line, currentMin, currentMax);
+                      if (instanceHit == std::nullopt) {
+                          return;
+                      }
+                      const double distance = instanceHit.value().T.abs().Value;
+                      currentMin = std::max(currentMin, -distance);
+                      currentMax = std::min(currentMax, distance);
+                      nearest = instanceHit;
+                      nearest.value().InstanceIndex = instanceIdx;
+                  });
+    return nearest;
+}
+std::optional<THit> TScene::anyHit(const TLine& line, TSafeDouble tMin, TSafeDouble tMax) const {
+    std::optional<THit> found;
+    Bvh_.traverse(line.Point, line.Vector, tMin.Value, tMax.Value,
+                  [&](uint32_t instanceIdx, double& currentMin, double& currentMax) {
+                      found = Instances_[instanceIdx].anyHit(line, currentMin, currentMax);
+                      if (found == std::nullopt) {
+                          return false;
+                      }
+                      found.value().InstanceIndex = instanceIdx;
+                      return true;
+                  });
+    return found;
+}
+
+} // namespace NRayTracingLib
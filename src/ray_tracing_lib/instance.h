@@ -0,0 +1,60 @@
+#pragma once
+
+#include "bvh.h"
+#include "common.h"
+#include "figure.h"
+#include "frustum.h"
+#include "parallel.h"
+#include "transform.h"
+
+#include <memory>
+
+namespace NRayTracingLib {
+
+// placement of a shared figure: rays are moved into the figure space instead of copying the figure,
+// so any number of instances costs one figure plus a transform each
+class TInstance : public TFigure {
+  public:
+    explicit TInstance(std::shared_ptr<const TFigure> figure, const TTransform& objectToWorld);
+
+    const TFigure& getFigure() const;
+    const TTransform& getTransform() const;
+
+    TBounds bounds() const final;
+
+    std::optional<THit> hit(const TLine& line, TSafeDouble tMin, TSafeDouble tMax) const final;
+    std::optional<THit> anyHit(const TLine& line, TSafeDouble tMin, TSafeDouble tMax) const final;
+
+  private:
+    std::shared_ptr<const TFigure> Figure_;
+    TTransform ObjectToWorld_;
+    TTransform WorldToObject_;
+    TBoundingBox Box_;
+
+    // the transformed direction is not normalized, so T of the object space hit is the world one
+    TLine toObject(const TLine& line) const;
+    std::optional<THit> toWorld(std::optional<THit> objectHit) const;
+};
+
+// two-level acceleration: a BVH over instance boxes on top of the acceleration structures of shared figures
+class TScene : public TFigure {
+  public:
+    explicit TScene(const std::vector<TInstance>& instances, size_t threadsCount = threadPool().getThreadsCount());
+
+    const std::vector<TInstance>& getInstances() const;
+    const TBvh& getBvh() const;
+    // instances possibly seen through the frustum, found by culling whole BVH subtrees
+    std::vector<const TFigure*> visibleInstances(const TFrustum& frustum) const;
+
+    TBounds bounds() const final;
+
+    // InstanceIndex of the hit is the instance index, FaceIndex is the face of the instanced figure
+    std::optional<THit> hit(const TLine& line, TSafeDouble tMin, TSafeDouble tMax) const final;
+    std::optional<THit> anyHit(const TLine& line, TSafeDouble tMin, TSafeDouble tMax) const final;
+
+  private:
+    std::vector<TInstance> Instances_;
+    TBvh Bvh_;
+};
+
+} // namespace NRayTracingLib
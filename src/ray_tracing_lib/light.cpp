@@ -0,0 +1,122 @@
+#include "light.h"
+
+namespace NRayTracingLib {
+
+TColor::TColor(double r, double g, double b) : R{r}, G{g}, B{b} {}
+
+TColor TColor::operator+(const TColor& other) const { return TColor{R + other.R, G + other.G, B + other.B}; }
+TColor& TColor::operator+=(const TColor& other) {
+    R += other.R;
+    G += other.G;
+    B += other.B;
+    return *this;
+}
+TColor TColor::operator*(double n) const { return TColor{R * n, G * n, B * n}; }
+TColor TColor::operator*(const TColor& other) const { return TColor{R * other.R, G * other.G, B * other.B}; }
+
+bool TColor::operator==(const TColor& other) const {
+    return TSafeDouble{R} == other.R && TSafeDouble{G} == other.G && TSafeDouble{B} == other.B;
+}
+
+static uint8_t channelToByte(double channel) {
+    return static_cast<uint8_t>(std::clamp(channel, 0.0, 1.0) * 255.0 + 0.5);
+}
+
+std::array<uint8_t, 3> TColor::toBytes() const { return {channelToByte(R), channelToByte(G), channelToByte(B)}; }
+
+std::ostream& operator<<(std::ostream& os, const TColor& color) {
+    os << "color(" << color.R << ", " << color.G << ", " << color.B << ")";
+    return os;
+}
+
+TColor TPhongMaterial::reflect(const TColor& light, const TVector& normal, const TVector& toLight,
+                               const TVector& toViewer) const {
+    const double lambert = (normal * toLight).Value;
+    if (lambert <= 0.0) {
+        return TColor{};
+    }
+    TColor reflected = Diffuse * lambert;
+    // mirrored light direction
+    const TVector mirrored = normal * (2.0 * lambert) - toLight;
+    const double highlight = (mirrored * toViewer).Value;
+    if (highlight > 0.0) {
+        reflected += Specular * std::pow(highlight, Shininess);
+    }
+    return reflected * light;
+}
+
+TPhongMaterial TPhongMaterial::mirror() {
+    TPhongMaterial material;
+    material.Ambient = TColor{};
+    material.Diffuse = TColor{0.05, 0.05, 0.05};
+    material.Specular = TColor{0.5, 0.5, 0.5};
+    material.Reflectivity = 0.9;
+    return material;
+}
+TPhongMaterial TPhongMaterial::glass(double refractiveIndex) {
+    if (refractiveIndex <= 0.0) {
+        throw std::runtime_error("Error: creating glass with not positive refractive index");
+    }
+    TPhongMaterial material;
+    material.Ambient = TColor{};
+    material.Diffuse = TColor{};
+    material.Specular = TColor{0.5, 0.5, 0.5};
+    material.Reflectivity = 0.1;
+    material.Transparency = 0.9;
+    material.RefractiveIndex = refractiveIndex;
+    return material;
+}
+
+double TPhongMaterial::localWeight() const { return std::max(0.0, 1.0 - Reflectivity - Transparency); }
+
+TVector reflectDirection(const TVector& direction, const TVector& normal) {
+    return direction - normal * (2.0 * (direction * normal).Value);
+}
+
+std::optional<TVector> refractDirection(const TVector& direction, const TVector& normal, double eta) {
+    const TVector unit = direction.getNormalized();
+    const double cosIncident = -(unit * normal).Value;
+    const double cosSquared = 1.0 - eta * eta * (1.0 - cosIncident * cosIncident);
+    if (cosSquared < 0.0) {
+        return std::nullopt;
+    }
+    return unit * eta + normal * (eta * cosIncident - std::sqrt(cosSquared));
+}
+
+TLight TLight::point(const TPoint& position, const TColor& intensity) {
+    TLight light;
+    light.Type_ = TLightType::Point;
+    light.Position_ = position;
+    light.Intensity_ = intensity;
+    return light;
+}
+TLight TLight::directional(const TVector& direction, const TColor& intensity) {
+    if (direction.isZero()) {
+        throw std::runtime_error("Error: creating directional light with zero direction");
+    }
+    TLight light;
+    light.Type_ = TLightType::Directional;
+    light.Direction_ = direction.getNormalized();
+    light.Intensity_ = intensity;
+    return light;
+}
+
+TLightType TLight::getType() const { return Type_; }
+const TColor& TLight::getIntensity() const { return Intensity_; }
+
+std::pair<TVector, double> TLight::shadowRay(const TPoint& point) const {
+    if (Type_ == TLightType::Directional) {
+        return {-Direction_, INF};
+    }
+    return {Position_ - point, 1.0};
+}
+
+TColor TLight::intensityAt(const TPoint& point) const {
+    if (Type_ == TLightType::Directional) {
+        return Intensity_;
+    }
+    const double squaredDistance = ((Position_ - point) * (Position_ - point)).Value;
+    return Intensity_ * (1.0 / squaredDistance);
+}
+
+} // namespace NRayTracingLib
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "common.h"
+#include "point.h"
+#include "vector.h"
+
+#include <array>
+
+namespace NRayTracingLib {
+
+// linear RGB color, channels are not clamped until converted to bytes
+class TColor {
+  public:
+    double R = 0.0;
+    double G = 0.0;
+    double B = 0.0;
+
+    TColor() = default;
+    explicit TColor(double r, double g, double b);
+
+    TColor operator+(const TColor& other) const;
+    TColor& operator+=(const TColor& other);
+    TColor operator*(double n) const;
+    // channel by channel product, used to filter light by a surface color
+    TColor operator*(const TColor& other) const;
+
+    bool operator==(const TColor& other) const;
+
+    std::array<uint8_t, 3> toBytes() const;
+
+    friend std::ostream& operator<<(std::ostream& os, const TColor& color);
+};
+
+// Phong reflection model coefficients of a surface; the parts of the light mirrored and refracted by it
+// are traced as secondary rays, the rest is shaded locally
+class TPhongMaterial {
+  public:
+    TColor Ambient{0.1, 0.1, 0.1};
+    TColor Diffuse{0.7, 0.7, 0.7};
+    TColor Specular{0.2, 0.2, 0.2};
+    double Shininess = 32.0;
+    double Reflectivity = 0.0;
+    double Transparency = 0.0;
+    double RefractiveIndex = 1.0;
+
+    static TPhongMaterial mirror();
+    static TPhongMaterial glass(double refractiveIndex = 1.5);
+
+    // share of the light shaded locally
+    double localWeight() const;
+
+    // diffuse and specular light reflected to the viewer, all vectors are unit and point away from the surface
+    TColor reflect(const TColor& light, const TVector& normal, const TVector& toLight, const TVector& toViewer) const;
+};
+
+// direction of a ray mirrored by a surface, the unit normal faces the ray
+TVector reflectDirection(const TVector& direction, const TVector& normal);
+// direction of a ray refracted by a surface with the relative refractive index eta, the ratio of the indices
+// of the medium the ray leaves and the medium it enters; no direction in case of total internal reflection
+std::optional<TVector> refractDirection(const TVector& direction, const TVector& normal, double eta);
+
+enum class TLightType { Point, Directional };
+
+class TLight {
+  public:
+    // point light intensity falls off with the squared distance
+    static TLight point(const TPoint& position, const TColor& intensity);
+    // light coming from infinitely far along direction, like the sun
+    static TLight directional(const TVector& direction, const TColor& intensity);
+
+    TLightType getType() const;
+    const TColor& getIntensity() const;
+
+    // shadow ray from point to the light: its direction is not normalized and the light is reached at T == tMax,
+    // so a segment query over [0, tMax] tells whether the point is in shadow
+    std::pair<TVector, double> shadowRay(const TPoint& point) const;
+    // intensity reaching the point when it is not in shadow
+    TColor intensityAt(const TPoint& point) const;
+
+  private:
+    TLightType Type_ = TLightType::Point;
+    TPoint Position_;
+    // direction the light travels, unit
+    TVector Direction_;
+    TColor Intensity_;
+};
+
+} // namespace NRayTracingLib
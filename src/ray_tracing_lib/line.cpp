@@ -27,6 +27,9 @@ TSafeDouble TLine::distToPoint(const TPoint& point) const {
 }
 bool TLine::containsPoint(const TPoint& point) const { return distToPoint(point) == 0.0; }
 
+TSafeDouble TLine::minParameter() const { return -INF; }
+TPoint TLine::pointAt(TSafeDouble t) const { return Point + Vector * t; }
+
 bool TLine::operator==(const TLine& other) const {
     return Vector.isParallel(other.Vector) && containsPoint(other.Point);
 }
@@ -62,15 +65,18 @@ std::optional<TPoint> TLine::intersection(const TLine& other) const {
     return result;
 }
 std::optional<TPoint> TLine::intersection(const TPlane& plane) const {
-    if (plane.Normal.isPerpendicular(Vector)) {
-        if (plane.containsLine(*this)) {
-            throw std::runtime_error("Error: itersection of plane and line in it");
-        } else {
-            return std::nullopt;
-        }
+    const std::optional<TSafeDouble> t = parameter(plane);
+    if (t == std::nullopt) {
+        return std::nullopt;
     }
-
-    return Point + Vector * (((plane.Point - Point) * plane.Normal) / (Vector * plane.Normal));
+    return pointAt(t.value());
+}
+std::optional<TSafeDouble> TLine::parameter(const TPlane& plane) const {
+    const std::optional<TSafeDouble> t = plane.parameter(Point, Vector);
+    if (t == std::nullopt && plane.containsLine(*this)) {
+        throw TLineInPlaneError();
+    }
+    return t;
 }
 
 std::ostream& operator<<(std::ostream& os, const TLine& line) { return os << "line:\n" << line.Point << line.Vector; }
@@ -88,13 +94,14 @@ TSafeDouble TRay::distToPoint(const TPoint& point) const {
     }
     return Point.distToPoint(point);
 }
+TSafeDouble TRay::minParameter() const { return 0.0; }
 
 std::optional<TPoint> TRay::intersection(const TPlane& plane) const {
-    std::optional<TPoint> lineIntersection = TLine::intersection(plane);
-    if (lineIntersection == std::nullopt || !containsPoint(lineIntersection.value())) {
+    const std::optional<TSafeDouble> t = parameter(plane);
+    if (t == std::nullopt || t.value() < minParameter()) {
         return std::nullopt;
     }
-    return lineIntersection;
+    return pointAt(t.value());
 }
 
 std::ostream& operator<<(std::ostream& os, const TRay& ray) { return os << "ray:\n" << ray.Point << ray.Vector; }
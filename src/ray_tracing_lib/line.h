@@ -23,11 +23,16 @@ class TLine {
     virtual TSafeDouble distToPoint(const TPoint& point) const;
     bool containsPoint(const TPoint& point) const;
 
+    // smallest parameter T of the line points Point + Vector * T
+    virtual TSafeDouble minParameter() const;
+    TPoint pointAt(TSafeDouble t) const;
+
     bool operator==(const TLine& other) const;
     bool operator!=(const TLine& other) const;
 
     std::optional<TPoint> intersection(const TLine& other) const;
     virtual std::optional<TPoint> intersection(const TPlane& plane) const;
+    std::optional<TSafeDouble> parameter(const TPlane& plane) const;
 
     friend std::ostream& operator<<(std::ostream& os, const TLine& line);
 };
@@ -39,10 +44,15 @@ class TRay : public TLine {
     explicit TRay(const TPoint& point, const TVector& vector);
 
     TSafeDouble distToPoint(const TPoint& point) const override;
+    TSafeDouble minParameter() const override;
 
     std::optional<TPoint> intersection(const TPlane& plane) const override;
 
     friend std::ostream& operator<<(std::ostream& os, const TRay& ray);
 };
 
+inline size_t raysCount(std::span<const TRay> rays) { return rays.size(); }
+inline const TPoint& rayOrigin(std::span<const TRay> rays, size_t i) { return rays[i].Point; }
+inline const TVector& rayDirection(std::span<const TRay> rays, size_t i) { return rays[i].Vector; }
+
 } // namespace NRayTracingLib
\ No newline at end of file
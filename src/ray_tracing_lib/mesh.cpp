@@ -0,0 +1,146 @@
+#include "mesh.h"
+#include "line.h"
+#include "parallel.h"
+
+namespace NRayTracingLib {
+
+static std::vector<TBoundingBox> polygonBoxes(const std::vector<TPolygon>& polygons) {
+    std::vector<TBoundingBox> boxes;
+    boxes.reserve(polygons.size());
+    for (const auto& polygon : polygons) {
+        boxes.push_back(polygon.bounds().Box);
+    }
+    return boxes;
+}
+
+TMesh::TMesh(const std::vector<TPolygon>& polygons, size_t threadsCount, TBvhLayout layout)
+    : Polygons_(polygons), Boxes_(polygonBoxes(polygons)), Bvh_(Boxes_, threadsCount), Layout_(layout) {
+    if (Polygons_.empty()) {
+        throw std::runtime_error("Error: creating mesh without polygons");
+    }
+    VertexOffsets_.reserve(Polygons_.size() + 1);
+    VertexOffsets_.push_back(0);
+    for (const TPolygon& polygon : Polygons_) {
+        VertexOffsets_.push_back(VertexOffsets_.back() + polygon.getPoints().size());
+    }
+    if (Layout_ == TBvhLayout::CompressedWide) {
+        WideBvh_ = TWideBvh{Bvh_};
+    }
+}
+
+const std::vector<TPolygon>& TMesh::getPolygons() const { return Polygons_; }
+const TBvh& TMesh::getBvh() const { return Bvh_; }
+const TWideBvh& TMesh::getWideBvh() const { return WideBvh_; }
+TBvhLayout TMesh::getLayout() const { return Layout_; }
+
+std::vector<TPoint> TMesh::getVertices() const {
+    std::vector<TPoint> vertices;
+    vertices.reserve(VertexOffsets_.back());
+    for (const TPolygon& polygon : Polygons_) {
+        vertices.insert(vertices.end(), polygon.getPoints().begin(), polygon.getPoints().end());
+    }
+    return vertices;
+}
+
+bool TMesh::update(const std::vector<TPoint>& vertices) {
+    if (vertices.size() != VertexOffsets_.back()) {
+        throw std::runtime_error("Error: updating mesh with different vertices count");
+    }
+    std::exception_ptr error;
+    try {
+        forChunks(0, static_cast<uint32_t>(Polygons_.size()), threadPool().getThreadsCount(),
+                  [&](uint32_t chunkBegin, uint32_t chunkEnd, size_t) {
+                      for (uint32_t i = chunkBegin; i < chunkEnd; i++) {
+                          Polygons_[i].movePoints(std::span<const TPoint>{vertices}.subspan(
+                              VertexOffsets_[i], VertexOffsets_[i + 1] - VertexOffsets_[i]));
+                          Boxes_[i] = Polygons_[i].bounds().Box;
+                      }
+                  });
+    } catch (...) {
+        error = std::current_exception();
+    }
+    const bool rebuilt = Bvh_.update(Boxes_);
+    // quantized boxes are relative to their parents, so the wide tree is collapsed again instead of refitted
+    if (Layout_ == TBvhLayout::CompressedWide) {
+        WideBvh_ = TWideBvh{Bvh_};
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return rebuilt;
+}
+
+TBounds TMesh::bounds() const { return TBounds{Bvh_.bounds()}; }
+
+std::optional<THit> TMesh::hit(const TLine& line, TSafeDouble tMin, TSafeDouble tMax) const {
+    if (Layout_ == TBvhLayout::CompressedWide) {
+        return hitNearest(WideBvh_, line, tMin, tMax);
+    }
+    return hitNearest(Bvh_, line, tMin, tMax);
+}
+std::optional<THit> TMesh::anyHit(const TLine& line, TSafeDouble tMin, TSafeDouble tMax) const {
+    if (Layout_ == TBvhLayout::CompressedWide) {
+        return hitAny(WideBvh_, line, tMin, tMax);
+    }
+    return hitAny(Bvh_, line, tMin, tMax);
+}
+
+void TMesh::occluded(std::span<const TRay> rays, std::span<const double> tMaxs, std::span<uint8_t> occluded) const {
+    checkBatchSizes(rays.size(), tMaxs.size());
+    checkBatchSizes(rays.size(), occluded.size());
+    std::array<TBvhRay, BVH_PACKET_SIZE> packet;
+    for (size_t first = 0; first < rays.size(); first += BVH_PACKET_SIZE) {
+        const size_t count = std::min(BVH_PACKET_SIZE, rays.size() - first);
+        for (size_t i = 0; i < count; i++) {
+            packet[i] = TBvhRay{rays[first + i].Point, rays[first + i].Vector};
+        }
+        Bvh_.traversePacket(std::span<const TBvhRay>{packet.data(), count}, tMaxs.subspan(first, count),
+                            occluded.subspan(first, count), [&](uint32_t polygonIdx, size_t ray) {
+                                const TRay& shadowRay = rays[first + ray];
+                                return Polygons_[polygonIdx]
+                                    .rayHitWithoutEdge(shadowRay.Point, shadowRay.Vector, 0.0, tMaxs[first + ray])
+                                    .has_value();
+                            });
+    }
+}
+
+template <typename TTree>
+std::optional<THit> TMesh::hitNearest(const TTree& tree, const TLine& line, TSafeDouble tMin,
+                                      TSafeDouble tMax) const {
+    std::optional<THit> nearest;
+    tree.traverse(line.Point, line.Vector, tMin.Value, tMax.Value,
+                  [&](uint32_t polygonIdx, double& currentMin, double& currentMax) {
+                      std::optional<THit> polygonHit =
+                          Polygons_[polygonIdx].rayHitWithoutEdge(line.Point, line.Vector, currentMin, currentMax);
+                      if (polygonHit == std::nullopt) {
+                          return;
+                      }
+                      // the nearest hit of a line is the one closest to its point on either side
+                      const double distance = polygonHit.value().T.abs().Value;
+                      currentMin = std::max(currentMin, -distance);
+                      currentMax = std::min(currentMax, distance);
+                      nearest = polygonHit;
+                      nearest.value().FaceIndex = polygonIdx;
+                  });
+    if (nearest != std::nullopt) {
+        Polygons_[nearest.value().FaceIndex].fillEdgeData(nearest.value());
+    }
+    return nearest;
+}
+
+template <typename TTree>
+std::optional<THit> TMesh::hitAny(const TTree& tree, const TLine& line, TSafeDouble tMin, TSafeDouble tMax) const {
+    std::optional<THit> found;
+    tree.traverse(line.Point, line.Vector, tMin.Value, tMax.Value,
+                  [&](uint32_t polygonIdx, double& currentMin, double& currentMax) {
+                      found = Polygons_[polygonIdx].rayHit(line.Point, line.Vector, currentMin, currentMax);
+                      if (found == std::nullopt) {
+                          return false;
+                      }
+                      found.value().FaceIndex = polygonIdx;
+                      return true;
+                  });
+    return found;
+}
+
+} // namespace NRayTracingLib
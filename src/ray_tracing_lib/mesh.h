@@ -0,0 +1,61 @@
+#pragma once
+
+#include "bvh.h"
+#include "common.h"
+#include "figure.h"
+#include "parallel.h"
+#include "polygon.h"
+#include "wide_bvh.h"
+
+namespace NRayTracingLib {
+
+enum class TBvhLayout {
+    Binary,
+    // TWideBvh collapsed from the binary tree, which is kept for refitting
+    CompressedWide,
+};
+
+// polygon soup with a BVH over the polygon boxes, for scenes too large to test polygon by polygon
+class TMesh : public TFigure {
+  public:
+    explicit TMesh(const std::vector<TPolygon>& polygons, size_t threadsCount = threadPool().getThreadsCount(),
+                   TBvhLayout layout = TBvhLayout::CompressedWide);
+
+    const std::vector<TPolygon>& getPolygons() const;
+    const TBvh& getBvh() const;
+    const TWideBvh& getWideBvh() const;
+    TBvhLayout getLayout() const;
+
+    // points of every polygon one after another, in the polygons order and the points order of each polygon
+    std::vector<TPoint> getVertices() const;
+    // moves the vertices in place, laid out as getVertices gives them, for animated or deforming geometry; the
+    // polygons and their boxes are updated in parallel, the BVH is refitted bottom-up and rebuilt only when it got
+    // too loose, returns whether it was rebuilt. Throws if a polygon does not stay flat and convex, the polygons
+    // moved until then stay moved and the BVH still fits them
+    bool update(const std::vector<TPoint>& vertices);
+
+    TBounds bounds() const final;
+
+    // FaceIndex of the hit is the polygon index
+    std::optional<THit> hit(const TLine& line, TSafeDouble tMin, TSafeDouble tMax) const final;
+    std::optional<THit> anyHit(const TLine& line, TSafeDouble tMin, TSafeDouble tMax) const final;
+    // rays are traced through the binary tree in packets of BVH_PACKET_SIZE consecutive rays,
+    // so coherent neighbours should go next to each other, see coherentOrder
+    void occluded(std::span<const TRay> rays, std::span<const double> tMaxs, std::span<uint8_t> occluded) const final;
+
+  private:
+    std::vector<TPolygon> Polygons_;
+    // index of the first vertex of every polygon in the update layout, and the vertices count at the end
+    std::vector<size_t> VertexOffsets_;
+    std::vector<TBoundingBox> Boxes_;
+    TBvh Bvh_;
+    TWideBvh WideBvh_;
+    TBvhLayout Layout_;
+
+    template <typename TTree>
+    std::optional<THit> hitNearest(const TTree& tree, const TLine& line, TSafeDouble tMin, TSafeDouble tMax) const;
+    template <typename TTree>
+    std::optional<THit> hitAny(const TTree& tree, const TLine& line, TSafeDouble tMin, TSafeDouble tMax) const;
+};
+
+} // namespace NRayTracingLib
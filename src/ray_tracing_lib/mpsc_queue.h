@@ -0,0 +1,79 @@
+#pragma once
+
+#include "common.h"
+
+#include <atomic>
+#include <memory>
+
+namespace NRayTracingLib {
+
+// bounded lock-free queue with many producers and one consumer over a ring of cells: each cell has a sequence
+// number telling whether it waits for a value of the current lap or for the consumer to take one, so producers only
+// race for the tail index and never wait for each other
+template <typename T>
+class TMpscQueue {
+  public:
+    // the capacity is rounded up to a power of two
+    explicit TMpscQueue(size_t capacity) {
+        size_t size = 1;
+        while (size < std::max<size_t>(capacity, 2)) {
+            size *= 2;
+        }
+        Cells_ = std::make_unique<TCell[]>(size);
+        Mask_ = size - 1;
+        for (size_t i = 0; i < size; i++) {
+            Cells_[i].Sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    size_t capacity() const { return Mask_ + 1; }
+
+    // may be called by any thread, false when the queue is full
+    bool push(const T& value) {
+        size_t position = Tail_.load(std::memory_order_relaxed);
+        while (true) {
+            TCell& cell = Cells_[position & Mask_];
+            const size_t sequence = cell.Sequence.load(std::memory_order_acquire);
+            const auto lag = static_cast<std::ptrdiff_t>(sequence - position);
+            if (lag == 0) {
+                if (Tail_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    cell.Value = value;
+                    cell.Sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (lag < 0) {
+                // the cell still holds the value of the previous lap
+                return false;
+            } else {
+                position = Tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // must be called by one thread at a time, no value when the queue is empty
+    std::optional<T> pop() {
+        TCell& cell = Cells_[Head_ & Mask_];
+        if (cell.Sequence.load(std::memory_order_acquire) != Head_ + 1) {
+            return std::nullopt;
+        }
+        T value = cell.Value;
+        cell.Sequence.store(Head_ + Mask_ + 1, std::memory_order_release);
+        Head_++;
+        return value;
+    }
+
+  private:
+    class TCell {
+      public:
+        std::atomic<size_t> Sequence;
+        T Value;
+    };
+
+    std::unique_ptr<TCell[]> Cells_;
+    size_t Mask_ = 0;
+    // producers and the consumer work on different cache lines
+    alignas(64) std::atomic<size_t> Tail_ = 0;
+    alignas(64) size_t Head_ = 0;
+};
+
+} // namespace NRayTracingLib
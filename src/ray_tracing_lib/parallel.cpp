@@ -0,0 +1,276 @@
+#include "parallel.h"
+
+#include <filesystem>
+#include <fstream>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace NRayTracingLib {
+
+// pool the current thread works for and its index there
+static thread_local const TThreadPool* CURRENT_POOL = nullptr;
+static thread_local size_t CURRENT_THREAD = 0;
+
+std::vector<size_t> parseCpuList(const std::string& list) {
+    std::vector<size_t> cpus;
+    size_t position = 0;
+    while (position < list.size()) {
+        const size_t end = std::min(list.find(',', position), list.size());
+        const std::string range = list.substr(position, end - position);
+        position = end + 1;
+        if (range.find_first_not_of(" \n") == std::string::npos) {
+            continue;
+        }
+        const size_t dash = range.find('-');
+        try {
+            const size_t first = std::stoul(range.substr(0, dash));
+            const size_t last = dash == std::string::npos ? first : std::stoul(range.substr(dash + 1));
+            for (size_t cpu = first; cpu <= last; cpu++) {
+                cpus.push_back(cpu);
+            }
+        } catch (const std::logic_error&) {
+            throw std::runtime_error("Error: wrong cpu list " + list);
+        }
+    }
+    return cpus;
+}
+
+std::vector<TNumaNode> readNumaNodes(const std::string& nodesPath) {
+    std::vector<TNumaNode> nodes;
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator{nodesPath, error}) {
+        const std::string name = entry.path().filename().string();
+        if (name.size() <= 4 || name.compare(0, 4, "node") != 0 ||
+            name.find_first_not_of("0123456789", 4) != std::string::npos) {
+            continue;
+        }
+        std::ifstream cpuList{entry.path() / "cpulist"};
+        std::string list;
+        if (!std::getline(cpuList, list)) {
+            continue;
+        }
+        nodes.push_back(TNumaNode{std::stoul(name.substr(4)), parseCpuList(list)});
+    }
+    std::sort(nodes.begin(), nodes.end(), [](const TNumaNode& a, const TNumaNode& b) { return a.Id < b.Id; });
+    return nodes;
+}
+
+static std::vector<size_t> allowedCpus() {
+    std::vector<size_t> cpus;
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (size_t cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &set)) {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+#endif
+    if (cpus.empty()) {
+        for (size_t cpu = 0; cpu < std::max(1u, std::thread::hardware_concurrency()); cpu++) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+std::vector<TNumaNode> allowedNumaNodes() {
+    const std::vector<size_t> allowed = allowedCpus();
+    std::vector<TNumaNode> nodes;
+    for (TNumaNode& node : readNumaNodes()) {
+        std::erase_if(node.Cpus, [&allowed](size_t cpu) {
+            return !std::binary_search(allowed.begin(), allowed.end(), cpu);
+        });
+        if (!node.Cpus.empty()) {
+            nodes.push_back(std::move(node));
+        }
+    }
+    if (nodes.empty()) {
+        nodes.push_back(TNumaNode{0, allowed});
+    }
+    return nodes;
+}
+
+static void pinToCpu(std::optional<size_t> cpu) {
+#ifdef __linux__
+    if (!cpu.has_value() || cpu.value() >= CPU_SETSIZE) {
+        return;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu.value(), &set);
+    // a worker the system does not let pin keeps running wherever it is scheduled
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#endif
+}
+
+TThreadPool::TThreadPool(size_t threadsCount, const std::vector<TNumaNode>& nodes)
+    : NodesCount_(std::clamp<size_t>(nodes.size(), 1, THREAD_POOL_MAX_NODES)) {
+    // processors node by node with their node blocks, workers take them in turn leaving the first one to the caller
+    std::vector<std::pair<size_t, size_t>> cpus;
+    for (size_t node = 0; node < nodes.size(); node++) {
+        for (const size_t cpu : nodes[node].Cpus) {
+            cpus.emplace_back(cpu, node % THREAD_POOL_MAX_NODES);
+            CpuNodes_.resize(std::max(CpuNodes_.size(), cpu + 1), 0);
+            CpuNodes_[cpu] = node % THREAD_POOL_MAX_NODES;
+        }
+    }
+    ThreadNodes_.assign(std::max<size_t>(threadsCount, 1), 0);
+    for (size_t thread = 1; thread < threadsCount; thread++) {
+        std::optional<size_t> cpu;
+        if (!cpus.empty()) {
+            cpu = cpus[thread % cpus.size()].first;
+            ThreadNodes_[thread] = cpus[thread % cpus.size()].second;
+        }
+        Workers_.emplace_back([this, thread, cpu]() {
+            CURRENT_POOL = this;
+            CURRENT_THREAD = thread;
+            pinToCpu(cpu);
+            work(thread);
+        });
+    }
+}
+
+TThreadPool::~TThreadPool() {
+    {
+        std::lock_guard lock{Mutex_};
+        Stopping_ = true;
+    }
+    WorkCondition_.notify_all();
+    for (auto& worker : Workers_) {
+        worker.join();
+    }
+}
+
+size_t TThreadPool::getThreadsCount() const { return Workers_.size() + 1; }
+size_t TThreadPool::getNodesCount() const { return NodesCount_; }
+size_t TThreadPool::currentThread() const { return CURRENT_POOL == this ? CURRENT_THREAD : 0; }
+
+size_t TThreadPool::callerNode() const {
+    if (CURRENT_POOL == this) {
+        return ThreadNodes_[CURRENT_THREAD];
+    }
+#ifdef __linux__
+    const int cpu = sched_getcpu();
+    if (cpu >= 0 && static_cast<size_t>(cpu) < CpuNodes_.size()) {
+        return CpuNodes_[cpu];
+    }
+#endif
+    return 0;
+}
+
+void TThreadPool::execute(TJob& job, size_t tasksCount) {
+    job.TasksCount = tasksCount;
+    for (size_t node = 0; node < NodesCount_; node++) {
+        job.Next[node] = nodeBlockBegin(tasksCount, NodesCount_, node);
+        job.Ends[node] = nodeBlockBegin(tasksCount, NodesCount_, node + 1);
+    }
+    {
+        std::lock_guard lock{Mutex_};
+        job.NextJob = Jobs_;
+        job.Listed = true;
+        Jobs_ = &job;
+    }
+    WorkCondition_.notify_all();
+    runTasks(job, callerNode());
+
+    std::unique_lock lock{Mutex_};
+    unlist(job);
+    DoneCondition_.wait(lock, [&job]() { return job.UsersCount == 0 && job.DoneCount == job.TasksCount; });
+    if (job.Error) {
+        std::rethrow_exception(job.Error);
+    }
+}
+
+void TThreadPool::post(std::function<void()> task) {
+    if (Workers_.empty()) {
+        task();
+        return;
+    }
+    {
+        std::lock_guard lock{Mutex_};
+        Tasks_.push_back(std::move(task));
+    }
+    WorkCondition_.notify_one();
+}
+
+void TThreadPool::work(size_t thread) {
+    std::unique_lock lock{Mutex_};
+    while (true) {
+        WorkCondition_.wait(lock, [this]() { return Stopping_ || Jobs_ != nullptr || !Tasks_.empty(); });
+        // tasks of the running jobs are taken before the posted tasks, they hold up the threads waiting for them
+        if (Jobs_ == nullptr) {
+            if (Tasks_.empty()) {
+                return;
+            }
+            std::function<void()> task = std::move(Tasks_.front());
+            Tasks_.pop_front();
+            lock.unlock();
+            task();
+            lock.lock();
+            continue;
+        }
+        TJob& job = *Jobs_;
+        job.UsersCount++;
+        lock.unlock();
+        runTasks(job, ThreadNodes_[thread]);
+        lock.lock();
+        job.UsersCount--;
+        unlist(job);
+        DoneCondition_.notify_all();
+    }
+}
+
+void TThreadPool::runTasks(TJob& job, size_t node) {
+    for (size_t i = 0; i < NodesCount_; i++) {
+        const size_t block = (node + i) % NodesCount_;
+        while (job.Next[block].load(std::memory_order_relaxed) < job.Ends[block]) {
+            const size_t task = job.Next[block].fetch_add(1);
+            if (task >= job.Ends[block]) {
+                break;
+            }
+            if (!job.Failed) {
+                try {
+                    job.Invoke(job.Func, task);
+                } catch (...) {
+                    std::lock_guard lock{Mutex_};
+                    if (!job.Failed.exchange(true)) {
+                        job.Error = std::current_exception();
+                    }
+                }
+            }
+            job.DoneCount++;
+        }
+    }
+}
+
+void TThreadPool::unlist(TJob& job) {
+    if (!job.Listed) {
+        return;
+    }
+    TJob** link = &Jobs_;
+    while (*link != &job) {
+        link = &(*link)->NextJob;
+    }
+    *link = job.NextJob;
+    job.Listed = false;
+}
+
+TThreadPool& threadPool() {
+    static TThreadPool pool = []() {
+        const std::vector<TNumaNode> nodes = allowedNumaNodes();
+        size_t cpusCount = 0;
+        for (const TNumaNode& node : nodes) {
+            cpusCount += node.Cpus.size();
+        }
+        return TThreadPool{cpusCount, nodes};
+    }();
+    return pool;
+}
+
+} // namespace NRayTracingLib
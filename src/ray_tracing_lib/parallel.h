@@ -0,0 +1,160 @@
+#pragma once
+
+#include "common.h"
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace NRayTracingLib {
+
+// tasks of a pool job are split into this many node blocks at most, further nodes share the blocks
+static constexpr size_t THREAD_POOL_MAX_NODES = 16;
+
+// processors of one NUMA node
+class TNumaNode {
+  public:
+    size_t Id = 0;
+    std::vector<size_t> Cpus;
+};
+
+// processors of a sysfs cpulist like "0-3,8,10-11"
+std::vector<size_t> parseCpuList(const std::string& list);
+// nodes listed by the nodeN directories of nodesPath, empty when there are none
+std::vector<TNumaNode> readNumaNodes(const std::string& nodesPath = "/sys/devices/system/node");
+// nodes of the machine with the processors the process may run on, a single node holding every allowed processor
+// when the machine tells nothing about its nodes
+std::vector<TNumaNode> allowedNumaNodes();
+
+// long-lived worker threads shared by the whole engine. Workers are pinned to the processors of the nodes, node
+// by node, and the tasks of a job are split into one contiguous block per node: the threads of a node take the
+// tasks of its block first and only then help the other nodes, so data first touched by the tasks of a block
+// is mostly processed on the node that touched it
+class TThreadPool {
+  public:
+    // threadsCount threads run the tasks, the thread calling run is one of them; without nodes workers are not pinned
+    explicit TThreadPool(size_t threadsCount, const std::vector<TNumaNode>& nodes = {});
+    ~TThreadPool();
+
+    TThreadPool(const TThreadPool&) = delete;
+    TThreadPool& operator=(const TThreadPool&) = delete;
+
+    size_t getThreadsCount() const;
+    size_t getNodesCount() const;
+    // index of the calling thread among the threads of the pool, 0 for the threads not belonging to it
+    size_t currentThread() const;
+
+    // runs func(task) for every task of [0, tasksCount) on the workers and the calling thread and returns when all
+    // of them are done; tasks may run jobs of their own. The first exception thrown by a task cancels the tasks
+    // not started yet and is rethrown here
+    template <typename TFunc>
+    void run(size_t tasksCount, const TFunc& func) {
+        if (Workers_.empty() || tasksCount <= 1) {
+            for (size_t task = 0; task < tasksCount; task++) {
+                func(task);
+            }
+            return;
+        }
+        TJob job;
+        job.Func = &func;
+        job.Invoke = [](const void* function, size_t task) { (*static_cast<const TFunc*>(function))(task); };
+        execute(job, tasksCount);
+    }
+
+    // runs the task on a worker in the posting order and returns without waiting for it, or runs it on the calling
+    // thread when there are no workers. Posted tasks may run jobs and must not throw; the tasks still waiting when
+    // the pool is destroyed are run before the workers stop
+    void post(std::function<void()> task);
+
+  private:
+    // job of a run call, it lives on the stack of the calling thread until all its tasks are done
+    class TJob {
+      public:
+        const void* Func = nullptr;
+        void (*Invoke)(const void* func, size_t task) = nullptr;
+        size_t TasksCount = 0;
+        // tasks [Next[node], Ends[node]) of each node block are not taken yet
+        std::array<std::atomic<size_t>, THREAD_POOL_MAX_NODES> Next;
+        std::array<size_t, THREAD_POOL_MAX_NODES> Ends{};
+        std::atomic<size_t> DoneCount = 0;
+        std::atomic<bool> Failed = false;
+        std::exception_ptr Error;
+        // workers inside the job, the job is not left before they leave it
+        size_t UsersCount = 0;
+        // jobs with tasks to take form a list, the newest first
+        TJob* NextJob = nullptr;
+        bool Listed = false;
+    };
+
+    std::vector<std::thread> Workers_;
+    size_t NodesCount_ = 1;
+    // node of every worker by thread index and node of every processor, for the threads not belonging to the pool
+    std::vector<size_t> ThreadNodes_;
+    std::vector<size_t> CpuNodes_;
+
+    std::mutex Mutex_;
+    std::condition_variable WorkCondition_;
+    std::condition_variable DoneCondition_;
+    TJob* Jobs_ = nullptr;
+    std::deque<std::function<void()>> Tasks_;
+    bool Stopping_ = false;
+
+    void execute(TJob& job, size_t tasksCount);
+    void work(size_t thread);
+    // runs the tasks of the job until none is left to take, the tasks of the node block first
+    void runTasks(TJob& job, size_t node);
+    void unlist(TJob& job);
+    size_t callerNode() const;
+};
+
+// allocator leaving default constructed elements uninitialized: pages of a buffer resized with it are first touched,
+// and so placed on a NUMA node, by the threads filling it rather than by the thread allocating it
+template <typename T>
+class TFirstTouchAllocator : public std::allocator<T> {
+  public:
+    template <typename U>
+    struct rebind {
+        using other = TFirstTouchAllocator<U>;
+    };
+
+    TFirstTouchAllocator() = default;
+    template <typename U>
+    TFirstTouchAllocator(const TFirstTouchAllocator<U>&) noexcept {}
+
+    template <typename U>
+    void construct(U* ptr) noexcept(std::is_nothrow_default_constructible_v<U>) {
+        ::new (static_cast<void*>(ptr)) U;
+    }
+    template <typename U, typename... TArgs>
+    void construct(U* ptr, TArgs&&... args) {
+        ::new (static_cast<void*>(ptr)) U(std::forward<TArgs>(args)...);
+    }
+};
+
+// first task of the node block of a job, the block ends where the block of the next node begins
+inline size_t nodeBlockBegin(size_t tasksCount, size_t nodesCount, size_t node) {
+    return node * tasksCount / nodesCount;
+}
+
+// engine-wide pool over the allowed processors created on first use, rendering, BVH builds and sorting share it
+TThreadPool& threadPool();
+
+// splits [begin, end) into chunksCount parts and runs func(chunkBegin, chunkEnd, chunk) for them on the thread pool;
+// the split depends only on the arguments, so calls over the same range give the same chunks
+template <typename TFunc>
+void forChunks(uint32_t begin, uint32_t end, size_t chunksCount, const TFunc& func) {
+    const uint32_t chunkSize = static_cast<uint32_t>((end - begin + chunksCount - 1) / chunksCount);
+    threadPool().run(chunksCount, [&](size_t chunk) {
+        const uint32_t chunkBegin = std::min(end, static_cast<uint32_t>(begin + chunk * chunkSize));
+        func(chunkBegin, std::min(end, chunkBegin + chunkSize), chunk);
+    });
+}
+
+} // namespace NRayTracingLib
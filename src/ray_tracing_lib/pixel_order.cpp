@@ -0,0 +1,70 @@
+#include "pixel_order.h"
+#include "parallel.h"
+
+#include <bit>
+
+namespace NRayTracingLib {
+
+// spreads the low 32 bits of value so that a zero bit follows every one of them
+static uint64_t spreadBits(uint64_t value) {
+    value &= 0xffffffff;
+    value = (value | (value << 16)) & 0x0000ffff0000ffff;
+    value = (value | (value << 8)) & 0x00ff00ff00ff00ff;
+    value = (value | (value << 4)) & 0x0f0f0f0f0f0f0f0f;
+    value = (value | (value << 2)) & 0x3333333333333333;
+    value = (value | (value << 1)) & 0x5555555555555555;
+    return value;
+}
+
+uint64_t mortonIndex(uint32_t x, uint32_t y) { return spreadBits(x) | spreadBits(y) << 1; }
+
+uint64_t hilbertIndex(uint32_t x, uint32_t y, size_t bits) {
+    uint64_t index = 0;
+    for (uint32_t half = bits == 0 ? 0 : 1u << (bits - 1); half > 0; half >>= 1) {
+        const uint32_t right = (x & half) > 0 ? 1 : 0;
+        const uint32_t up = (y & half) > 0 ? 1 : 0;
+        index += static_cast<uint64_t>(half) * half * ((3 * right) ^ up);
+        // the quadrant is rotated so that the curve inside it starts and ends next to its neighbours
+        if (up == 0) {
+            if (right == 1) {
+                x = half - 1 - (x & (half - 1));
+                y = half - 1 - (y & (half - 1));
+            }
+            std::swap(x, y);
+        }
+    }
+    return index;
+}
+
+std::vector<uint32_t> gridOrder(size_t width, size_t height, TPixelOrder order) {
+    std::vector<uint32_t> cells(width * height);
+    for (uint32_t i = 0; i < cells.size(); i++) {
+        cells[i] = i;
+    }
+    if (order == TPixelOrder::RowMajor || cells.empty()) {
+        return cells;
+    }
+    const size_t bits = std::bit_width(std::bit_ceil(std::max(width, height))) - 1;
+    std::vector<uint64_t> keys(cells.size());
+    for (uint32_t i = 0; i < cells.size(); i++) {
+        const uint32_t x = static_cast<uint32_t>(i % width);
+        const uint32_t y = static_cast<uint32_t>(i / width);
+        keys[i] = order == TPixelOrder::Morton ? mortonIndex(x, y) : hilbertIndex(x, y, bits);
+    }
+    std::sort(cells.begin(), cells.end(), [&keys](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+    return cells;
+}
+
+void costliestFirst(const std::vector<double>& costs, std::vector<uint32_t>& order, size_t blocksCount) {
+    order.resize(costs.size());
+    for (uint32_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    for (size_t block = 0; block < blocksCount; block++) {
+        std::sort(order.begin() + nodeBlockBegin(order.size(), blocksCount, block),
+                  order.begin() + nodeBlockBegin(order.size(), blocksCount, block + 1),
+                  [&costs](uint32_t a, uint32_t b) { return costs[a] > costs[b] || (costs[a] == costs[b] && a < b); });
+    }
+}
+
+} // namespace NRayTracingLib
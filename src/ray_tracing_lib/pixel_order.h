@@ -0,0 +1,33 @@
+#pragma once
+
+#include "common.h"
+
+namespace NRayTracingLib {
+
+// pixels of a picture are traced in tiles of TILE_SIZE x TILE_SIZE, one tile fills a ray packet
+static constexpr size_t TILE_SIZE = 8;
+
+enum class TPixelOrder {
+    // rows one after another, left to right
+    RowMajor,
+    // tiles along the Z-order curve, pixels inside a tile along the same curve
+    Morton,
+    // tiles along the Hilbert curve, whose neighbours are always adjacent, pixels inside a tile along it too
+    Hilbert,
+};
+
+// position of the cell (x, y) along the Morton curve, interleaving the bits of x and y
+uint64_t mortonIndex(uint32_t x, uint32_t y);
+// position of the cell (x, y) along the Hilbert curve over a 2^bits x 2^bits grid
+uint64_t hilbertIndex(uint32_t x, uint32_t y, size_t bits);
+
+// cells y * width + x of a width x height grid in the given order; curves go over the smallest power of two grid
+// covering it and skip the cells out of it
+std::vector<uint32_t> gridOrder(size_t width, size_t height, TPixelOrder order);
+
+// fills order with the indices of costs, the costliest first and equal costs by index, within each of the blocksCount
+// node blocks a pool job of costs.size() tasks is split into; it is sorted in place, so an order already of the size
+// of costs is not reallocated
+void costliestFirst(const std::vector<double>& costs, std::vector<uint32_t>& order, size_t blocksCount = 1);
+
+} // namespace NRayTracingLib
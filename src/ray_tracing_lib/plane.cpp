@@ -64,12 +64,35 @@ bool TPlane::isParallel(const TPlane& other) const { return Normal.isParallel(ot
 bool TPlane::isParallel(const TVector& vector) const { return Normal.isPerpendicular(vector); }
 bool TPlane::isPerpendicular(const TPlane& other) const { return Normal.isPerpendicular(other.Normal); }
 
-std::optional<std::pair<TPoint, TPointContainment>> TPlane::intersection(const TLine& line) const {
-    const std::optional<TPoint> intersection = line.intersection(*this);
-    if (intersection.has_value()) {
-        return std::make_pair(intersection.value(), TPointContainment::Inside);
+std::optional<TSafeDouble> TPlane::parameter(const TPoint& origin, const TVector& direction) const {
+    // same tolerance as Normal.isPerpendicular(direction), but without normalizing the direction
+    const double denominator = (direction * Normal).Value;
+    if (denominator * denominator <= ACCURACY * ACCURACY * (direction * direction).Value) {
+        return std::nullopt;
+    }
+    return ((Point - origin) * Normal).Value / denominator;
+}
+std::optional<THit> TPlane::rayHit(const TPoint& origin, const TVector& direction, TSafeDouble tMin,
+                                   TSafeDouble tMax) const {
+    const std::optional<TSafeDouble> t = parameter(origin, direction);
+    if (t == std::nullopt || t.value() < tMin || t.value() > tMax) {
+        return std::nullopt;
+    }
+
+    THit planeHit;
+    planeHit.T = t.value();
+    planeHit.Point = origin + direction * t.value();
+    planeHit.Normal = Normal;
+    planeHit.FaceIndex = 0;
+    return planeHit;
+}
+
+std::optional<THit> TPlane::hit(const TLine& line, TSafeDouble tMin, TSafeDouble tMax) const {
+    std::optional<THit> planeHit = rayHit(line.Point, line.Vector, tMin, tMax);
+    if (planeHit == std::nullopt && containsLine(line)) {
+        throw TLineInPlaneError();
     }
-    return std::nullopt;
+    return planeHit;
 }
 std::optional<TLine> TPlane::intersection(const TPlane& plane) const {
     if (Normal.isParallel(plane.Normal)) {
@@ -120,6 +143,27 @@ std::optional<TLine> TPlane::intersection(const TPlane& plane) const {
     return TLine{TPoint{x, y, z}, direction};
 }
 
+template <typename TRays>
+static void intersectPlane(const TPlane& plane, const TRays& rays, std::span<std::optional<THit>> hits) {
+    checkBatchSizes(raysCount(rays), hits.size());
+    for (size_t i = 0; i < hits.size(); i++) {
+        hits[i] = plane.rayHit(rayOrigin(rays, i), rayDirection(rays, i), 0.0, INF);
+    }
+}
+
+void TPlane::intersect(std::span<const TRay> rays, std::span<std::optional<THit>> hits) const {
+    intersectPlane(*this, rays, hits);
+}
+void TPlane::intersect(const TRayBatch& rays, std::span<std::optional<THit>> hits) const {
+    intersectPlane(*this, rays, hits);
+}
+void TPlane::intersectAny(std::span<const TRay> rays, std::span<std::optional<THit>> hits) const {
+    intersectPlane(*this, rays, hits);
+}
+void TPlane::intersectAny(const TRayBatch& rays, std::span<std::optional<THit>> hits) const {
+    intersectPlane(*this, rays, hits);
+}
+
 std::ostream& operator<<(std::ostream& os, const TPlane& plane) {
     return os << "plane:\n" << plane.Point << plane.Normal;
 }
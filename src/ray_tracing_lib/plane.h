@@ -33,9 +33,22 @@ class TPlane : public TFigure {
     bool isParallel(const TVector& vector) const;
     bool isPerpendicular(const TPlane& other) const;
 
-    std::optional<std::pair<TPoint, TPointContainment>> intersection(const TLine& line) const override;
+    using TFigure::intersection;
+
+    // parameter T of the point origin + direction * T lying in the plane, nullopt for directions parallel to it
+    std::optional<TSafeDouble> parameter(const TPoint& origin, const TVector& direction) const;
+    // hit of origin + direction * T, never throws: a line lying in the plane is a miss
+    std::optional<THit> rayHit(const TPoint& origin, const TVector& direction, TSafeDouble tMin,
+                               TSafeDouble tMax) const;
+
+    std::optional<THit> hit(const TLine& line, TSafeDouble tMin, TSafeDouble tMax) const final;
     std::optional<TLine> intersection(const TPlane& plane) const;
 
+    void intersect(std::span<const TRay> rays, std::span<std::optional<THit>> hits) const final;
+    void intersect(const TRayBatch& rays, std::span<std::optional<THit>> hits) const final;
+    void intersectAny(std::span<const TRay> rays, std::span<std::optional<THit>> hits) const final;
+    void intersectAny(const TRayBatch& rays, std::span<std::optional<THit>> hits) const final;
+
     friend std::ostream& operator<<(std::ostream& os, const TPlane& plane);
 };
 
@@ -145,6 +145,8 @@ TPolygon::TPolygon(const std::unordered_set<TPoint>& points) {
 
     checkConvexityAndType();
     // now all points make up a сonvexity polygon
+
+    Bounds_ = TBounds{Points_, ON_BORDER_THRESHOLD};
 }
 
 bool TPolygon::operator==(const TPolygon& other) const {
@@ -162,8 +164,10 @@ const TPlane& TPolygon::getPlane() const { return Plane_; }
 bool TPolygon::getEdgesIsEqual() const { return EdgesIsEqual_; }
 bool TPolygon::getAnglesIsEqual() const { return AnglesIsEqual_; }
 
+TBounds TPolygon::bounds() const { return Bounds_; }
+
 TPointContainment TPolygon::containsPoint(const TPoint& point) const {
-    const TSafeDouble onBorderTreshold = 5e-3;
+    const TSafeDouble onBorderTreshold = ON_BORDER_THRESHOLD;
 
     if (!Plane_.containsPoint(point)) {
         return TPointContainment::Outside;
@@ -204,17 +208,129 @@ TPointContainment TPolygon::containsPoint(const TPoint& point) const {
     return TPointContainment::Inside;
 }
 
-std::optional<std::pair<TPoint, TPointContainment>> TPolygon::intersection(const TLine& line) const {
-    const std::optional<std::pair<TPoint, TPointContainment>> planeIntersection = Plane_.intersection(line);
-    if (planeIntersection == std::nullopt) {
+void TPolygon::fillEdgeData(THit& polygonHit) const {
+    for (size_t i = 0; i < Points_.size(); i++) {
+        const size_t nextIdx = (i + 1) % Points_.size();
+        const TVector edge = Points_[nextIdx] - Points_[i];
+        const TSafeDouble distance = ((edge ^ (polygonHit.Point - Points_[i])) * Plane_.Normal).abs() / edge.length();
+        if (distance < polygonHit.EdgeDistance) {
+            polygonHit.EdgeIndex = i;
+            polygonHit.EdgeDistance = distance;
+        }
+    }
+    if (polygonHit.EdgeDistance < ON_BORDER_THRESHOLD) {
+        polygonHit.Containment = TPointContainment::OnBoundary;
+    }
+}
+
+void TPolygon::orientNormal(const TVector& outward) {
+    const TSafeDouble projection = Plane_.Normal * outward;
+    if (projection == 0.0) {
+        throw std::runtime_error("Error: orienting polygon normal by vector parallel to polygon");
+    }
+    if (projection < 0.0) {
+        Plane_.Normal = -Plane_.Normal;
+        std::reverse(Points_.begin(), Points_.end());
+    }
+}
+
+// normal of the turn at the second point, removeExtraPoints leaves no three consecutive points on a line
+static TVector windingNormal(const std::vector<TPoint>& points) {
+    return (points[1] - points[0]) ^ (points[2] - points[1]);
+}
+
+void TPolygon::movePoints(std::span<const TPoint> points) {
+    if (points.size() != Points_.size()) {
+        throw std::runtime_error("Error: moving polygon points with different points count");
+    }
+    const bool alongWinding = Plane_.Normal * windingNormal(Points_) > 0.0;
+    // the polygon is left as it was if the moved points do not make one
+    TPolygon moved = *this;
+    std::copy(points.begin(), points.end(), moved.Points_.begin());
+    const TVector winding = windingNormal(moved.Points_);
+    if (winding.isZero()) {
+        throw std::runtime_error("Error: moving polygon points onto a line");
+    }
+    moved.Plane_ = TPlane{moved.Points_[0], alongWinding ? winding : -winding};
+    moved.checkComplanarity();
+    // the points keep their order, so every turn must go the way of the first one
+    for (size_t i = 0; i < moved.Points_.size(); i++) {
+        const size_t prevIdx = (i == 0) ? (moved.Points_.size() - 1) : (i - 1);
+        const size_t nextIdx = (i + 1) % moved.Points_.size();
+        const TVector turn = (moved.Points_[i] - moved.Points_[prevIdx]) ^ (moved.Points_[nextIdx] - moved.Points_[i]);
+        if (turn * winding <= 0.0) {
+            throw std::runtime_error("Error: moving polygon points to a not convex polygon");
+        }
+    }
+    moved.EdgesIsEqual_ = true;
+    moved.AnglesIsEqual_ = true;
+    moved.checkConvexityAndType();
+    moved.Bounds_ = TBounds{moved.Points_, ON_BORDER_THRESHOLD};
+    *this = std::move(moved);
+}
+
+std::optional<THit> TPolygon::completePlaneHit(std::optional<THit> planeHit) const {
+    if (planeHit == std::nullopt) {
         return std::nullopt;
     }
-    const TPointContainment pointContainment = containsPoint(planeIntersection.value().first);
-    if (pointContainment == TPointContainment::Outside) {
+    planeHit.value().Containment = containsPoint(planeHit.value().Point);
+    if (planeHit.value().Containment == TPointContainment::Outside) {
         return std::nullopt;
-    } else {
-        return std::make_pair(planeIntersection.value().first, pointContainment);
     }
+    return planeHit;
+}
+
+std::optional<THit> TPolygon::rayHitWithoutEdge(const TPoint& origin, const TVector& direction, TSafeDouble tMin,
+                                                TSafeDouble tMax) const {
+    if (!Bounds_.Sphere.intersects(origin, direction, tMin, tMax)) {
+        return std::nullopt;
+    }
+    return completePlaneHit(Plane_.rayHit(origin, direction, tMin, tMax));
+}
+
+std::optional<THit> TPolygon::hitWithoutEdge(const TLine& line, TSafeDouble tMin, TSafeDouble tMax) const {
+    if (!Bounds_.Sphere.intersects(line.Point, line.Vector, tMin, tMax)) {
+        return std::nullopt;
+    }
+    return completePlaneHit(Plane_.hit(line, tMin, tMax));
+}
+
+std::optional<THit> TPolygon::rayHit(const TPoint& origin, const TVector& direction, TSafeDouble tMin,
+                                     TSafeDouble tMax) const {
+    std::optional<THit> polygonHit = rayHitWithoutEdge(origin, direction, tMin, tMax);
+    if (polygonHit != std::nullopt) {
+        fillEdgeData(polygonHit.value());
+    }
+    return polygonHit;
+}
+
+std::optional<THit> TPolygon::hit(const TLine& line, TSafeDouble tMin, TSafeDouble tMax) const {
+    std::optional<THit> polygonHit = hitWithoutEdge(line, tMin, tMax);
+    if (polygonHit != std::nullopt) {
+        fillEdgeData(polygonHit.value());
+    }
+    return polygonHit;
+}
+
+template <typename TRays>
+void TPolygon::intersectBatch(const TRays& rays, std::span<std::optional<THit>> hits) const {
+    checkBatchSizes(raysCount(rays), hits.size());
+    for (size_t i = 0; i < hits.size(); i++) {
+        hits[i] = rayHit(rayOrigin(rays, i), rayDirection(rays, i), 0.0, INF);
+    }
+}
+
+void TPolygon::intersect(std::span<const TRay> rays, std::span<std::optional<THit>> hits) const {
+    intersectBatch(rays, hits);
+}
+void TPolygon::intersect(const TRayBatch& rays, std::span<std::optional<THit>> hits) const {
+    intersectBatch(rays, hits);
+}
+void TPolygon::intersectAny(std::span<const TRay> rays, std::span<std::optional<THit>> hits) const {
+    intersectBatch(rays, hits);
+}
+void TPolygon::intersectAny(const TRayBatch& rays, std::span<std::optional<THit>> hits) const {
+    intersectBatch(rays, hits);
 }
 
 std::ostream& operator<<(std::ostream& os, const TPolygon& polygon) {
@@ -7,6 +7,9 @@
 
 namespace NRayTracingLib {
 
+// points closer than this to the polygon border are classified as lying on it
+static constexpr double ON_BORDER_THRESHOLD = 5e-3;
+
 class TPolygon : public TFigure {
   public:
     explicit TPolygon(const std::unordered_set<TPoint>& points);
@@ -20,7 +23,32 @@ class TPolygon : public TFigure {
 
     TPointContainment containsPoint(const TPoint& point) const;
 
-    std::optional<std::pair<TPoint, TPointContainment>> intersection(const TLine& line) const override;
+    TBounds bounds() const final;
+
+    // sets hit edge data by the nearest polygon edge, hits near the border become OnBoundary
+    void fillEdgeData(THit& polygonHit) const;
+
+    // flips the plane normal (and the points order with it) if it looks against the outward direction
+    void orientNormal(const TVector& outward);
+    // moves the points keeping their order, for deforming meshes: the plane, the bounds and the shape flags follow
+    // them and the normal keeps its side. Throws and keeps the old points if the moved ones are not flat and convex
+    void movePoints(std::span<const TPoint> points);
+
+    // hit of origin + direction * T, never throws: a line lying in the polygon plane is a miss
+    std::optional<THit> rayHit(const TPoint& origin, const TVector& direction, TSafeDouble tMin,
+                               TSafeDouble tMax) const;
+
+    std::optional<THit> hit(const TLine& line, TSafeDouble tMin, TSafeDouble tMax) const final;
+
+    // hits without the edge data, for nearest hit searches filling it by fillEdgeData for the final hit only
+    std::optional<THit> rayHitWithoutEdge(const TPoint& origin, const TVector& direction, TSafeDouble tMin,
+                                          TSafeDouble tMax) const;
+    std::optional<THit> hitWithoutEdge(const TLine& line, TSafeDouble tMin, TSafeDouble tMax) const;
+
+    void intersect(std::span<const TRay> rays, std::span<std::optional<THit>> hits) const final;
+    void intersect(const TRayBatch& rays, std::span<std::optional<THit>> hits) const final;
+    void intersectAny(std::span<const TRay> rays, std::span<std::optional<THit>> hits) const final;
+    void intersectAny(const TRayBatch& rays, std::span<std::optional<THit>> hits) const final;
 
     friend std::ostream& operator<<(std::ostream& os, const TPolygon& polygon);
 
@@ -29,6 +57,7 @@ class TPolygon : public TFigure {
     TPlane Plane_;
     bool EdgesIsEqual_ = true;
     bool AnglesIsEqual_ = true;
+    TBounds Bounds_;
 
     void primalInit(const std::unordered_set<TPoint>& points);
     void findAnyPlane();
@@ -36,6 +65,10 @@ class TPolygon : public TFigure {
     void sortByPolarAngle();
     void removeExtraPoints();
     void checkConvexityAndType();
+    std::optional<THit> completePlaneHit(std::optional<THit> planeHit) const;
+
+    template <typename TRays>
+    void intersectBatch(const TRays& rays, std::span<std::optional<THit>> hits) const;
 };
 
 } // namespace NRayTracingLib
@@ -2,7 +2,7 @@
 
 namespace NRayTracingLib {
 
-TPolyhedron::TPolyhedron(const std::unordered_set<TPolygon>& polygons) : Faces_(polygons) {
+TPolyhedron::TPolyhedron(const std::unordered_set<TPolygon>& polygons) : Faces_(polygons.begin(), polygons.end()) {
     std::unordered_map<TEdge, uint8_t> edgesCount;
 
     for (const auto& face : Faces_) {
@@ -18,33 +18,262 @@ TPolyhedron::TPolyhedron(const std::unordered_set<TPolygon>& polygons) : Faces_(
             throw std::runtime_error("Error: creating not closed polyhedron");
         }
     }
-}
 
-const std::unordered_set<TPolygon>& TPolyhedron::getFaces() const { return Faces_; }
+    orientFacesOutward();
+    // now all face normals look outward if polyhedron is convex
 
-std::optional<std::pair<TPoint, TPointContainment>> TPolyhedron::intersection(const TLine& line) const {
-    // closest to line.Point intersection point
+    checkConvexity();
 
-    std::vector<std::tuple<TPoint, TPointContainment, double>> intersectionsWithDistances;
+    std::vector<TPoint> points;
+    for (const auto& face : Faces_) {
+        points.insert(points.end(), face.getPoints().begin(), face.getPoints().end());
+    }
+    Bounds_ = TBounds{points, ON_BORDER_THRESHOLD};
+}
 
+void TPolyhedron::orientFacesOutward() {
+    // here we use what polyhedron is convex, so the vertices center lies inside it
+    TVector centerVector{0.0, 0.0, 0.0};
+    size_t pointsCount = 0;
     for (const auto& face : Faces_) {
-        std::optional<std::pair<TPoint, TPointContainment>> intersection = face.intersection(line);
-        if (intersection != std::nullopt) {
-            intersectionsWithDistances.push_back({
-                intersection.value().first,
-                intersection.value().second,
-                line.Point.distToPoint(intersection.value().first).Value,
-            });
+        for (const auto& point : face.getPoints()) {
+            centerVector += TVector{point};
+            pointsCount++;
+        }
+    }
+    const TPoint center{centerVector / static_cast<double>(pointsCount)};
+
+    for (auto& face : Faces_) {
+        face.orientNormal(face.getPlane().Point - center);
+    }
+}
+
+void TPolyhedron::checkConvexity() {
+    for (const auto& face : Faces_) {
+        for (const auto& otherFace : Faces_) {
+            for (const auto& point : otherFace.getPoints()) {
+                if ((point - face.getPlane().Point) * face.getPlane().Normal > 0.0) {
+                    IsConvex_ = false;
+                    return;
+                }
+            }
+        }
+    }
+}
+
+const std::vector<TPolygon>& TPolyhedron::getFaces() const { return Faces_; }
+bool TPolyhedron::getIsConvex() const { return IsConvex_; }
+
+TBounds TPolyhedron::bounds() const { return Bounds_; }
+
+void TPolyhedron::setBackFaceCulling(bool enabled) { BackFaceCulling_ = enabled; }
+bool TPolyhedron::getBackFaceCulling() const { return BackFaceCulling_; }
+
+bool TPolyhedron::isCulled(const TPolygon& face, const TVector& direction) const {
+    return BackFaceCulling_ && (direction * face.getPlane().Normal) >= 0.0;
+}
+
+std::optional<THit> TPolyhedron::faceHit(size_t faceIdx, const TPoint& origin, const TVector& direction,
+                                         TSafeDouble t) const {
+    THit polyhedronHit;
+    polyhedronHit.T = t;
+    polyhedronHit.Point = origin + direction * t;
+    polyhedronHit.Normal = Faces_[faceIdx].getPlane().Normal;
+    polyhedronHit.FaceIndex = faceIdx;
+    Faces_[faceIdx].fillEdgeData(polyhedronHit);
+    return polyhedronHit;
+}
+
+std::optional<THit> TPolyhedron::clipConvex(const TPoint& origin, const TVector& direction, TSafeDouble tMin,
+                                            TSafeDouble tMax, bool throwOnLineInFace) const {
+    // convex polyhedron is the intersection of its faces inner half-spaces, so the line is inside it
+    // between the latest entering into a half-space and the earliest exiting from one:
+    // one dot product per face and no point in polygon tests
+
+    double tEnter = -INF;
+    double tExit = INF;
+    size_t enterFace = NO_INDEX;
+    size_t exitFace = NO_INDEX;
+
+    const double directionSquare = (direction * direction).Value;
+
+    for (size_t i = 0; i < Faces_.size(); i++) {
+        const TPlane& plane = Faces_[i].getPlane();
+        const double denominator = (direction * plane.Normal).Value;
+        const double distance = ((origin - plane.Point) * plane.Normal).Value;
+
+        if (denominator * denominator <= ACCURACY * ACCURACY * directionSquare) {
+            if (distance > ACCURACY) {
+                return std::nullopt;
+            }
+            if (distance >= -ACCURACY && throwOnLineInFace) {
+                throw TLineInPlaneError();
+            }
+            continue;
+        }
+
+        const double t = -distance / denominator;
+        if (denominator < 0.0) {
+            if (t > tEnter) {
+                tEnter = t;
+                enterFace = i;
+            }
+        } else if (t < tExit) {
+            tExit = t;
+            exitFace = i;
+        }
+
+        if (TSafeDouble{tEnter} > tExit) {
+            return std::nullopt;
         }
     }
 
-    sort(intersectionsWithDistances.begin(), intersectionsWithDistances.end(),
-         [&line](const auto& lhs, const auto& rhs) { return std::get<2>(lhs) < std::get<2>(rhs); });
+    const bool enterFits = enterFace != NO_INDEX && tMin <= tEnter && tMax >= tEnter;
+    const bool exitFits = !BackFaceCulling_ && exitFace != NO_INDEX && tMin <= tExit && tMax >= tExit;
+
+    if (enterFits && (!exitFits || std::abs(tEnter) <= std::abs(tExit))) {
+        return faceHit(enterFace, origin, direction, tEnter);
+    }
+    if (exitFits) {
+        return faceHit(exitFace, origin, direction, tExit);
+    }
+    return std::nullopt;
+}
+
+std::optional<THit> TPolyhedron::hit(const TLine& line, TSafeDouble tMin, TSafeDouble tMax) const {
+    if (!Bounds_.Sphere.intersects(line.Point, line.Vector, tMin, tMax)) {
+        return std::nullopt;
+    }
+    if (IsConvex_) {
+        return clipConvex(line.Point, line.Vector, tMin, tMax, true);
+    }
+
+    // closest to line.Point hit: every found hit narrows the interval to [-|T|, |T|],
+    // so farther faces are rejected by the interval check alone
+
+    std::optional<THit> nearest;
+
+    for (size_t i = 0; i < Faces_.size(); i++) {
+        if (isCulled(Faces_[i], line.Vector)) {
+            continue;
+        }
+        std::optional<THit> faceHit = Faces_[i].hitWithoutEdge(line, tMin, tMax);
+        if (faceHit == std::nullopt) {
+            continue;
+        }
+        const TSafeDouble distance = faceHit.value().T.abs();
+        tMin = std::max(tMin.Value, -distance.Value);
+        tMax = std::min(tMax.Value, distance.Value);
 
-    if (intersectionsWithDistances.empty()) {
+        nearest = faceHit;
+        nearest.value().FaceIndex = i;
+    }
+
+    // most face hits are replaced by nearer ones, so the edge is found for the nearest one only
+    if (nearest != std::nullopt) {
+        Faces_[nearest.value().FaceIndex].fillEdgeData(nearest.value());
+    }
+    return nearest;
+}
+std::optional<THit> TPolyhedron::anyHit(const TLine& line, TSafeDouble tMin, TSafeDouble tMax) const {
+    if (!Bounds_.Sphere.intersects(line.Point, line.Vector, tMin, tMax)) {
         return std::nullopt;
     }
-    return std::make_pair(std::get<0>(intersectionsWithDistances[0]), std::get<1>(intersectionsWithDistances[0]));
+    if (IsConvex_) {
+        return clipConvex(line.Point, line.Vector, tMin, tMax, true);
+    }
+
+    for (size_t i = 0; i < Faces_.size(); i++) {
+        if (isCulled(Faces_[i], line.Vector)) {
+            continue;
+        }
+        std::optional<THit> faceHit = Faces_[i].hit(line, tMin, tMax);
+        if (faceHit != std::nullopt) {
+            faceHit.value().FaceIndex = i;
+            return faceHit;
+        }
+    }
+    return std::nullopt;
+}
+
+template <typename TRays>
+void TPolyhedron::intersectBatch(const TRays& rays, std::span<std::optional<THit>> hits) const {
+    // face-major order: one face stays in cache while the whole batch is tested against it,
+    // hits[i] holds the nearest hit so far and bounds the interval of the next faces
+    checkBatchSizes(raysCount(rays), hits.size());
+    if (IsConvex_) {
+        for (size_t i = 0; i < hits.size(); i++) {
+            const TPoint origin = rayOrigin(rays, i);
+            const TVector direction = rayDirection(rays, i);
+            if (Bounds_.Sphere.intersects(origin, direction, 0.0, INF)) {
+                hits[i] = clipConvex(origin, direction, 0.0, INF, false);
+            } else {
+                hits[i] = std::nullopt;
+            }
+        }
+        return;
+    }
+
+    std::fill(hits.begin(), hits.end(), std::nullopt);
+
+    for (size_t faceIdx = 0; faceIdx < Faces_.size(); faceIdx++) {
+        const TPolygon& face = Faces_[faceIdx];
+        for (size_t i = 0; i < hits.size(); i++) {
+            if (isCulled(face, rayDirection(rays, i))) {
+                continue;
+            }
+            const TSafeDouble tMax = hits[i].has_value() ? hits[i].value().T : TSafeDouble{INF};
+            std::optional<THit> faceHit =
+                face.rayHitWithoutEdge(rayOrigin(rays, i), rayDirection(rays, i), 0.0, tMax);
+            if (faceHit != std::nullopt) {
+                hits[i] = faceHit;
+                hits[i].value().FaceIndex = faceIdx;
+            }
+        }
+    }
+    for (std::optional<THit>& hit : hits) {
+        if (hit != std::nullopt) {
+            Faces_[hit.value().FaceIndex].fillEdgeData(hit.value());
+        }
+    }
+}
+template <typename TRays>
+void TPolyhedron::intersectAnyBatch(const TRays& rays, std::span<std::optional<THit>> hits) const {
+    if (IsConvex_) {
+        intersectBatch(rays, hits);
+        return;
+    }
+
+    checkBatchSizes(raysCount(rays), hits.size());
+    for (size_t i = 0; i < hits.size(); i++) {
+        hits[i] = std::nullopt;
+        if (!Bounds_.Sphere.intersects(rayOrigin(rays, i), rayDirection(rays, i), 0.0, INF)) {
+            continue;
+        }
+        for (size_t faceIdx = 0; faceIdx < Faces_.size(); faceIdx++) {
+            if (isCulled(Faces_[faceIdx], rayDirection(rays, i))) {
+                continue;
+            }
+            hits[i] = Faces_[faceIdx].rayHit(rayOrigin(rays, i), rayDirection(rays, i), 0.0, INF);
+            if (hits[i] != std::nullopt) {
+                hits[i].value().FaceIndex = faceIdx;
+                break;
+            }
+        }
+    }
+}
+
+void TPolyhedron::intersect(std::span<const TRay> rays, std::span<std::optional<THit>> hits) const {
+    intersectBatch(rays, hits);
+}
+void TPolyhedron::intersect(const TRayBatch& rays, std::span<std::optional<THit>> hits) const {
+    intersectBatch(rays, hits);
+}
+void TPolyhedron::intersectAny(std::span<const TRay> rays, std::span<std::optional<THit>> hits) const {
+    intersectAnyBatch(rays, hits);
+}
+void TPolyhedron::intersectAny(const TRayBatch& rays, std::span<std::optional<THit>> hits) const {
+    intersectAnyBatch(rays, hits);
 }
 
 std::ostream& operator<<(std::ostream& os, const TPolyhedron& polyhedron) {
@@ -12,14 +12,44 @@ class TPolyhedron : public TFigure {
   public:
     TPolyhedron(const std::unordered_set<TPolygon>& polygons);
 
-    const std::unordered_set<TPolygon>& getFaces() const;
+    const std::vector<TPolygon>& getFaces() const;
+    bool getIsConvex() const;
 
-    std::optional<std::pair<TPoint, TPointContainment>> intersection(const TLine& line) const override;
+    TBounds bounds() const final;
+
+    // faces whose outward normal looks along the ray are skipped, which is only correct for rays from outside
+    void setBackFaceCulling(bool enabled);
+    bool getBackFaceCulling() const;
+
+    std::optional<THit> hit(const TLine& line, TSafeDouble tMin, TSafeDouble tMax) const final;
+    std::optional<THit> anyHit(const TLine& line, TSafeDouble tMin, TSafeDouble tMax) const final;
+
+    void intersect(std::span<const TRay> rays, std::span<std::optional<THit>> hits) const final;
+    void intersect(const TRayBatch& rays, std::span<std::optional<THit>> hits) const final;
+    void intersectAny(std::span<const TRay> rays, std::span<std::optional<THit>> hits) const final;
+    void intersectAny(const TRayBatch& rays, std::span<std::optional<THit>> hits) const final;
 
     friend std::ostream& operator<<(std::ostream& os, const TPolyhedron& polyhedron);
 
   private:
-    std::unordered_set<TPolygon> Faces_;
+    std::vector<TPolygon> Faces_;
+    bool BackFaceCulling_ = false;
+    bool IsConvex_ = true;
+    TBounds Bounds_;
+
+    void orientFacesOutward();
+    void checkConvexity();
+    bool isCulled(const TPolygon& face, const TVector& direction) const;
+
+    std::optional<THit> clipConvex(const TPoint& origin, const TVector& direction, TSafeDouble tMin,
+                                   TSafeDouble tMax, bool throwOnLineInFace) const;
+    std::optional<THit> faceHit(size_t faceIdx, const TPoint& origin, const TVector& direction,
+                                TSafeDouble t) const;
+
+    template <typename TRays>
+    void intersectBatch(const TRays& rays, std::span<std::optional<THit>> hits) const;
+    template <typename TRays>
+    void intersectAnyBatch(const TRays& rays, std::span<std::optional<THit>> hits) const;
 };
 
 TPolyhedron createRegularTetrahedron(const TPoint& center, TSafeDouble edgeLength);
@@ -0,0 +1,77 @@
+#include "progressive.h"
+#include "camera.h"
+
+#include <atomic>
+
+namespace NRayTracingLib {
+
+TProgressiveStats TProgressiveRenderer::render(TCamera& camera, const THitFunc& hitFunc,
+                                               const TOccludedFunc& occludedFunc,
+                                               std::chrono::steady_clock::time_point deadline) {
+    camera.resetRenderStats();
+    TProgressiveStats stats;
+    const size_t width = camera.WidthResolution_;
+    const size_t height = camera.HeightResolution_;
+    std::atomic<size_t> tracedPixelsCount = 0;
+    std::atomic<bool> late = false;
+    std::atomic<bool> stopped = false;
+    for (size_t step = PROGRESSIVE_FIRST_STEP; step > 0 && !late; step /= 2) {
+        // a pass traces the grid of its step without the pixels of the coarser grids traced before
+        threadPool().run((height + step - 1) / step, [&](size_t gridRow) {
+            if (camera.StopToken_.stop_requested()) {
+                stopped = true;
+                late = true;
+                return;
+            }
+            if (step < PROGRESSIVE_FIRST_STEP && (late || std::chrono::steady_clock::now() >= deadline)) {
+                late = true;
+                return;
+            }
+            TSpanContext& context = camera.currentContext();
+            const size_t i = gridRow * step;
+            const bool coarseRow = step < PROGRESSIVE_FIRST_STEP && i % (2 * step) == 0;
+            context.Pixels.clear();
+            for (size_t j = coarseRow ? step : 0; j < width; j += coarseRow ? 2 * step : step) {
+                context.Pixels.push_back(i * width + j);
+            }
+            camera.traceSpan(context, hitFunc, occludedFunc);
+            tracedPixelsCount += context.Pixels.size();
+        });
+        if (late) {
+            break;
+        }
+        stats.PassesCount++;
+        stats.Step = step;
+        if (step > 1) {
+            fillFromGrid(camera, step);
+        }
+        camera.publishTile(TPixelRect{0, 0, height, width});
+    }
+    stats.TracedPixelsCount = tracedPixelsCount;
+    stats.Complete = !late;
+    camera.Stopped_ = stopped;
+    camera.collectRenderStats();
+    return stats;
+}
+
+void TProgressiveRenderer::fillFromGrid(TCamera& camera, size_t step) {
+    const size_t width = camera.WidthResolution_;
+    const size_t height = camera.HeightResolution_;
+    TImageData& imageData = camera.ImageData_;
+    const auto nearest = [step](size_t coordinate, size_t resolution) {
+        return std::min((coordinate + step / 2) / step * step, (resolution - 1) / step * step);
+    };
+    threadPool().run(height, [&](size_t i) {
+        const size_t sourceRow = nearest(i, height);
+        for (size_t j = 0; j < width; j++) {
+            const size_t sourceColumn = nearest(j, width);
+            if (sourceRow == i && sourceColumn == j) {
+                continue;
+            }
+            const size_t source = (sourceRow * width + sourceColumn) * 3;
+            std::copy_n(imageData.begin() + source, 3, imageData.begin() + (i * width + j) * 3);
+        }
+    });
+}
+
+} // namespace NRayTracingLib
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "common.h"
+#include "figure.h"
+
+#include <chrono>
+#include <functional>
+
+namespace NRayTracingLib {
+
+class TCamera;
+
+// grid step of the first progressive pass, a power of two
+static constexpr size_t PROGRESSIVE_FIRST_STEP = 16;
+
+// how far a progressive picture got before its deadline
+class TProgressiveStats {
+  public:
+    size_t PassesCount = 0;
+    // pixel step of the last finished pass: the other pixels are copied from the nearest pixel of its grid
+    size_t Step = 0;
+    size_t TracedPixelsCount = 0;
+    // whether every pixel was traced
+    bool Complete = false;
+};
+
+// traces a picture of a camera pass by pass, over grids of pixels halving their step
+class TProgressiveRenderer {
+  public:
+    // nearest hit of the ray and the figure hit
+    using THitFunc = std::function<std::optional<THit>(const TRay& ray, const TFigure*& hitFigure)>;
+    using TOccludedFunc =
+        std::function<void(std::span<const TRay> rays, std::span<const double> tMaxs, std::span<uint8_t> occluded)>;
+
+    // the first pass is always finished, the next ones are started until the deadline
+    static TProgressiveStats render(TCamera& camera, const THitFunc& hitFunc, const TOccludedFunc& occludedFunc,
+                                    std::chrono::steady_clock::time_point deadline);
+
+  private:
+    // fills the pixels off the grid of the step from the nearest grid pixel
+    static void fillFromGrid(TCamera& camera, size_t step);
+};
+
+} // namespace NRayTracingLib
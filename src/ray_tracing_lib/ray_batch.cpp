@@ -0,0 +1,67 @@
+#include "ray_batch.h"
+#include "line.h"
+
+namespace NRayTracingLib {
+
+TRayBatch::TRayBatch(std::span<const double> originX, std::span<const double> originY,
+                     std::span<const double> originZ, std::span<const double> directionX,
+                     std::span<const double> directionY, std::span<const double> directionZ)
+    : OriginX(originX), OriginY(originY), OriginZ(originZ), DirectionX(directionX), DirectionY(directionY),
+      DirectionZ(directionZ) {
+    const size_t count = OriginX.size();
+    for (const auto& coordinates : {OriginY, OriginZ, DirectionX, DirectionY, DirectionZ}) {
+        if (coordinates.size() != count) {
+            throw std::runtime_error("Error: creating ray batch by coordinate arrays of different sizes");
+        }
+    }
+}
+
+size_t TRayBatch::size() const { return OriginX.size(); }
+
+TPoint TRayBatch::origin(size_t i) const { return TPoint{OriginX[i], OriginY[i], OriginZ[i]}; }
+TVector TRayBatch::direction(size_t i) const { return TVector{DirectionX[i], DirectionY[i], DirectionZ[i]}; }
+
+size_t TRayQueue::size() const { return OriginX.size(); }
+bool TRayQueue::empty() const { return OriginX.empty(); }
+
+void TRayQueue::clear() {
+    for (auto* coordinates : {&OriginX, &OriginY, &OriginZ, &DirectionX, &DirectionY, &DirectionZ, &Weight}) {
+        coordinates->clear();
+    }
+    Pixel.clear();
+    Inside.clear();
+}
+void TRayQueue::reserve(size_t count) {
+    for (auto* coordinates : {&OriginX, &OriginY, &OriginZ, &DirectionX, &DirectionY, &DirectionZ, &Weight}) {
+        coordinates->reserve(count);
+    }
+    Pixel.reserve(count);
+    Inside.reserve(count);
+}
+
+void TRayQueue::push(const TPoint& origin, const TVector& direction, size_t pixel, double weight, bool inside) {
+    OriginX.push_back(origin.X.Value);
+    OriginY.push_back(origin.Y.Value);
+    OriginZ.push_back(origin.Z.Value);
+    DirectionX.push_back(direction.X.Value);
+    DirectionY.push_back(direction.Y.Value);
+    DirectionZ.push_back(direction.Z.Value);
+    Pixel.push_back(pixel);
+    Weight.push_back(weight);
+    Inside.push_back(inside);
+}
+
+TRayBatch TRayQueue::batch() const {
+    return TRayBatch{OriginX, OriginY, OriginZ, DirectionX, DirectionY, DirectionZ};
+}
+TRay TRayQueue::ray(size_t i) const {
+    return TRay{TPoint{OriginX[i], OriginY[i], OriginZ[i]}, TVector{DirectionX[i], DirectionY[i], DirectionZ[i]}};
+}
+
+void checkBatchSizes(size_t raysCount, size_t hitsCount) {
+    if (raysCount != hitsCount) {
+        throw std::runtime_error("Error: batch intersection with different rays and hits counts");
+    }
+}
+
+} // namespace NRayTracingLib
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "common.h"
+#include "point.h"
+#include "vector.h"
+
+namespace NRayTracingLib {
+
+// structure-of-arrays view of rays: ray i starts at (OriginX[i], OriginY[i], OriginZ[i])
+// and goes along (DirectionX[i], DirectionY[i], DirectionZ[i])
+class TRayBatch {
+  public:
+    std::span<const double> OriginX, OriginY, OriginZ;
+    std::span<const double> DirectionX, DirectionY, DirectionZ;
+
+    explicit TRayBatch(std::span<const double> originX, std::span<const double> originY,
+                       std::span<const double> originZ, std::span<const double> directionX,
+                       std::span<const double> directionY, std::span<const double> directionZ);
+
+    size_t size() const;
+
+    TPoint origin(size_t i) const;
+    TVector direction(size_t i) const;
+};
+
+class TRay;
+
+// growing structure-of-arrays queue of the rays of one wavefront rendering stage; besides the geometry every ray
+// carries the pixel it brings color to, its share of the pixel color and whether it goes inside a transparent figure
+class TRayQueue {
+  public:
+    std::vector<double> OriginX, OriginY, OriginZ;
+    std::vector<double> DirectionX, DirectionY, DirectionZ;
+    std::vector<size_t> Pixel;
+    std::vector<double> Weight;
+    std::vector<uint8_t> Inside;
+
+    size_t size() const;
+    bool empty() const;
+    void clear();
+    void reserve(size_t count);
+    void push(const TPoint& origin, const TVector& direction, size_t pixel, double weight, bool inside);
+
+    TRayBatch batch() const;
+    TRay ray(size_t i) const;
+};
+
+inline size_t raysCount(const TRayBatch& rays) { return rays.size(); }
+inline TPoint rayOrigin(const TRayBatch& rays, size_t i) { return rays.origin(i); }
+inline TVector rayDirection(const TRayBatch& rays, size_t i) { return rays.direction(i); }
+
+void checkBatchSizes(size_t raysCount, size_t hitsCount);
+
+} // namespace NRayTracingLib
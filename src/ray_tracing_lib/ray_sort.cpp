@@ -0,0 +1,130 @@
+#include "ray_sort.h"
+#include "parallel.h"
+
+namespace NRayTracingLib {
+
+static constexpr size_t RADIX_BITS = 8;
+static constexpr size_t RADIX = 1 << RADIX_BITS;
+// smaller inputs are sorted by one thread, a pass over them is cheaper than the threads start
+static constexpr size_t PARALLEL_SORT_MIN_SIZE = 1 << 15;
+
+// spreads the low 10 bits of value so that two zero bits follow every one of them
+static uint32_t spreadBits(uint32_t value) {
+    value &= 0x3ff;
+    value = (value | (value << 16)) & 0x030000ff;
+    value = (value | (value << 8)) & 0x0300f00f;
+    value = (value | (value << 4)) & 0x030c30c3;
+    value = (value | (value << 2)) & 0x09249249;
+    return value;
+}
+
+static uint32_t quantize(double value, double min, double max) {
+    const uint32_t cells = 1 << RAY_KEY_ORIGIN_BITS;
+    if (!(max > min)) {
+        return 0;
+    }
+    const double cell = (value - min) / (max - min) * cells;
+    return static_cast<uint32_t>(std::clamp(cell, 0.0, static_cast<double>(cells - 1)));
+}
+
+uint32_t rayKey(const TPoint& origin, const TVector& direction, const TBoundingBox& bounds) {
+    const uint32_t octant = (direction.X.Value < 0.0 ? 1 : 0) | (direction.Y.Value < 0.0 ? 2 : 0) |
+                           (direction.Z.Value < 0.0 ? 4 : 0);
+    const uint32_t morton = spreadBits(quantize(origin.X.Value, bounds.Min.X.Value, bounds.Max.X.Value)) |
+                            spreadBits(quantize(origin.Y.Value, bounds.Min.Y.Value, bounds.Max.Y.Value)) << 1 |
+                            spreadBits(quantize(origin.Z.Value, bounds.Min.Z.Value, bounds.Max.Z.Value)) << 2;
+    return octant << (3 * RAY_KEY_ORIGIN_BITS) | morton;
+}
+
+void radixSort(std::span<const uint32_t> keys, std::vector<uint32_t>& order, size_t threadsCount) {
+    const uint32_t count = static_cast<uint32_t>(keys.size());
+    order.resize(count);
+    for (uint32_t i = 0; i < count; i++) {
+        order[i] = i;
+    }
+    const size_t chunksCount = count < PARALLEL_SORT_MIN_SIZE ? 1 : std::max<size_t>(1, threadsCount);
+    std::vector<uint32_t> sortedKeys(keys.begin(), keys.end());
+    std::vector<uint32_t> nextKeys(count);
+    std::vector<uint32_t> nextOrder(count);
+    std::vector<std::array<uint32_t, RADIX>> offsets(chunksCount);
+
+    for (size_t shift = 0; shift < 32; shift += RADIX_BITS) {
+        forChunks(0, count, chunksCount, [&](uint32_t chunkBegin, uint32_t chunkEnd, size_t chunk) {
+            offsets[chunk].fill(0);
+            for (uint32_t i = chunkBegin; i < chunkEnd; i++) {
+                offsets[chunk][(sortedKeys[i] >> shift) & (RADIX - 1)]++;
+            }
+        });
+        // a pass over a digit all keys share changes nothing
+        bool sameDigit = false;
+        uint32_t offset = 0;
+        for (size_t digit = 0; digit < RADIX; digit++) {
+            const uint32_t digitBegin = offset;
+            for (size_t chunk = 0; chunk < chunksCount; chunk++) {
+                const uint32_t digitCount = offsets[chunk][digit];
+                offsets[chunk][digit] = offset;
+                offset += digitCount;
+            }
+            sameDigit = sameDigit || offset - digitBegin == count;
+        }
+        if (sameDigit) {
+            continue;
+        }
+        forChunks(0, count, chunksCount, [&](uint32_t chunkBegin, uint32_t chunkEnd, size_t chunk) {
+            for (uint32_t i = chunkBegin; i < chunkEnd; i++) {
+                const uint32_t position = offsets[chunk][(sortedKeys[i] >> shift) & (RADIX - 1)]++;
+                nextKeys[position] = sortedKeys[i];
+                nextOrder[position] = order[i];
+            }
+        });
+        std::swap(sortedKeys, nextKeys);
+        std::swap(order, nextOrder);
+    }
+}
+
+template <typename TRays>
+static std::vector<uint32_t> coherentRaysOrder(const TRays& rays, size_t threadsCount) {
+    const size_t count = raysCount(rays);
+    TBoundingBox bounds;
+    for (size_t i = 0; i < count; i++) {
+        bounds.extend(rayOrigin(rays, i));
+    }
+    std::vector<uint32_t> keys(count);
+    for (size_t i = 0; i < count; i++) {
+        keys[i] = rayKey(rayOrigin(rays, i), rayDirection(rays, i), bounds);
+    }
+    std::vector<uint32_t> order;
+    radixSort(keys, order, threadsCount);
+    return order;
+}
+
+std::vector<uint32_t> coherentOrder(std::span<const TRay> rays, size_t threadsCount) {
+    return coherentRaysOrder(rays, threadsCount);
+}
+std::vector<uint32_t> coherentOrder(const TRayBatch& rays, size_t threadsCount) {
+    return coherentRaysOrder(rays, threadsCount);
+}
+
+template <typename T>
+static void permute(std::vector<T>& values, const std::vector<uint32_t>& order, std::vector<T>& scratch) {
+    scratch.resize(values.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        scratch[i] = values[order[i]];
+    }
+    std::swap(values, scratch);
+}
+
+void sortRays(TRayQueue& queue, size_t threadsCount) {
+    const std::vector<uint32_t> order = coherentOrder(queue.batch(), threadsCount);
+    std::vector<double> scratch;
+    for (auto* values : {&queue.OriginX, &queue.OriginY, &queue.OriginZ, &queue.DirectionX, &queue.DirectionY,
+                         &queue.DirectionZ, &queue.Weight}) {
+        permute(*values, order, scratch);
+    }
+    std::vector<size_t> pixelScratch;
+    permute(queue.Pixel, order, pixelScratch);
+    std::vector<uint8_t> insideScratch;
+    permute(queue.Inside, order, insideScratch);
+}
+
+} // namespace NRayTracingLib
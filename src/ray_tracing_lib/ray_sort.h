@@ -0,0 +1,33 @@
+#pragma once
+
+#include "bounds.h"
+#include "common.h"
+#include "line.h"
+#include "parallel.h"
+#include "ray_batch.h"
+
+#include <array>
+
+namespace NRayTracingLib {
+
+// bits of every origin coordinate in a ray key, the direction octant takes the 3 bits above them
+static constexpr size_t RAY_KEY_ORIGIN_BITS = 9;
+
+// sort key of a ray: the octant of its direction in the top bits, then the Morton code of its origin quantized
+// over bounds, so rays going the same way from nearby points get close keys
+uint32_t rayKey(const TPoint& origin, const TVector& direction, const TBoundingBox& bounds);
+
+// stable LSD radix sort by bytes: order receives the indices of keys in sorted order;
+// large inputs are histogrammed and scattered by several threads
+void radixSort(std::span<const uint32_t> keys, std::vector<uint32_t>& order,
+               size_t threadsCount = threadPool().getThreadsCount());
+
+// order of rays making coherent runs, for packet traversal of secondary and shadow rays:
+// by direction octant, then by origin along a Morton curve over the origins bounds
+std::vector<uint32_t> coherentOrder(std::span<const TRay> rays, size_t threadsCount = threadPool().getThreadsCount());
+std::vector<uint32_t> coherentOrder(const TRayBatch& rays, size_t threadsCount = threadPool().getThreadsCount());
+
+// reorders the queue in place by coherentOrder
+void sortRays(TRayQueue& queue, size_t threadsCount = threadPool().getThreadsCount());
+
+} // namespace NRayTracingLib
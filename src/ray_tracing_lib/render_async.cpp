@@ -0,0 +1,66 @@
+#include "render_async.h"
+
+namespace NRayTracingLib {
+
+TRenderAwaitable::TRenderAwaitable(TCamera& camera, const TFigure& figure, std::stop_token stopToken,
+                                   TExecutor executor)
+    : Camera_(camera), Figure_(&figure), StopToken_(std::move(stopToken)), Executor_(std::move(executor)) {}
+
+TRenderAwaitable::TRenderAwaitable(TCamera& camera, std::vector<const TFigure*> figures, std::stop_token stopToken,
+                                   TExecutor executor)
+    : Camera_(camera), Figures_(std::move(figures)), StopToken_(std::move(stopToken)),
+      Executor_(std::move(executor)) {}
+
+bool TRenderAwaitable::await_ready() const noexcept { return false; }
+
+bool TRenderAwaitable::await_suspend(std::coroutine_handle<> handle) {
+    // the awaitable lives in the coroutine frame, it is not touched after the coroutine is resumed or handed off
+    threadPool().post([this, handle]() {
+        render();
+        if (!Handoff_.exchange(true, std::memory_order_acq_rel)) {
+            // await_suspend has not returned yet and resumes the coroutine by returning false
+            return;
+        }
+        if (Executor_) {
+            // the executor is moved out, the frame may be gone as soon as the coroutine runs
+            TExecutor executor = std::move(Executor_);
+            executor([handle]() { handle.resume(); });
+        } else {
+            handle.resume();
+        }
+    });
+    return !Handoff_.exchange(true, std::memory_order_acq_rel);
+}
+
+TRenderStatus TRenderAwaitable::await_resume() {
+    if (Error_) {
+        std::rethrow_exception(Error_);
+    }
+    return Status_;
+}
+
+void TRenderAwaitable::render() {
+    try {
+        Camera_.setStopToken(StopToken_);
+        if (Figure_ != nullptr) {
+            Camera_.makePicture(*Figure_);
+        } else {
+            Camera_.makePicture(Figures_);
+        }
+        Status_ = Camera_.isStopped() ? TRenderStatus::Stopped : TRenderStatus::Done;
+    } catch (...) {
+        Error_ = std::current_exception();
+    }
+    Camera_.setStopToken({});
+}
+
+TRenderAwaitable renderAsync(TCamera& camera, const TFigure& figure, std::stop_token stopToken, TExecutor executor) {
+    return TRenderAwaitable{camera, figure, std::move(stopToken), std::move(executor)};
+}
+
+TRenderAwaitable renderAsync(TCamera& camera, std::vector<const TFigure*> figures, std::stop_token stopToken,
+                             TExecutor executor) {
+    return TRenderAwaitable{camera, std::move(figures), std::move(stopToken), std::move(executor)};
+}
+
+} // namespace NRayTracingLib
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "camera.h"
+
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <stop_token>
+
+namespace NRayTracingLib {
+
+enum class TRenderStatus {
+    Done,
+    // a stop was requested before the picture was done, its parts not started yet keep their old pixels
+    Stopped,
+};
+
+// runs the task on a thread of the caller's choice, an event loop or a strand, and returns without waiting for it
+using TExecutor = std::function<void(std::function<void()>)>;
+
+// picture of a camera made on the thread pool while the awaiting coroutine is suspended: co_await starts it on
+// a worker, so no thread of the caller waits for the picture. The worker finishing it resumes the coroutine through
+// the executor, or right on that pool worker without one, so the code after co_await must not block the pool then.
+// A picture done before the coroutine got suspended, as without pool workers, where it is made on the awaiting
+// thread, does not suspend it at all: the coroutine goes on on the awaiting thread. Renders of different cameras
+// may be in flight at once, a camera makes one picture at a time
+class TRenderAwaitable {
+  public:
+    TRenderAwaitable(TCamera& camera, const TFigure& figure, std::stop_token stopToken, TExecutor executor);
+    TRenderAwaitable(TCamera& camera, std::vector<const TFigure*> figures, std::stop_token stopToken,
+                     TExecutor executor);
+
+    bool await_ready() const noexcept;
+    // false when the picture is already done, so the coroutine is not resumed from inside its own suspension
+    bool await_suspend(std::coroutine_handle<> handle);
+    // rethrows the exception the picture was ended with
+    TRenderStatus await_resume();
+
+  private:
+    TCamera& Camera_;
+    // the single figure, or the figures list when it is nullptr
+    const TFigure* Figure_ = nullptr;
+    std::vector<const TFigure*> Figures_;
+    std::stop_token StopToken_;
+    TExecutor Executor_;
+    TRenderStatus Status_ = TRenderStatus::Done;
+    std::exception_ptr Error_;
+    // set by the first of the suspending thread and the rendering one, the second one goes on with the coroutine
+    std::atomic<bool> Handoff_ = false;
+
+    void render();
+};
+
+// co_await renderAsync(camera, figures, token, executor) makes the picture as makePicture does, a stop requested
+// through the token ends it early; the coroutine is resumed through the executor when one is given
+TRenderAwaitable renderAsync(TCamera& camera, const TFigure& figure, std::stop_token stopToken = {},
+                             TExecutor executor = {});
+TRenderAwaitable renderAsync(TCamera& camera, std::vector<const TFigure*> figures, std::stop_token stopToken = {},
+                             TExecutor executor = {});
+
+} // namespace NRayTracingLib
@@ -9,6 +9,7 @@ namespace NRayTracingLib {
 // ACCURACY = 1e-16 allows use abs to 922
 static constexpr double ACCURACY = 1e-9;
 static constexpr unsigned COUT_PRECISION = 10;
+static constexpr double INF = std::numeric_limits<double>::infinity();
 
 class TSafeDouble {
   public:
@@ -0,0 +1,118 @@
+#include "transform.h"
+
+namespace NRayTracingLib {
+
+TTransform::TTransform() : Rows{{{1.0, 0.0, 0.0, 0.0}, {0.0, 1.0, 0.0, 0.0}, {0.0, 0.0, 1.0, 0.0}}} {}
+TTransform::TTransform(const std::array<std::array<double, 4>, 3>& rows) : Rows(rows) {}
+
+TTransform TTransform::translation(const TVector& shift) {
+    TTransform transform;
+    transform.Rows[0][3] = shift.X.Value;
+    transform.Rows[1][3] = shift.Y.Value;
+    transform.Rows[2][3] = shift.Z.Value;
+    return transform;
+}
+TTransform TTransform::scaling(TSafeDouble factor) {
+    if (factor == 0.0) {
+        throw std::runtime_error("Error: scaling by zero factor");
+    }
+    TTransform transform;
+    for (size_t i = 0; i < 3; i++) {
+        transform.Rows[i][i] = factor.Value;
+    }
+    return transform;
+}
+TTransform TTransform::rotation(const TVector& axis, const TAngle& angle) {
+    if (axis.isZero()) {
+        throw std::runtime_error("Error: rotation around zero axis");
+    }
+    // Rodrigues' rotation formula
+    const TVector unit = axis.getNormalized();
+    const double x = unit.X.Value, y = unit.Y.Value, z = unit.Z.Value;
+    const double c = angle.cos().Value, s = angle.sin().Value, t = 1.0 - c;
+    return TTransform{{{
+        {t * x * x + c, t * x * y - s * z, t * x * z + s * y, 0.0},
+        {t * x * y + s * z, t * y * y + c, t * y * z - s * x, 0.0},
+        {t * x * z - s * y, t * y * z + s * x, t * z * z + c, 0.0},
+    }}};
+}
+
+TTransform TTransform::operator*(const TTransform& other) const {
+    TTransform result;
+    for (size_t i = 0; i < 3; i++) {
+        for (size_t j = 0; j < 4; j++) {
+            result.Rows[i][j] = (j == 3) ? Rows[i][3] : 0.0;
+            for (size_t k = 0; k < 3; k++) {
+                result.Rows[i][j] += Rows[i][k] * other.Rows[k][j];
+            }
+        }
+    }
+    return result;
+}
+
+TTransform TTransform::inverse() const {
+    const auto& m = Rows;
+    const double det = m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1]) -
+                       m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0]) +
+                       m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+    if (TSafeDouble{det} == 0.0) {
+        throw std::runtime_error("Error: inverting degenerate transform");
+    }
+
+    // linear part is inverted by its adjugate, translation is the inverted linear part applied to -translation
+    TTransform result;
+    result.Rows[0][0] = (m[1][1] * m[2][2] - m[1][2] * m[2][1]) / det;
+    result.Rows[0][1] = (m[0][2] * m[2][1] - m[0][1] * m[2][2]) / det;
+    result.Rows[0][2] = (m[0][1] * m[1][2] - m[0][2] * m[1][1]) / det;
+    result.Rows[1][0] = (m[1][2] * m[2][0] - m[1][0] * m[2][2]) / det;
+    result.Rows[1][1] = (m[0][0] * m[2][2] - m[0][2] * m[2][0]) / det;
+    result.Rows[1][2] = (m[0][2] * m[1][0] - m[0][0] * m[1][2]) / det;
+    result.Rows[2][0] = (m[1][0] * m[2][1] - m[1][1] * m[2][0]) / det;
+    result.Rows[2][1] = (m[0][1] * m[2][0] - m[0][0] * m[2][1]) / det;
+    result.Rows[2][2] = (m[0][0] * m[1][1] - m[0][1] * m[1][0]) / det;
+    for (size_t i = 0; i < 3; i++) {
+        result.Rows[i][3] = 0.0;
+        for (size_t k = 0; k < 3; k++) {
+            result.Rows[i][3] -= result.Rows[i][k] * m[k][3];
+        }
+    }
+    return result;
+}
+
+TPoint TTransform::apply(const TPoint& point) const {
+    const double x = point.X.Value, y = point.Y.Value, z = point.Z.Value;
+    return TPoint{Rows[0][0] * x + Rows[0][1] * y + Rows[0][2] * z + Rows[0][3],
+                  Rows[1][0] * x + Rows[1][1] * y + Rows[1][2] * z + Rows[1][3],
+                  Rows[2][0] * x + Rows[2][1] * y + Rows[2][2] * z + Rows[2][3]};
+}
+TVector TTransform::apply(const TVector& vector) const {
+    const double x = vector.X.Value, y = vector.Y.Value, z = vector.Z.Value;
+    return TVector{Rows[0][0] * x + Rows[0][1] * y + Rows[0][2] * z, Rows[1][0] * x + Rows[1][1] * y + Rows[1][2] * z,
+                   Rows[2][0] * x + Rows[2][1] * y + Rows[2][2] * z};
+}
+TVector TTransform::applyTransposed(const TVector& vector) const {
+    const double x = vector.X.Value, y = vector.Y.Value, z = vector.Z.Value;
+    return TVector{Rows[0][0] * x + Rows[1][0] * y + Rows[2][0] * z, Rows[0][1] * x + Rows[1][1] * y + Rows[2][1] * z,
+                   Rows[0][2] * x + Rows[1][2] * y + Rows[2][2] * z};
+}
+TBoundingBox TTransform::apply(const TBoundingBox& box) const {
+    if (box.isEmpty() || box.isInfinite()) {
+        return box.isEmpty() ? box : TBoundingBox::infinite();
+    }
+    TBoundingBox result;
+    for (size_t corner = 0; corner < 8; corner++) {
+        result.extend(apply(TPoint{(corner & 1) ? box.Max.X : box.Min.X, (corner & 2) ? box.Max.Y : box.Min.Y,
+                                   (corner & 4) ? box.Max.Z : box.Min.Z}));
+    }
+    return result;
+}
+
+std::ostream& operator<<(std::ostream& os, const TTransform& transform) {
+    os << "transform:\n";
+    for (const auto& row : transform.Rows) {
+        os << row[0] << ' ' << row[1] << ' ' << row[2] << ' ' << row[3] << '\n';
+    }
+    return os;
+}
+
+} // namespace NRayTracingLib
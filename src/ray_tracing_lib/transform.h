@@ -0,0 +1,42 @@
+#pragma once
+
+#include "angle.h"
+#include "bounds.h"
+#include "common.h"
+#include "point.h"
+#include "vector.h"
+
+#include <array>
+
+namespace NRayTracingLib {
+
+// affine transform stored as a 3x4 matrix: linear part in the first three columns, translation in the last one
+class TTransform {
+  public:
+    std::array<std::array<double, 4>, 3> Rows;
+
+    // identity transform
+    TTransform();
+    explicit TTransform(const std::array<std::array<double, 4>, 3>& rows);
+
+    static TTransform translation(const TVector& shift);
+    static TTransform scaling(TSafeDouble factor);
+    // rotation around the axis going through the origin, counterclockwise when looking against the axis
+    static TTransform rotation(const TVector& axis, const TAngle& angle);
+
+    // transform applying other first and this one second
+    TTransform operator*(const TTransform& other) const;
+    TTransform inverse() const;
+
+    TPoint apply(const TPoint& point) const;
+    TVector apply(const TVector& vector) const;
+    // applies the transposed linear part: called on the inverse of a transform it maps normals of surfaces
+    // transformed by this transform, lengths are not kept
+    TVector applyTransposed(const TVector& vector) const;
+    // box around the transformed box
+    TBoundingBox apply(const TBoundingBox& box) const;
+
+    friend std::ostream& operator<<(std::ostream& os, const TTransform& transform);
+};
+
+} // namespace NRayTracingLib
@@ -0,0 +1,196 @@
+#include "wavefront.h"
+#include "camera.h"
+#include "ray_sort.h"
+
+namespace NRayTracingLib {
+
+// queues hold the primary rays of this many pixels at most, whole rows are taken
+static constexpr size_t WAVEFRONT_QUEUE_SIZE = 1 << 16;
+// the intersect and shade stages split a queue into chunks of this many rays for the pool threads
+static constexpr size_t WAVEFRONT_CHUNK_SIZE = 1024;
+
+static TRayBatch subBatch(const TRayBatch& rays, size_t begin, size_t count) {
+    return TRayBatch{rays.OriginX.subspan(begin, count),    rays.OriginY.subspan(begin, count),
+                     rays.OriginZ.subspan(begin, count),    rays.DirectionX.subspan(begin, count),
+                     rays.DirectionY.subspan(begin, count), rays.DirectionZ.subspan(begin, count)};
+}
+
+void TWavefrontRenderer::render(TCamera& camera, const TIntersectFunc& intersectFunc,
+                                const TOccludedFunc& occludedFunc) {
+    camera.resetRenderStats();
+    const size_t width = camera.WidthResolution_;
+    const size_t height = camera.HeightResolution_;
+    // stages run one after another, the intersect and shade stages split the queue over the pool threads
+    TSpanContext& context = camera.currentContext();
+    // waves take whole rows of tiles
+    const size_t rowsPerWave = std::max<size_t>(1, WAVEFRONT_QUEUE_SIZE / width / TILE_SIZE) * TILE_SIZE;
+    const size_t waveSize = std::min(rowsPerWave, height) * width;
+    Queue_.reserve(waveSize);
+    WaveColors_.resize(waveSize);
+    WaveLit_.resize(waveSize);
+
+    camera.Stopped_ = false;
+    for (size_t firstRow = 0; firstRow < height; firstRow += rowsPerWave) {
+        if (camera.StopToken_.stop_requested()) {
+            camera.Stopped_ = true;
+            break;
+        }
+        print("Progress =", static_cast<double>(firstRow) / height * 100, "%");
+        const size_t rowsEnd = std::min(height, firstRow + rowsPerWave);
+        const size_t firstPixel = firstRow * width;
+        std::fill(WaveColors_.begin(), WaveColors_.end(), TColor{});
+        std::fill(WaveLit_.begin(), WaveLit_.end(), false);
+
+        // generate stage, span by span in the pixel order
+        Queue_.clear();
+        for (size_t span = 0; span < camera.spansCount(); span++) {
+            camera.fillSpan(span, firstRow, rowsEnd, context.Pixels);
+            for (const size_t pixel : context.Pixels) {
+                Queue_.push(camera.Position_, camera.pixelDirection(pixel / width, pixel % width),
+                            pixel - firstPixel, 1.0, false);
+            }
+        }
+
+        for (size_t depth = 0; !Queue_.empty(); depth++) {
+            // intersect stage, primary rays are coherent as generated
+            if (depth > 0 && camera.RaySorting_) {
+                sortRays(Queue_);
+            }
+            QueueHits_.resize(Queue_.size());
+            QueueFigures_.resize(Queue_.size());
+            QueueColors_.resize(Queue_.size());
+            const TRayBatch batch = Queue_.batch();
+            const uint32_t queueSize = static_cast<uint32_t>(Queue_.size());
+            const size_t chunksCount = (queueSize + WAVEFRONT_CHUNK_SIZE - 1) / WAVEFRONT_CHUNK_SIZE;
+            forChunks(0, queueSize, chunksCount, [&](uint32_t chunkBegin, uint32_t chunkEnd, size_t) {
+                const size_t count = chunkEnd - chunkBegin;
+                intersectFunc(subBatch(batch, chunkBegin, count),
+                              std::span<std::optional<THit>>{QueueHits_}.subspan(chunkBegin, count),
+                              std::span<const TFigure*>{QueueFigures_}.subspan(chunkBegin, count));
+                shadeQueue(camera, camera.currentContext(), depth, firstPixel, chunkBegin, chunkEnd, occludedFunc);
+            });
+            context.Stats.RaysPerBounce[depth] += Queue_.size();
+            // rays of one pixel may be in different chunks, so their colors are summed here in the queue order
+            for (size_t i = 0; i < Queue_.size(); i++) {
+                if (QueueHits_[i].has_value()) {
+                    WaveColors_[Queue_.Pixel[i]] +=
+                        QueueColors_[i] * (Queue_.Weight[i] * camera.getMaterial(QueueFigures_[i]).localWeight());
+                }
+            }
+            spawnQueue(camera, context, depth);
+            std::swap(Queue_, NextQueue_);
+        }
+
+        for (size_t pixel = 0; pixel < (rowsEnd - firstRow) * width; pixel++) {
+            if (WaveLit_[pixel]) {
+                const std::array<uint8_t, 3> bytes = WaveColors_[pixel].toBytes();
+                std::copy(bytes.begin(), bytes.end(), camera.ImageData_.begin() + (firstPixel + pixel) * 3);
+            }
+        }
+        camera.publishTile(TPixelRect{firstRow, 0, rowsEnd - firstRow, width});
+    }
+    camera.collectRenderStats();
+}
+
+void TWavefrontRenderer::shadeQueue(TCamera& camera, TSpanContext& context, size_t depth, size_t firstPixel,
+                                    size_t begin, size_t end, const TOccludedFunc& occludedFunc) {
+    const std::vector<TLight>& lights = camera.Lights_;
+    for (size_t i = begin; i < end; i++) {
+        if (!QueueHits_[i].has_value()) {
+            if (depth == 0) {
+                camera.writeBackgroundPixel(firstPixel + Queue_.Pixel[i]);
+            }
+            continue;
+        }
+        THit& hit = QueueHits_[i].value();
+        if (depth == 0 && (lights.empty() || hit.Containment != TPointContainment::Inside)) {
+            camera.writeUnlitPixel(firstPixel + Queue_.Pixel[i], hit);
+        }
+        // only the hits shaded by lights go further
+        if (lights.empty() || hit.Containment != TPointContainment::Inside) {
+            QueueHits_[i] = std::nullopt;
+            continue;
+        }
+        if (hit.Normal * TVector{Queue_.DirectionX[i], Queue_.DirectionY[i], Queue_.DirectionZ[i]} > 0.0) {
+            hit.Normal = -hit.Normal;
+        }
+        QueueColors_[i] = camera.getMaterial(QueueFigures_[i]).Ambient;
+        if (depth == 0) {
+            WaveLit_[Queue_.Pixel[i]] = true;
+        }
+    }
+
+    for (const auto& light : lights) {
+        context.ShadowRays.clear();
+        context.ShadowMaxs.clear();
+        context.ShadowPixels.clear();
+        for (size_t i = begin; i < end; i++) {
+            if (!QueueHits_[i].has_value()) {
+                continue;
+            }
+            const THit& hit = QueueHits_[i].value();
+            const auto [toLight, tMax] = light.shadowRay(hit.Point);
+            if (toLight.isZero() || hit.Normal * toLight <= 0.0 ||
+                camera.getMaterial(QueueFigures_[i]).localWeight() == 0.0) {
+                continue;
+            }
+            context.ShadowRays.emplace_back(hit.Point + hit.Normal * RAY_OFFSET, toLight);
+            context.ShadowMaxs.push_back(tMax);
+            context.ShadowPixels.push_back(i);
+        }
+        if (camera.RaySorting_) {
+            sortShadowRays(context);
+        }
+        context.ShadowOccluded.assign(context.ShadowRays.size(), false);
+        occludedFunc(std::span<const TRay>{context.ShadowRays}, std::span<const double>{context.ShadowMaxs},
+                     std::span<uint8_t>{context.ShadowOccluded.data(), context.ShadowRays.size()});
+        context.Stats.ShadowRaysCount += context.ShadowRays.size();
+
+        for (size_t k = 0; k < context.ShadowPixels.size(); k++) {
+            if (context.ShadowOccluded[k]) {
+                continue;
+            }
+            const size_t i = context.ShadowPixels[k];
+            const THit& hit = QueueHits_[i].value();
+            const TVector direction{Queue_.DirectionX[i], Queue_.DirectionY[i], Queue_.DirectionZ[i]};
+            QueueColors_[i] += camera.getMaterial(QueueFigures_[i])
+                                   .reflect(light.intensityAt(hit.Point), hit.Normal,
+                                            context.ShadowRays[k].Vector.getNormalized(), -direction.getNormalized());
+        }
+    }
+}
+
+void TWavefrontRenderer::spawnQueue(TCamera& camera, TSpanContext& context, size_t depth) {
+    NextQueue_.clear();
+    std::array<TSecondaryRay, 2> spawned;
+    for (size_t i = 0; i < Queue_.size(); i++) {
+        if (!QueueHits_[i].has_value()) {
+            continue;
+        }
+        const TSecondaryRay parent{Queue_.ray(i), Queue_.Pixel[i], depth, Queue_.Weight[i],
+                                   static_cast<bool>(Queue_.Inside[i])};
+        const size_t spawnedCount = camera.spawnSecondaryRays(context.Stats, QueueHits_[i].value(), parent.Ray.Vector,
+                                                              camera.getMaterial(QueueFigures_[i]), parent, spawned);
+        for (size_t k = 0; k < spawnedCount; k++) {
+            const TSecondaryRay& ray = spawned[k];
+            NextQueue_.push(ray.Ray.Point, ray.Ray.Vector, ray.Pixel, ray.Weight, ray.Inside);
+        }
+    }
+}
+
+void TWavefrontRenderer::sortShadowRays(TSpanContext& context) {
+    const std::vector<uint32_t> order = coherentOrder(context.ShadowRays);
+    std::vector<TRay> rays(context.ShadowRays.size());
+    std::vector<double> maxs(context.ShadowMaxs.size());
+    std::vector<size_t> pixels(context.ShadowPixels.size());
+    for (size_t k = 0; k < order.size(); k++) {
+        rays[k] = context.ShadowRays[order[k]];
+        maxs[k] = context.ShadowMaxs[order[k]];
+        pixels[k] = context.ShadowPixels[order[k]];
+    }
+    std::swap(context.ShadowRays, rays);
+    std::swap(context.ShadowMaxs, maxs);
+    std::swap(context.ShadowPixels, pixels);
+}
+
+} // namespace NRayTracingLib
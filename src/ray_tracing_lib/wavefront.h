@@ -0,0 +1,44 @@
+#pragma once
+
+#include "common.h"
+#include "figure.h"
+#include "light.h"
+#include "ray_batch.h"
+
+#include <functional>
+
+namespace NRayTracingLib {
+
+class TCamera;
+class TSpanContext;
+
+// traces a picture of a camera stage by stage over queues of the rays of many rows: rays are generated, intersected,
+// shaded and their secondary rays make the queue of the next round
+class TWavefrontRenderer {
+  public:
+    // hits of a batch of rays and the figures hit
+    using TIntersectFunc = std::function<void(const TRayBatch& rays, std::span<std::optional<THit>> hits,
+                                              std::span<const TFigure*> figures)>;
+    using TOccludedFunc =
+        std::function<void(std::span<const TRay> rays, std::span<const double> tMaxs, std::span<uint8_t> occluded)>;
+
+    void render(TCamera& camera, const TIntersectFunc& intersectFunc, const TOccludedFunc& occludedFunc);
+
+  private:
+    // stage buffers, allocated by the first picture
+    TRayQueue Queue_;
+    TRayQueue NextQueue_;
+    std::vector<std::optional<THit>> QueueHits_;
+    std::vector<const TFigure*> QueueFigures_;
+    std::vector<TColor> QueueColors_;
+    std::vector<TColor> WaveColors_;
+    std::vector<uint8_t> WaveLit_;
+
+    // shades the hits of the queue rays [begin, end)
+    void shadeQueue(TCamera& camera, TSpanContext& context, size_t depth, size_t firstPixel, size_t begin,
+                    size_t end, const TOccludedFunc& occludedFunc);
+    void spawnQueue(TCamera& camera, TSpanContext& context, size_t depth);
+    static void sortShadowRays(TSpanContext& context);
+};
+
+} // namespace NRayTracingLib
@@ -0,0 +1,137 @@
+#include "wide_bvh.h"
+
+namespace NRayTracingLib {
+
+TWideBvhRay::TWideBvhRay(const TPoint& origin, const TVector& direction)
+    : Origin{static_cast<float>(origin.X.Value), static_cast<float>(origin.Y.Value),
+             static_cast<float>(origin.Z.Value)},
+      InverseDirection{static_cast<float>(1.0 / direction.X.Value), static_cast<float>(1.0 / direction.Y.Value),
+                       static_cast<float>(1.0 / direction.Z.Value)} {}
+
+TBoundingBox TWideBvhNode::childBox(size_t child) const {
+    std::array<double, 3> min;
+    std::array<double, 3> max;
+    for (size_t axis = 0; axis < 3; axis++) {
+        min[axis] = Origin[axis] + QuantizedMin[axis][child] * scale(axis);
+        max[axis] = Origin[axis] + QuantizedMax[axis][child] * scale(axis);
+    }
+    return TBoundingBox{TPoint{min[0], min[1], min[2]}, TPoint{max[0], max[1], max[2]}};
+}
+
+// smallest power of two exponent whose 255 steps cover the extent, kept inside normal floats
+static int8_t quantizationExponent(double extent) {
+    if (extent <= 0.0) {
+        return -100;
+    }
+    int exponent = static_cast<int>(std::ceil(std::log2(extent / 255.0)));
+    // log2 of the ratio may be rounded down
+    while (std::ldexp(255.0, exponent) < extent) {
+        exponent++;
+    }
+    return static_cast<int8_t>(std::clamp(exponent, -100, 100));
+}
+
+static void quantizeChildren(TWideBvhNode& node, const std::array<TBvhNode, WIDE_BVH_WIDTH>& children,
+                             size_t childrenCount) {
+    for (size_t axis = 0; axis < 3; axis++) {
+        double min = INF;
+        double max = -INF;
+        for (size_t child = 0; child < childrenCount; child++) {
+            min = std::min(min, children[child].Min[axis]);
+            max = std::max(max, children[child].Max[axis]);
+        }
+
+        // origin is rounded down to float, so every child lies above it
+        float origin = static_cast<float>(min);
+        if (origin > min) {
+            origin = std::nextafter(origin, -std::numeric_limits<float>::infinity());
+        }
+        node.Origin[axis] = origin;
+        node.Exponent[axis] = quantizationExponent(max - origin);
+        const double step = node.scale(axis);
+
+        for (size_t child = 0; child < WIDE_BVH_WIDTH; child++) {
+            if (child >= childrenCount) {
+                node.QuantizedMin[axis][child] = 0;
+                node.QuantizedMax[axis][child] = 0;
+                continue;
+            }
+            const double low = std::floor((children[child].Min[axis] - origin) / step);
+            const double high = std::ceil((children[child].Max[axis] - origin) / step);
+            node.QuantizedMin[axis][child] = static_cast<uint8_t>(std::clamp(low, 0.0, 255.0));
+            node.QuantizedMax[axis][child] = static_cast<uint8_t>(std::clamp(high, 0.0, 255.0));
+        }
+    }
+}
+
+TWideBvh::TWideBvh() {}
+TWideBvh::TWideBvh(const TBvh& bvh) : Primitives_(bvh.getPrimitives()) {
+    const std::vector<TBvhNode>& binaryNodes = bvh.getNodes();
+    if (binaryNodes.empty()) {
+        return;
+    }
+    Nodes_.reserve(binaryNodes.size() / 2 + 1);
+    collapse(binaryNodes, 0);
+}
+
+uint32_t TWideBvh::collapse(const std::vector<TBvhNode>& binaryNodes, uint32_t binaryNodeIdx) {
+    // open the largest inner child until there are four children, a leaf root stays the only child
+    std::array<uint32_t, WIDE_BVH_WIDTH> children = {binaryNodeIdx};
+    size_t childrenCount = 1;
+    while (childrenCount < WIDE_BVH_WIDTH) {
+        size_t largest = WIDE_BVH_WIDTH;
+        double largestArea = -1.0;
+        for (size_t child = 0; child < childrenCount; child++) {
+            const TBvhNode& node = binaryNodes[children[child]];
+            const double area = node.isLeaf() ? -1.0 : node.box().surfaceArea().Value;
+            if (!node.isLeaf() && area > largestArea) {
+                largest = child;
+                largestArea = area;
+            }
+        }
+        if (largest == WIDE_BVH_WIDTH) {
+            break;
+        }
+        const uint32_t opened = binaryNodes[children[largest]].First;
+        children[largest] = opened;
+        children[childrenCount++] = opened + 1;
+    }
+
+    const uint32_t nodeIdx = static_cast<uint32_t>(Nodes_.size());
+    Nodes_.emplace_back();
+
+    std::array<TBvhNode, WIDE_BVH_WIDTH> childNodes;
+    std::array<uint8_t, WIDE_BVH_WIDTH> childCounts;
+    std::array<uint32_t, WIDE_BVH_WIDTH> childIndices;
+    childCounts.fill(TWideBvhNode::EMPTY_CHILD);
+    childIndices.fill(0);
+    for (size_t child = 0; child < childrenCount; child++) {
+        const TBvhNode& binaryChild = binaryNodes[children[child]];
+        childNodes[child] = binaryChild;
+        if (binaryChild.isLeaf()) {
+            if (binaryChild.Count >= TWideBvhNode::EMPTY_CHILD) {
+                throw std::runtime_error("Error: BVH leaf is too large for wide node");
+            }
+            childCounts[child] = static_cast<uint8_t>(binaryChild.Count);
+            childIndices[child] = binaryChild.First;
+        } else {
+            childCounts[child] = 0;
+            // emplacing descendants may move Nodes_, so the node is filled after the recursion
+            childIndices[child] = collapse(binaryNodes, children[child]);
+        }
+    }
+
+    TWideBvhNode& node = Nodes_[nodeIdx];
+    node.ChildCount = childCounts;
+    node.Child = childIndices;
+    quantizeChildren(node, childNodes, childrenCount);
+    return nodeIdx;
+}
+
+const std::vector<TWideBvhNode>& TWideBvh::getNodes() const { return Nodes_; }
+const std::vector<uint32_t>& TWideBvh::getPrimitives() const { return Primitives_; }
+size_t TWideBvh::getMemorySize() const {
+    return Nodes_.size() * sizeof(TWideBvhNode) + Primitives_.size() * sizeof(uint32_t);
+}
+
+} // namespace NRayTracingLib
@@ -0,0 +1,206 @@
+#pragma once
+
+#include "bvh.h"
+#include "common.h"
+
+#include <array>
+#include <bit>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define RAY_TRACING_LIB_SSE
+#include <emmintrin.h>
+#endif
+
+namespace NRayTracingLib {
+
+static constexpr size_t WIDE_BVH_WIDTH = 4;
+// decoded bounds and the ray origin are rounded to float, so bounds are padded by an ulp of both of them
+static constexpr float WIDE_BVH_BOUNDS_PAD = std::numeric_limits<float>::epsilon();
+// slab distances and the narrowed interval are padded by 1 + 2 gamma(3) rounded up, gamma(n) = n u / (1 - n u)
+static constexpr float WIDE_BVH_DISTANCE_PAD = 4.0f * std::numeric_limits<float>::epsilon();
+
+// ray prepared for wide node tests in single precision
+class TWideBvhRay {
+  public:
+    std::array<float, 3> Origin;
+    std::array<float, 3> InverseDirection;
+
+    explicit TWideBvhRay(const TPoint& origin, const TVector& direction);
+};
+
+// node of four children fitting one cache line: child boxes are stored as 8-bit offsets on a grid
+// of power of two steps from the node origin, rounded outwards so that decoded boxes contain the exact ones
+class alignas(64) TWideBvhNode {
+  public:
+    static constexpr uint8_t EMPTY_CHILD = 0xff;
+
+    std::array<float, 3> Origin;
+    std::array<int8_t, 3> Exponent;
+    // 0 for inner children, primitives count for leaves, EMPTY_CHILD for unused slots
+    std::array<uint8_t, WIDE_BVH_WIDTH> ChildCount;
+    // [axis][child] grid offsets of child boxes
+    std::array<std::array<uint8_t, WIDE_BVH_WIDTH>, 3> QuantizedMin;
+    std::array<std::array<uint8_t, WIDE_BVH_WIDTH>, 3> QuantizedMax;
+    // node index for inner children, first primitive in the primitives order for leaves
+    std::array<uint32_t, WIDE_BVH_WIDTH> Child;
+
+    float scale(size_t axis) const { return std::bit_cast<float>(static_cast<uint32_t>(127 + Exponent[axis]) << 23); }
+    TBoundingBox childBox(size_t child) const;
+
+    // bit mask of children whose boxes the ray crosses in [tMin, tMax], entries are set for these children; the test
+    // is conservative, so no box crossed in double precision is missed
+    uint32_t intersectChildren(const TWideBvhRay& ray, float tMin, float tMax,
+                               std::array<float, WIDE_BVH_WIDTH>& entries) const {
+#ifdef RAY_TRACING_LIB_SSE
+        return intersectChildrenSse(ray, tMin, tMax, entries);
+#else
+        return intersectChildrenScalar(ray, tMin, tMax, entries);
+#endif
+    }
+
+    uint32_t intersectChildrenScalar(const TWideBvhRay& ray, float tMin, float tMax,
+                                     std::array<float, WIDE_BVH_WIDTH>& entries) const {
+        uint32_t mask = 0;
+        for (size_t child = 0; child < WIDE_BVH_WIDTH; child++) {
+            float tNear = tMin;
+            float tFar = tMax;
+            for (size_t axis = 0; axis < 3; axis++) {
+                float min = Origin[axis] + QuantizedMin[axis][child] * scale(axis);
+                float max = Origin[axis] + QuantizedMax[axis][child] * scale(axis);
+                min -= (std::abs(min) + std::abs(ray.Origin[axis])) * WIDE_BVH_BOUNDS_PAD;
+                max += (std::abs(max) + std::abs(ray.Origin[axis])) * WIDE_BVH_BOUNDS_PAD;
+                const float t1 = (min - ray.Origin[axis]) * ray.InverseDirection[axis];
+                const float t2 = (max - ray.Origin[axis]) * ray.InverseDirection[axis];
+                // NaN of a zero direction coordinate on a slab border keeps the interval, like the SSE version
+                tNear = std::max(tNear, std::min(t2, t1));
+                tFar = std::min(tFar, std::max(t2, t1));
+            }
+            tNear -= std::abs(tNear) * WIDE_BVH_DISTANCE_PAD;
+            tFar += std::abs(tFar) * WIDE_BVH_DISTANCE_PAD;
+            entries[child] = tNear;
+            if (ChildCount[child] != EMPTY_CHILD && tNear <= tFar) {
+                mask |= 1u << child;
+            }
+        }
+        return mask;
+    }
+
+#ifdef RAY_TRACING_LIB_SSE
+    uint32_t intersectChildrenSse(const TWideBvhRay& ray, float tMin, float tMax,
+                                  std::array<float, WIDE_BVH_WIDTH>& entries) const {
+        __m128 tNear = _mm_set1_ps(tMin);
+        __m128 tFar = _mm_set1_ps(tMax);
+        const __m128 boundsPad = _mm_set1_ps(WIDE_BVH_BOUNDS_PAD);
+        const __m128 distancePad = _mm_set1_ps(WIDE_BVH_DISTANCE_PAD);
+        for (size_t axis = 0; axis < 3; axis++) {
+            const __m128 origin = _mm_set1_ps(Origin[axis]);
+            const __m128 step = _mm_set1_ps(scale(axis));
+            const __m128 rayOrigin = _mm_set1_ps(ray.Origin[axis]);
+            const __m128 inverseDirection = _mm_set1_ps(ray.InverseDirection[axis]);
+            const __m128 rayOriginAbs = abs(rayOrigin);
+            __m128 min = _mm_add_ps(origin, _mm_mul_ps(unpack(QuantizedMin[axis]), step));
+            __m128 max = _mm_add_ps(origin, _mm_mul_ps(unpack(QuantizedMax[axis]), step));
+            min = _mm_sub_ps(min, _mm_mul_ps(_mm_add_ps(abs(min), rayOriginAbs), boundsPad));
+            max = _mm_add_ps(max, _mm_mul_ps(_mm_add_ps(abs(max), rayOriginAbs), boundsPad));
+            const __m128 t1 = _mm_mul_ps(_mm_sub_ps(min, rayOrigin), inverseDirection);
+            const __m128 t2 = _mm_mul_ps(_mm_sub_ps(max, rayOrigin), inverseDirection);
+            // min and max return the second operand for NaN, so a NaN slab keeps the current interval
+            tNear = _mm_max_ps(_mm_min_ps(t1, t2), tNear);
+            tFar = _mm_min_ps(_mm_max_ps(t1, t2), tFar);
+        }
+        tNear = _mm_sub_ps(tNear, _mm_mul_ps(abs(tNear), distancePad));
+        tFar = _mm_add_ps(tFar, _mm_mul_ps(abs(tFar), distancePad));
+        _mm_storeu_ps(entries.data(), tNear);
+        const uint32_t hit = static_cast<uint32_t>(_mm_movemask_ps(_mm_cmple_ps(tNear, tFar)));
+        uint32_t valid = 0;
+        for (size_t child = 0; child < WIDE_BVH_WIDTH; child++) {
+            valid |= static_cast<uint32_t>(ChildCount[child] != EMPTY_CHILD) << child;
+        }
+        return hit & valid;
+    }
+
+  private:
+    static __m128 abs(__m128 values) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), values); }
+    static __m128 unpack(const std::array<uint8_t, WIDE_BVH_WIDTH>& bytes) {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i packed = _mm_cvtsi32_si128(std::bit_cast<int32_t>(bytes));
+        return _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(packed, zero), zero));
+    }
+#endif
+};
+
+static_assert(sizeof(TWideBvhNode) == 64);
+
+// inner node index with zero count or leaf primitives range
+class TWideBvhChild {
+  public:
+    uint32_t Index;
+    uint32_t Count;
+};
+
+// four-wide BVH with quantized child boxes collapsed from a binary one: about a third of the binary nodes,
+// each one a single cache line with the boxes of all its children tested at once
+class TWideBvh {
+  public:
+    TWideBvh();
+    explicit TWideBvh(const TBvh& bvh);
+
+    const std::vector<TWideBvhNode>& getNodes() const;
+    const std::vector<uint32_t>& getPrimitives() const;
+    size_t getMemorySize() const;
+
+    // the same contract as TBvh::traverse
+    template <typename TVisitor>
+    void traverse(const TPoint& origin, const TVector& direction, double tMin, double tMax,
+                  TVisitor&& visitor) const {
+        if (Nodes_.empty()) {
+            return;
+        }
+        const TWideBvhRay ray{origin, direction};
+        // leaf children are pushed too, so that primitives are visited in the order of their boxes
+        std::array<TBvhStackEntry<TWideBvhChild>, (WIDE_BVH_WIDTH - 1) * BVH_MAX_DEPTH + 1> stack;
+        size_t stackSize = 0;
+        stack[stackSize++] = {TWideBvhChild{0, 0}, tMin};
+        while (stackSize > 0) {
+            const TBvhStackEntry<TWideBvhChild> current = stack[--stackSize];
+            if (current.Entry > tMax) {
+                continue;
+            }
+            if (current.Node.Count > 0) {
+                for (uint32_t i = current.Node.Index; i < current.Node.Index + current.Node.Count; i++) {
+                    if (visitBvhPrimitive(visitor, Primitives_[i], tMin, tMax)) {
+                        return;
+                    }
+                }
+                continue;
+            }
+
+            const TWideBvhNode& node = Nodes_[current.Node.Index];
+            std::array<float, WIDE_BVH_WIDTH> entries;
+            uint32_t mask = node.intersectChildren(ray, static_cast<float>(tMin), static_cast<float>(tMax), entries);
+            // farthest children are pushed first, so the nearest one is on top of the stack
+            const size_t stackStart = stackSize;
+            while (mask != 0) {
+                const uint32_t child = static_cast<uint32_t>(std::countr_zero(mask));
+                mask &= mask - 1;
+                TBvhStackEntry<TWideBvhChild> entry{TWideBvhChild{node.Child[child], node.ChildCount[child]},
+                                                    entries[child]};
+                size_t position = stackSize++;
+                while (position > stackStart && stack[position - 1].Entry < entry.Entry) {
+                    stack[position] = stack[position - 1];
+                    position--;
+                }
+                stack[position] = entry;
+            }
+        }
+    }
+
+  private:
+    std::vector<TWideBvhNode> Nodes_;
+    std::vector<uint32_t> Primitives_;
+
+    // builds the wide node replacing the binary inner node and its descendants up to four levels down
+    uint32_t collapse(const std::vector<TBvhNode>& binaryNodes, uint32_t binaryNodeIdx);
+};
+
+} // namespace NRayTracingLib
@@ -0,0 +1,103 @@
+#include "../ray_tracing_lib/all.h"
+
+#include <gtest/gtest.h>
+
+using namespace NRayTracingLib;
+
+//=== TBoundingBox Tests ===
+
+TEST(TBoundingBox, DefaultIsEmpty) {
+    const TBoundingBox box;
+    EXPECT_TRUE(box.isEmpty());
+    EXPECT_EQ(box.surfaceArea(), 0.0);
+    EXPECT_FALSE(box.intersects(TPoint{0, 0, 0}, TVector{1, 0, 0}, -INF, INF));
+}
+
+TEST(TBoundingBox, ExtendByPoints) {
+    TBoundingBox box;
+    box.extend(TPoint{1, -2, 3});
+    box.extend(TPoint{-1, 2, 0});
+    EXPECT_FALSE(box.isEmpty());
+    EXPECT_EQ(box.Min, (TPoint{-1, -2, 0}));
+    EXPECT_EQ(box.Max, (TPoint{1, 2, 3}));
+    EXPECT_EQ(box.center(), (TPoint{0, 0, 1.5}));
+    EXPECT_EQ(box.surfaceArea(), 2.0 * (2 * 4 + 4 * 3 + 3 * 2));
+}
+
+TEST(TBoundingBox, ExtendByBox) {
+    TBoundingBox box{TPoint{0, 0, 0}, TPoint{1, 1, 1}};
+    box.extend(TBoundingBox{TPoint{2, 2, 2}, TPoint{3, 3, 3}});
+    box.extend(TBoundingBox{});
+    EXPECT_EQ(box.Min, (TPoint{0, 0, 0}));
+    EXPECT_EQ(box.Max, (TPoint{3, 3, 3}));
+}
+
+TEST(TBoundingBox, SlabTest) {
+    const TBoundingBox box{TPoint{0, 0, 0}, TPoint{1, 1, 1}};
+    EXPECT_TRUE(box.intersects(TPoint{0.5, 0.5, -1}, TVector{0, 0, 1}, 0.0, INF));
+    EXPECT_FALSE(box.intersects(TPoint{0.5, 0.5, -1}, TVector{0, 0, -1}, 0.0, INF));
+    EXPECT_TRUE(box.intersects(TPoint{0.5, 0.5, -1}, TVector{0, 0, -1}, -INF, INF));
+    EXPECT_FALSE(box.intersects(TPoint{0.5, 0.5, -1}, TVector{0, 0, 1}, 0.0, 0.5));
+    EXPECT_FALSE(box.intersects(TPoint{2, 0.5, -1}, TVector{0, 0, 1}, 0.0, INF));
+    EXPECT_TRUE(box.intersects(TPoint{-1, -1, -1}, TVector{1, 1, 1}, 0.0, INF));
+    EXPECT_TRUE(box.intersects(TPoint{0.5, 0.5, 0.5}, TVector{3, -1, 2}, 0.0, INF));
+}
+
+TEST(TBoundingBox, InfiniteBoxIsHitByEveryLine) {
+    const TBoundingBox box = TBoundingBox::infinite();
+    EXPECT_TRUE(box.isInfinite());
+    EXPECT_TRUE(box.intersects(TPoint{1e6, -1e6, 5}, TVector{0, 1, 0}, 0.0, INF));
+}
+
+//=== TBoundingSphere Tests ===
+
+TEST(TBoundingSphere, NegativeRadiusThrows) { EXPECT_THROW(TBoundingSphere(TPoint{}, -1.0), std::runtime_error); }
+
+TEST(TBoundingSphere, SegmentTest) {
+    const TBoundingSphere sphere{TPoint{0, 0, 0}, 1.0};
+    EXPECT_TRUE(sphere.intersects(TPoint{0.5, 0, -5}, TVector{0, 0, 1}, 0.0, INF));
+    EXPECT_FALSE(sphere.intersects(TPoint{1.5, 0, -5}, TVector{0, 0, 1}, 0.0, INF));
+    EXPECT_FALSE(sphere.intersects(TPoint{0.5, 0, -5}, TVector{0, 0, 1}, 0.0, 3.0));
+    EXPECT_FALSE(sphere.intersects(TPoint{0.5, 0, -5}, TVector{0, 0, -1}, 0.0, INF));
+    EXPECT_TRUE(sphere.intersects(TPoint{0, 0, 0}, TVector{0, 0, -1}, 0.0, INF));
+}
+
+//=== TBounds Tests ===
+
+TEST(TBounds, PolygonBoundsContainItsPoints) {
+    const TPolygon triangle{{TPoint{0, 0, 0}, TPoint{2, 0, 0}, TPoint{0, 2, 1}}};
+    const TBounds bounds = triangle.bounds();
+    for (const auto& point : triangle.getPoints()) {
+        EXPECT_LE(bounds.Box.Min.X, point.X);
+        EXPECT_GE(bounds.Box.Max.Z, point.Z);
+        EXPECT_LE(bounds.Sphere.Center.distToPoint(point), bounds.Sphere.Radius);
+    }
+}
+
+TEST(TBounds, PolyhedronBounds) {
+    const TPolyhedron hexahedron = createRegularHexahedron(TPoint{10, 0, 0}, 2.0);
+    const TBounds bounds = hexahedron.bounds();
+    EXPECT_EQ(bounds.Box.center(), (TPoint{10, 0, 0}));
+    EXPECT_EQ(bounds.Sphere.Center, (TPoint{10, 0, 0}));
+    EXPECT_GE(bounds.Sphere.Radius, std::sqrt(3.0));
+    EXPECT_LE(bounds.Sphere.Radius, std::sqrt(3.0) + 0.01);
+}
+
+TEST(TBounds, PlaneAndFigureSetBounds) {
+    const TPlane plane{TPoint{0, 0, 0}, TVector{0, 0, 1}};
+    EXPECT_TRUE(plane.bounds().Box.isInfinite());
+
+    TFigureSet figures;
+    figures.add(createRegularHexahedron(TPoint{0, 0, 0}, 2.0));
+    figures.add(createRegularHexahedron(TPoint{5, 0, 0}, 2.0));
+    EXPECT_EQ(figures.bounds().Box.center().X, 2.5);
+    figures.add(plane);
+    EXPECT_TRUE(figures.bounds().Box.isInfinite());
+}
+
+TEST(TBounds, MissedPolyhedronIsRejected) {
+    const TPolyhedron dodecahedron = createRegularDodecahedron(TPoint{0, 0, 0}, 1.0);
+    const TRay miss{TPoint{5, 5, 5}, TVector{1, 0, 0}};
+    EXPECT_FALSE(dodecahedron.bounds().Sphere.intersects(miss.Point, miss.Vector, 0.0, INF));
+    EXPECT_FALSE(dodecahedron.hit(miss, 0.0, INF).has_value());
+}
@@ -0,0 +1,406 @@
+#include "../ray_tracing_lib/all.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+using namespace NRayTracingLib;
+
+namespace {
+
+std::vector<TPolygon> randomTriangles(size_t count) {
+    std::mt19937 generator{7};
+    std::uniform_real_distribution<double> coordinate{-10.0, 10.0};
+    std::uniform_real_distribution<double> offset{-0.5, 0.5};
+    std::vector<TPolygon> triangles;
+    while (triangles.size() < count) {
+        const TPoint center{coordinate(generator), coordinate(generator), coordinate(generator)};
+        try {
+            triangles.emplace_back(std::unordered_set<TPoint>{
+                center + TVector{offset(generator), offset(generator), offset(generator)},
+                center + TVector{offset(generator), offset(generator), offset(generator)},
+                center + TVector{offset(generator), offset(generator), offset(generator)},
+            });
+        } catch (const std::runtime_error&) {
+            // degenerate triangle, take another one
+        }
+    }
+    return triangles;
+}
+
+std::vector<TBoundingBox> polygonBoxes(const std::vector<TPolygon>& polygons) {
+    std::vector<TBoundingBox> boxes;
+    for (const auto& polygon : polygons) {
+        boxes.push_back(polygon.bounds().Box);
+    }
+    return boxes;
+}
+
+std::optional<THit> bruteForceHit(const std::vector<TPolygon>& polygons, const TRay& ray) {
+    std::optional<THit> nearest;
+    for (const auto& polygon : polygons) {
+        std::optional<THit> hit = polygon.rayHit(ray.Point, ray.Vector, 0.0, INF);
+        if (hit != std::nullopt && (nearest == std::nullopt || hit.value().T.Value < nearest.value().T.Value)) {
+            nearest = hit;
+        }
+    }
+    return nearest;
+}
+
+// vertices of the mesh stretched by scale away from the origin and then shifted
+std::vector<TPoint> movedVertices(const TMesh& mesh, const TVector& shift, double scale = 1.0) {
+    std::vector<TPoint> vertices = mesh.getVertices();
+    for (auto& vertex : vertices) {
+        vertex = TPoint{(vertex - TPoint{}) * scale} + shift;
+    }
+    return vertices;
+}
+
+bool contains(const TBvhNode& node, const TBoundingBox& box) {
+    const std::array<double, 3> mins = {box.Min.X.Value, box.Min.Y.Value, box.Min.Z.Value};
+    const std::array<double, 3> maxs = {box.Max.X.Value, box.Max.Y.Value, box.Max.Z.Value};
+    for (size_t axis = 0; axis < 3; axis++) {
+        if (node.Min[axis] > mins[axis] || node.Max[axis] < maxs[axis]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void expectMatchesBruteForce(const TMesh& mesh) {
+    std::mt19937 generator{42};
+    std::uniform_real_distribution<double> coordinate{-12.0, 12.0};
+    for (size_t i = 0; i < 300; i++) {
+        const TRay ray{TPoint{coordinate(generator), coordinate(generator), coordinate(generator)},
+                       TVector{coordinate(generator), coordinate(generator), coordinate(generator)}};
+        const std::optional<THit> expected = bruteForceHit(mesh.getPolygons(), ray);
+        const std::optional<THit> actual = mesh.hit(ray, 0.0, INF);
+        ASSERT_EQ(actual.has_value(), expected.has_value());
+        if (expected.has_value()) {
+            EXPECT_EQ(actual.value().T, expected.value().T);
+        }
+    }
+}
+
+} // namespace
+
+//=== TBvh Tests ===
+
+TEST(TBvh, EmptyBvhHasNoNodes) {
+    const TBvh bvh{{}};
+    EXPECT_TRUE(bvh.getNodes().empty());
+    EXPECT_TRUE(bvh.bounds().isEmpty());
+    size_t visited = 0;
+    bvh.traverse(TPoint{0, 0, 0}, TVector{1, 0, 0}, 0.0, INF, [&](uint32_t, double&, double&) { visited++; });
+    EXPECT_EQ(visited, 0u);
+}
+
+TEST(TBvh, EveryPrimitiveIsInOneLeaf) {
+    const TBvh bvh{polygonBoxes(randomTriangles(1000))};
+
+    std::vector<uint32_t> primitives = bvh.getPrimitives();
+    std::sort(primitives.begin(), primitives.end());
+    for (size_t i = 0; i < primitives.size(); i++) {
+        ASSERT_EQ(primitives[i], i);
+    }
+
+    size_t inLeaves = 0;
+    for (const auto& node : bvh.getNodes()) {
+        inLeaves += node.Count;
+    }
+    EXPECT_EQ(inLeaves, 1000u);
+}
+
+TEST(TBvh, NodesContainTheirChildren) {
+    const std::vector<TBoundingBox> boxes = polygonBoxes(randomTriangles(1000));
+    const TBvh bvh{boxes};
+    const std::vector<TBvhNode>& nodes = bvh.getNodes();
+
+    for (const auto& node : nodes) {
+        std::vector<TBoundingBox> children;
+        if (node.isLeaf()) {
+            for (uint32_t i = node.First; i < node.First + node.Count; i++) {
+                children.push_back(boxes[bvh.getPrimitives()[i]]);
+            }
+        } else {
+            children = {nodes[node.First].box(), nodes[node.First + 1].box()};
+        }
+        for (const auto& child : children) {
+            EXPECT_TRUE(contains(node, child));
+        }
+    }
+}
+
+TEST(TBvh, StatsDescribeTree) {
+    const TBvh bvh{polygonBoxes(randomTriangles(1000))};
+    const TBvhStats& stats = bvh.getStats();
+
+    EXPECT_EQ(stats.NodesCount, bvh.getNodes().size());
+    EXPECT_EQ(stats.NodesCount, 2 * stats.LeavesCount - 1);
+    EXPECT_GE(stats.MinLeafSize, 1u);
+    EXPECT_GE(stats.MaxLeafSize, stats.MinLeafSize);
+    EXPECT_DOUBLE_EQ(stats.AverageLeafSize, 1000.0 / stats.LeavesCount);
+    EXPECT_LE(stats.Depth, BVH_MAX_DEPTH);
+    EXPECT_GT(stats.SahCost, 0.0);
+    // a good tree is far cheaper than testing every primitive
+    EXPECT_LT(stats.SahCost, 2.0 * 1000 / 10);
+}
+
+TEST(TBvh, ParallelBuildGivesSameTree) {
+    const std::vector<TBoundingBox> boxes = polygonBoxes(randomTriangles(5000));
+    const TBvh single{boxes, 1};
+    const TBvh parallel{boxes, 8};
+
+    EXPECT_EQ(single.getStats().NodesCount, parallel.getStats().NodesCount);
+    EXPECT_DOUBLE_EQ(single.getStats().SahCost, parallel.getStats().SahCost);
+    EXPECT_EQ(single.getPrimitives(), parallel.getPrimitives());
+}
+
+TEST(TBvh, TraversalVisitsNearerLeavesFirst) {
+    std::vector<TBoundingBox> row;
+    for (int x = 0; x < 64; x++) {
+        row.emplace_back(TPoint{x - 0.25, -0.25, -0.25}, TPoint{x + 0.25, 0.25, 0.25});
+    }
+    const TBvh bvh{row};
+
+    for (const double sign : {1.0, -1.0}) {
+        std::vector<uint32_t> visited;
+        bvh.traverse(TPoint{31.5 - sign * 100, 0, 0}, TVector{sign, 0, 0}, 0.0, INF,
+                     [&](uint32_t primitive, double&, double&) { visited.push_back(primitive); });
+        ASSERT_EQ(visited.size(), row.size());
+        for (size_t i = 1; i < visited.size(); i++) {
+            EXPECT_GT(sign * visited[i], sign * visited[i - 1]);
+        }
+    }
+}
+
+TEST(TBvh, ShrinkingIntervalSkipsFartherNodes) {
+    std::vector<TBoundingBox> row;
+    for (int x = 0; x < 64; x++) {
+        row.emplace_back(TPoint{x - 0.25, -0.25, -0.25}, TPoint{x + 0.25, 0.25, 0.25});
+    }
+    const TBvh bvh{row};
+
+    size_t visited = 0;
+    bvh.traverse(TPoint{-10, 0, 0}, TVector{1, 0, 0}, 0.0, INF, [&](uint32_t primitive, double&, double& tMax) {
+        visited++;
+        tMax = std::min(tMax, 10.0 + primitive);
+    });
+    EXPECT_EQ(visited, 1u);
+}
+
+TEST(TBvh, VisitorCanStopTraversal) {
+    const TBvh bvh{polygonBoxes(randomTriangles(1000))};
+    size_t visited = 0;
+    bvh.traverse(TPoint{-20, 0, 0}, TVector{1, 0.01, 0.02}, 0.0, INF, [&](uint32_t, double&, double&) {
+        visited++;
+        return true;
+    });
+    EXPECT_EQ(visited, 1u);
+}
+
+TEST(TBvh, QueryTakesOverlappingPrimitives) {
+    const std::vector<TBoundingBox> boxes = polygonBoxes(randomTriangles(3000));
+    const TBvh bvh{boxes};
+    // half-space x < 0
+    size_t callsCount = 0;
+    const std::vector<uint32_t> found = bvh.query([&](const TBoundingBox& box) {
+        callsCount++;
+        if (box.Min.X >= 0.0) {
+            return TBoxOverlap::Outside;
+        }
+        return box.Max.X < 0.0 ? TBoxOverlap::Inside : TBoxOverlap::Partial;
+    });
+
+    const std::unordered_set<uint32_t> foundSet(found.begin(), found.end());
+    EXPECT_EQ(foundSet.size(), found.size());
+    for (size_t i = 0; i < boxes.size(); i++) {
+        if (boxes[i].Min.X < 0.0) {
+            EXPECT_TRUE(foundSet.contains(static_cast<uint32_t>(i)));
+        }
+    }
+    EXPECT_LT(found.size(), boxes.size());
+    // subtrees inside the half-space are not queried
+    EXPECT_LT(callsCount, bvh.getNodes().size() / 2);
+}
+
+TEST(TBvh, RefitFollowsMovedPrimitives) {
+    std::vector<TBoundingBox> boxes = polygonBoxes(randomTriangles(3000));
+    TBvh bvh{boxes};
+    const double builtCost = bvh.getStats().SahCost;
+
+    for (auto& box : boxes) {
+        box = TBoundingBox{box.Min + TVector{100, 0, 0}, box.Max + TVector{100, 0, 0}};
+    }
+    EXPECT_FALSE(bvh.update(boxes));
+
+    EXPECT_NEAR(bvh.getStats().SahCost, builtCost, 1e-6 * builtCost);
+    const std::vector<TBvhNode>& nodes = bvh.getNodes();
+    for (const auto& node : nodes) {
+        if (node.isLeaf()) {
+            for (uint32_t i = node.First; i < node.First + node.Count; i++) {
+                EXPECT_TRUE(contains(node, boxes[bvh.getPrimitives()[i]]));
+            }
+        } else {
+            EXPECT_TRUE(contains(node, nodes[node.First].box()));
+            EXPECT_TRUE(contains(node, nodes[node.First + 1].box()));
+        }
+    }
+}
+
+TEST(TBvh, UpdateRebuildsLooseTree) {
+    std::vector<TBoundingBox> boxes = polygonBoxes(randomTriangles(3000));
+    TBvh bvh{boxes};
+
+    // every primitive jumps to the place of another one, so refitted nodes span the whole scene
+    std::reverse(boxes.begin(), boxes.end());
+    bvh.refit(boxes);
+    const double refittedCost = bvh.getStats().SahCost;
+    EXPECT_TRUE(bvh.update(boxes));
+    EXPECT_LT(bvh.getStats().SahCost, refittedCost);
+}
+
+TEST(TBvh, StatsAreKeptAcrossUpdates) {
+    std::vector<TBoundingBox> boxes = polygonBoxes(randomTriangles(3000));
+    TBvh bvh{boxes};
+    EXPECT_EQ(bvh.getStats().RefitsCount, 0u);
+
+    for (auto& box : boxes) {
+        box = TBoundingBox{box.Min + TVector{1, 0, 0}, box.Max + TVector{1, 0, 0}};
+    }
+    EXPECT_FALSE(bvh.update(boxes));
+    EXPECT_FALSE(bvh.update(boxes));
+    std::reverse(boxes.begin(), boxes.end());
+    EXPECT_TRUE(bvh.update(boxes));
+
+    const TBvhStats& stats = bvh.getStats();
+    EXPECT_EQ(stats.RefitsCount, 3u);
+    EXPECT_EQ(stats.RebuildsCount, 1u);
+    EXPECT_GT(stats.NodesCount, 0u);
+}
+
+TEST(TBvh, RefitWithDifferentCountThrows) {
+    TBvh bvh{polygonBoxes(randomTriangles(10))};
+    EXPECT_THROW(bvh.refit(polygonBoxes(randomTriangles(11))), std::runtime_error);
+}
+
+//=== TMesh Tests ===
+
+TEST(TMesh, CreationWithoutPolygonsThrows) { EXPECT_THROW(TMesh{{}}, std::runtime_error); }
+
+TEST(TMesh, MatchesBruteForce) { expectMatchesBruteForce(TMesh{randomTriangles(2000)}); }
+
+TEST(TMesh, BinaryLayoutMatchesBruteForce) {
+    const TMesh mesh{randomTriangles(2000), threadPool().getThreadsCount(), TBvhLayout::Binary};
+    EXPECT_TRUE(mesh.getWideBvh().getNodes().empty());
+    expectMatchesBruteForce(mesh);
+}
+
+TEST(TMesh, SingleThreadBuildMatchesBruteForce) { expectMatchesBruteForce(TMesh{randomTriangles(2000), 1}); }
+
+TEST(TMesh, HitReportsPolygonIndexAndInterval) {
+    const TPolyhedron cube = createRegularHexahedron(TPoint{0, 0, 0}, 2.0);
+    const TMesh mesh{cube.getFaces()};
+
+    const TRay ray{TPoint{0.2, 0.3, 10}, TVector{0, 0, -1}};
+    const std::optional<THit> hit = mesh.hit(ray, 0.0, INF);
+    ASSERT_TRUE(hit.has_value());
+    EXPECT_EQ(hit.value().T, 9.0);
+    EXPECT_TRUE(mesh.getPolygons()[hit.value().FaceIndex].rayHit(ray.Point, ray.Vector, 0.0, INF).has_value());
+
+    EXPECT_FALSE(mesh.hit(ray, 0.0, 8.0).has_value());
+    const std::optional<THit> farHit = mesh.hit(ray, 10.0, INF);
+    ASSERT_TRUE(farHit.has_value());
+    EXPECT_EQ(farHit.value().T, 11.0);
+}
+
+TEST(TMesh, LineHitsNearestOnEitherSide) {
+    const TMesh mesh{createRegularHexahedron(TPoint{0, 0, 0}, 2.0).getFaces()};
+    const TLine line{TPoint{0.2, 0.3, -0.75}, TVector{0, 0, 1}};
+
+    const std::optional<THit> hit = mesh.hit(line, line.minParameter(), INF);
+    ASSERT_TRUE(hit.has_value());
+    EXPECT_EQ(hit.value().T, -0.25);
+}
+
+TEST(TMesh, AnyHitAgreesWithHit) {
+    const std::vector<TPolygon> polygons = randomTriangles(2000);
+    for (const TBvhLayout layout : {TBvhLayout::Binary, TBvhLayout::CompressedWide}) {
+        const TMesh mesh{polygons, threadPool().getThreadsCount(), layout};
+        std::mt19937 generator{21};
+        std::uniform_real_distribution<double> coordinate{-12.0, 12.0};
+        for (size_t i = 0; i < 200; i++) {
+            const TRay ray{TPoint{coordinate(generator), coordinate(generator), coordinate(generator)},
+                           TVector{coordinate(generator), coordinate(generator), coordinate(generator)}};
+            const std::optional<THit> nearest = mesh.hit(ray, 0.0, INF);
+            const std::optional<THit> any = mesh.anyHit(ray, 0.0, INF);
+            ASSERT_EQ(any.has_value(), nearest.has_value());
+            if (any.has_value()) {
+                EXPECT_GE(any.value().T, nearest.value().T);
+                EXPECT_TRUE(mesh.getPolygons()[any.value().FaceIndex]
+                                .rayHit(ray.Point, ray.Vector, 0.0, INF)
+                                .has_value());
+            }
+        }
+    }
+}
+
+TEST(TMesh, PacketOcclusionAgreesWithAnyHit) {
+    const TMesh mesh{randomTriangles(2000)};
+    // shadow rays from a row of points towards one light, as the camera traces them
+    const TPoint light{3.0, -2.0, 15.0};
+    std::vector<TRay> rays;
+    std::vector<double> tMaxs;
+    // several packets
+    for (size_t i = 0; i < 200; i++) {
+        const TPoint point{-12.0 + 0.12 * i, 0.5, -11.0 + 0.1 * i};
+        rays.emplace_back(point, light - point);
+        tMaxs.push_back(i % 4 == 0 ? 0.5 : 1.0);
+    }
+    std::vector<uint8_t> occluded(rays.size(), false);
+    mesh.occluded(rays, tMaxs, occluded);
+
+    size_t occludedCount = 0;
+    for (size_t i = 0; i < rays.size(); i++) {
+        EXPECT_EQ(static_cast<bool>(occluded[i]), mesh.anyHit(rays[i], 0.0, tMaxs[i]).has_value());
+        occludedCount += occluded[i];
+    }
+    EXPECT_GT(occludedCount, 0u);
+    EXPECT_LT(occludedCount, rays.size());
+
+    std::vector<uint8_t> wrongSize(rays.size() + 1, false);
+    EXPECT_THROW(mesh.occluded(rays, tMaxs, wrongSize), std::runtime_error);
+}
+
+TEST(TMesh, UpdateMovesVerticesInPlace) {
+    TMesh mesh{randomTriangles(2000)};
+    std::vector<TVector> normals;
+    for (const auto& polygon : mesh.getPolygons()) {
+        normals.push_back(polygon.getPlane().Normal);
+    }
+
+    const std::vector<TPoint> vertices = movedVertices(mesh, TVector{0.5, -0.25, 0.75});
+    EXPECT_FALSE(mesh.update(vertices));
+    EXPECT_EQ(mesh.getVertices(), vertices);
+    // a shift keeps the winding, so the normals stay on their sides
+    for (size_t i = 0; i < normals.size(); i++) {
+        EXPECT_EQ(mesh.getPolygons()[i].getPlane().Normal, normals[i]);
+    }
+    expectMatchesBruteForce(mesh);
+    EXPECT_EQ(mesh.getBvh().getStats().RefitsCount, 1u);
+}
+
+TEST(TMesh, UpdateDeformsPolygons) {
+    TMesh mesh{randomTriangles(2000)};
+    mesh.update(movedVertices(mesh, TVector{0.0, 1.0, 0.0}, 0.8));
+    expectMatchesBruteForce(mesh);
+    mesh.update(movedVertices(mesh, TVector{-1.0, 0.0, 0.5}, 1.4));
+    expectMatchesBruteForce(mesh);
+}
+
+TEST(TMesh, UpdateWithDifferentCountThrows) {
+    TMesh mesh{randomTriangles(10)};
+    std::vector<TPoint> vertices = mesh.getVertices();
+    vertices.pop_back();
+    EXPECT_THROW(mesh.update(vertices), std::runtime_error);
+}
@@ -0,0 +1,754 @@
+#include "../ray_tracing_lib/all.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <numeric>
+#include <thread>
+
+using namespace NRayTracingLib;
+
+//=== Instrumented allocator ===
+
+static std::atomic<size_t> ALLOCATIONS_COUNT{0};
+
+// every replaced form allocates and frees through this pair, over-aligned blocks included, so new and delete are
+// always matched whatever forms the library and the compiler pick
+static void* countedAllocate(size_t size, size_t alignment) {
+    ALLOCATIONS_COUNT++;
+    // aligned_alloc wants a multiple of the alignment
+    size = (std::max<size_t>(size, 1) + alignment - 1) / alignment * alignment;
+#ifdef _MSC_VER
+    void* ptr = _aligned_malloc(size, alignment);
+#else
+    void* ptr = std::aligned_alloc(alignment, size);
+#endif
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+static void countedFree(void* ptr) noexcept {
+#ifdef _MSC_VER
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+}
+
+void* operator new(size_t size) { return countedAllocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void* operator new(size_t size, std::align_val_t alignment) {
+    return countedAllocate(size, static_cast<size_t>(alignment));
+}
+void operator delete(void* ptr) noexcept { countedFree(ptr); }
+void operator delete(void* ptr, size_t) noexcept { countedFree(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { countedFree(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { countedFree(ptr); }
+
+//=== TCamera Tests ===
+
+static TCamera makeTestCamera(const std::pair<uint16_t, uint16_t>& resolution) {
+    return TCamera{TPoint{10.0, 10.0, 10.0}, TVector{-10.0, -10.0, -10.0}, {TAngle{15.0}, TAngle{15.0}}, resolution};
+}
+
+TEST(TCamera, PolyhedronIntersectionDoesNotAllocate) {
+    const TPolyhedron figure = createRegularDodecahedron(TPoint{0.0, 0.0, 0.0}, 1.0);
+    const TRay ray{TPoint{10.0, 10.0, 10.0}, TVector{-10.0, -10.0, -10.0}};
+
+    const size_t allocationsBefore = ALLOCATIONS_COUNT;
+    const std::optional<std::pair<TPoint, TPointContainment>> intersection = figure.intersection(ray);
+    const size_t allocationsAfter = ALLOCATIONS_COUNT;
+
+    ASSERT_TRUE(intersection.has_value());
+    EXPECT_EQ(allocationsAfter - allocationsBefore, 0u);
+}
+
+TEST(TCamera, MakePictureDoesNotAllocatePerPixel) {
+    const TPolyhedron figure = createRegularDodecahedron(TPoint{0.0, 0.0, 0.0}, 1.0);
+    TCamera camera = makeTestCamera({16, 16});
+
+    const size_t allocationsBefore = ALLOCATIONS_COUNT;
+    camera.makePicture(figure);
+    const size_t allocationsAfter = ALLOCATIONS_COUNT;
+
+    EXPECT_EQ(allocationsAfter - allocationsBefore, 0u);
+}
+
+TEST(TCamera, FrustumMatchesViewAngles) {
+    const TCamera camera = makeTestCamera({16, 16});
+    const TFrustum frustum = camera.getFrustum();
+    EXPECT_TRUE(frustum.containsPoint(TPoint{0.0, 0.0, 0.0}));
+    EXPECT_FALSE(frustum.containsPoint(TPoint{20.0, 20.0, 20.0}));
+    // 15 degrees view from about 17 units away covers only a few units around the center
+    EXPECT_FALSE(frustum.containsPoint(TPoint{5.0, -5.0, 0.0}));
+}
+
+TEST(TCamera, FiguresListPictureMatchesSingleFigure) {
+    const TPolyhedron figure = createRegularDodecahedron(TPoint{0.0, 0.0, 0.0}, 1.0);
+    TCamera single = makeTestCamera({16, 16});
+    single.makePicture(figure);
+    TCamera listed = makeTestCamera({16, 16});
+    listed.makePicture(std::vector<const TFigure*>{&figure});
+
+    EXPECT_EQ(listed.getActiveFiguresCount(), 1u);
+    EXPECT_EQ(listed.getImageData(), single.getImageData());
+}
+
+TEST(TCamera, FiguresOutOfViewAreCulled) {
+    std::vector<TPolyhedron> figures;
+    for (int x = -5; x <= 5; x++) {
+        for (int y = -5; y <= 5; y++) {
+            figures.push_back(createRegularHexahedron(TPoint{3.0 * x, 3.0 * y, 0.0}, 0.5));
+        }
+    }
+    const TPlane floor{TPoint{0.0, 0.0, -1.0}, TVector{0.0, 0.0, 1.0}};
+    std::vector<const TFigure*> scene = {&floor};
+    for (const auto& figure : figures) {
+        scene.push_back(&figure);
+    }
+
+    TCamera camera = makeTestCamera({16, 16});
+    camera.makePicture(scene);
+    // the plane is never culled, the central cube is always seen
+    EXPECT_GE(camera.getActiveFiguresCount(), 2u);
+    EXPECT_LT(camera.getActiveFiguresCount(), scene.size() / 4);
+}
+
+static std::array<uint8_t, 3> centerPixel(const TCamera& camera, size_t width, size_t height) {
+    const size_t idx = ((height / 2) * width + width / 2) * 3;
+    const TImageData& data = camera.getImageData();
+    return {data[idx], data[idx + 1], data[idx + 2]};
+}
+
+TEST(TCamera, LitPictureShadowsFloorUnderCube) {
+    const TPlane floor{TPoint{0.0, 0.0, 0.0}, TVector{0.0, 0.0, 1.0}};
+    const TPolyhedron cube = createRegularHexahedron(TPoint{0.0, 0.0, 1.5}, 0.5);
+    const TPhongMaterial material;
+
+    // the central ray hits the floor at the origin, the cube between the origin and the light is not on its way
+    TCamera lit = makeTestCamera({17, 17});
+    lit.setLights({TLight::point(TPoint{0.0, 0.0, 5.0}, TColor{25.0, 25.0, 25.0})});
+    lit.makePicture(std::vector<const TFigure*>{&floor});
+    TCamera shadowed = makeTestCamera({17, 17});
+    shadowed.setLights({TLight::point(TPoint{0.0, 0.0, 5.0}, TColor{25.0, 25.0, 25.0})});
+    shadowed.makePicture(std::vector<const TFigure*>{&floor, &cube});
+
+    // the light is straight above at distance 5, so 25 / 5^2 reaches the floor, and the highlight is far from the view
+    EXPECT_EQ(centerPixel(lit, 17, 17), (material.Ambient + material.Diffuse).toBytes());
+    EXPECT_EQ(centerPixel(shadowed, 17, 17), material.Ambient.toBytes());
+}
+
+TEST(TCamera, DirectionalLightShadesByAngle) {
+    const TPlane floor{TPoint{0.0, 0.0, 0.0}, TVector{0.0, 0.0, 1.0}};
+    TPhongMaterial material;
+    material.Specular = TColor{};
+
+    TCamera camera = makeTestCamera({17, 17});
+    camera.setMaterial(material);
+    // light falling at 60 degrees to the normal
+    camera.setLights({TLight::directional(TVector{std::sqrt(3.0), 0.0, -1.0}, TColor{1.0, 1.0, 1.0})});
+    camera.makePicture(floor);
+
+    EXPECT_EQ(centerPixel(camera, 17, 17), (material.Ambient + material.Diffuse * 0.5).toBytes());
+}
+
+TEST(TCamera, ShadowRayInFigurePlaneIsTestedByOtherFigures) {
+    // the middle column sees the floor along the plane y = 0, so its shadow rays lie in a face of the box behind
+    // the wall; the box can not occlude them, but the wall still has to
+    const TPlane floor{TPoint{0.0, 0.0, -1.0}, TVector{0.0, 0.0, 1.0}};
+    const TPlane wall{TPoint{2.0, 0.0, 0.0}, TVector{1.0, 0.0, 0.0}};
+    const TPolyhedron box = createRegularHexahedron(TPoint{5.0, 2.0, 4.0}, 4.0);
+    const auto render = [](const std::vector<const TFigure*>& figures) {
+        TCamera camera{TPoint{-10.0, 0.0, 10.0}, TVector{1.0, 0.0, -1.0}, {TAngle{15.0}, TAngle{15.0}}, {21, 21}};
+        camera.setLights({TLight::point(TPoint{10.0, 0.0, 10.0}, TColor{30.0, 30.0, 30.0})});
+        camera.makePicture(figures);
+        return camera.getImageData();
+    };
+    EXPECT_EQ(render({&floor, &wall, &box}), render({&floor, &wall}));
+}
+
+TEST(TCamera, LitMeshPictureMatchesFiguresList) {
+    const TPolyhedron cube = createRegularHexahedron(TPoint{0.0, 0.0, 0.0}, 1.0);
+    const TPolyhedron blocker = createRegularHexahedron(TPoint{2.0, 2.0, 2.0}, 0.5);
+    std::vector<TPolygon> polygons = cube.getFaces();
+    polygons.insert(polygons.end(), blocker.getFaces().begin(), blocker.getFaces().end());
+    const TMesh mesh{polygons};
+    const std::vector<TLight> lights = {TLight::point(TPoint{4.0, 4.0, 4.0}, TColor{20.0, 10.0, 10.0}),
+                                        TLight::directional(TVector{0.0, -1.0, -2.0}, TColor{0.3, 0.3, 0.6})};
+
+    TCamera packets = makeTestCamera({24, 24});
+    packets.setLights(lights);
+    packets.makePicture(mesh);
+    TCamera listed = makeTestCamera({24, 24});
+    listed.setLights(lights);
+    listed.makePicture(std::vector<const TFigure*>{&cube, &blocker});
+
+    EXPECT_EQ(packets.getImageData(), listed.getImageData());
+}
+
+TEST(TCamera, LitPictureDoesNotAllocatePerPixel) {
+    const TPolyhedron figure = createRegularDodecahedron(TPoint{0.0, 0.0, 0.0}, 1.0);
+    TCamera camera = makeTestCamera({16, 16});
+    camera.setLights({TLight::point(TPoint{5.0, 0.0, 5.0}, TColor{30.0, 30.0, 30.0})});
+
+    const size_t allocationsBefore = ALLOCATIONS_COUNT;
+    camera.makePicture(figure);
+    const size_t allocationsAfter = ALLOCATIONS_COUNT;
+
+    EXPECT_EQ(allocationsAfter - allocationsBefore, 0u);
+}
+
+TEST(TCamera, LitMeshPictureDoesNotAllocatePerPixel) {
+    // the mirror reflects the rays hitting it to the block below, which traces their shadow rays one by one
+    std::vector<TPolygon> polygons = createRegularDodecahedron(TPoint{0.0, 0.0, 0.0}, 1.0).getFaces();
+    const std::vector<TPolygon> block = createRegularHexahedron(TPoint{0.0, 0.0, -3.0}, 2.0).getFaces();
+    polygons.insert(polygons.end(), block.begin(), block.end());
+    const TMesh mesh{polygons};
+    TCamera camera = makeTestCamera({16, 16});
+    camera.setLights({TLight::point(TPoint{5.0, 0.0, 5.0}, TColor{30.0, 30.0, 30.0})});
+    camera.setMaterial(TPhongMaterial::mirror());
+
+    const size_t allocationsBefore = ALLOCATIONS_COUNT;
+    camera.makePicture(mesh);
+    const size_t allocationsAfter = ALLOCATIONS_COUNT;
+
+    EXPECT_EQ(allocationsAfter - allocationsBefore, 0u);
+}
+
+static TPhongMaterial flatMaterial(const TColor& ambient, double reflectivity) {
+    TPhongMaterial material;
+    material.Ambient = ambient;
+    material.Diffuse = TColor{};
+    material.Specular = TColor{};
+    material.Reflectivity = reflectivity;
+    return material;
+}
+
+class TMirrorFloorTest : public ::testing::Test {
+  protected:
+    // the central ray hits the floor at the origin and is mirrored towards the red cube
+    const TPlane Floor{TPoint{0.0, 0.0, 0.0}, TVector{0.0, 0.0, 1.0}};
+    const TPolyhedron Cube = createRegularHexahedron(TPoint{-3.0, -3.5, 3.0}, 1.5);
+    TCamera Camera = makeTestCamera({17, 17});
+
+    void SetUp() override {
+        Camera.setLights({TLight::directional(TVector{0.0, 0.0, -1.0}, TColor{1.0, 1.0, 1.0})});
+        Camera.setMaterial(Floor, flatMaterial(TColor{}, 1.0));
+        Camera.setMaterial(Cube, flatMaterial(TColor{1.0, 0.0, 0.0}, 0.0));
+    }
+
+    size_t secondaryRaysCount() const {
+        const std::vector<size_t>& rays = Camera.getRenderStats().RaysPerBounce;
+        return std::accumulate(rays.begin() + 1, rays.end(), size_t{0});
+    }
+};
+
+TEST_F(TMirrorFloorTest, ReflectsCube) {
+    Camera.makePicture(std::vector<const TFigure*>{&Floor, &Cube});
+
+    EXPECT_EQ(centerPixel(Camera, 17, 17), (std::array<uint8_t, 3>{255, 0, 0}));
+    const TRenderStats& stats = Camera.getRenderStats();
+    ASSERT_EQ(stats.RaysPerBounce.size(), TSecondaryRaysOptions{}.MaxDepth + 1);
+    EXPECT_EQ(stats.RaysPerBounce[0], 17u * 17u);
+    EXPECT_GT(stats.RaysPerBounce[1], 0u);
+    // the mirrored rays go up and do not come back to the floor
+    EXPECT_EQ(stats.RaysPerBounce[2], 0u);
+}
+
+TEST_F(TMirrorFloorTest, DepthLimitStopsReflections) {
+    Camera.setSecondaryRaysOptions({.MaxDepth = 0});
+    Camera.makePicture(std::vector<const TFigure*>{&Floor, &Cube});
+
+    EXPECT_EQ(centerPixel(Camera, 17, 17), (std::array<uint8_t, 3>{0, 0, 0}));
+    EXPECT_EQ(Camera.getRenderStats().RaysPerBounce.size(), 1u);
+    EXPECT_GT(Camera.getRenderStats().DepthCutRaysCount, 0u);
+}
+
+TEST_F(TMirrorFloorTest, BudgetLimitsRaysPerFrame) {
+    Camera.setSecondaryRaysOptions({.RaysBudget = 5});
+    Camera.makePicture(std::vector<const TFigure*>{&Floor, &Cube});
+    EXPECT_EQ(secondaryRaysCount(), 5u);
+    EXPECT_GT(Camera.getRenderStats().BudgetCutRaysCount, 0u);
+
+    // the budget is per frame
+    Camera.makePicture(std::vector<const TFigure*>{&Floor, &Cube});
+    EXPECT_EQ(secondaryRaysCount(), 5u);
+}
+
+TEST_F(TMirrorFloorTest, LowContributionRaysAreCut) {
+    Camera.setMaterial(Floor, flatMaterial(TColor{}, 0.5));
+    Camera.setSecondaryRaysOptions({.MinContribution = 0.6});
+    Camera.makePicture(std::vector<const TFigure*>{&Floor, &Cube});
+
+    EXPECT_EQ(secondaryRaysCount(), 0u);
+    EXPECT_GT(Camera.getRenderStats().ContributionCutRaysCount, 0u);
+}
+
+TEST(TCamera, GlassPassesLightThrough) {
+    const TPolyhedron glass = createRegularHexahedron(TPoint{0.2, -0.1, 0.0}, 1.0);
+    const TPlane wall{TPoint{0.0, 0.0, -2.0}, TVector{0.0, 0.0, 1.0}};
+    TCamera camera = makeTestCamera({17, 17});
+    camera.setLights({TLight::directional(TVector{0.0, 0.0, -1.0}, TColor{1.0, 1.0, 1.0})});
+    TPhongMaterial clear = TPhongMaterial::glass(1.0);
+    clear.Reflectivity = 0.0;
+    clear.Transparency = 1.0;
+    camera.setMaterial(glass, clear);
+    camera.setMaterial(wall, flatMaterial(TColor{0.0, 0.0, 1.0}, 0.0));
+
+    camera.makePicture(std::vector<const TFigure*>{&glass, &wall});
+
+    // the central ray enters and leaves the glass before it reaches the wall
+    EXPECT_EQ(centerPixel(camera, 17, 17), (std::array<uint8_t, 3>{0, 0, 255}));
+    EXPECT_GT(camera.getRenderStats().RaysPerBounce[1], 0u);
+    EXPECT_GT(camera.getRenderStats().RaysPerBounce[2], 0u);
+}
+
+static TImageData renderPicture(TCamera& camera, TRenderMode mode, const std::vector<const TFigure*>& figures) {
+    camera.setRenderMode(mode);
+    if (figures.size() == 1) {
+        camera.makePicture(*figures[0]);
+    } else {
+        camera.makePicture(figures);
+    }
+    return camera.getImageData();
+}
+
+TEST(TCamera, WavefrontMatchesPerPixelUnlit) {
+    const TPolyhedron figure = createRegularDodecahedron(TPoint{0.0, 0.0, 0.0}, 1.0);
+    // more pixels than one wavefront queue takes
+    TCamera perPixel = makeTestCamera({300, 300});
+    TCamera wavefront = makeTestCamera({300, 300});
+    EXPECT_EQ(renderPicture(wavefront, TRenderMode::Wavefront, {&figure}),
+              renderPicture(perPixel, TRenderMode::PerPixel, {&figure}));
+}
+
+TEST(TCamera, WavefrontMatchesPerPixelLit) {
+    const TPolyhedron cube = createRegularHexahedron(TPoint{0.0, 0.0, 0.0}, 1.0);
+    const TPolyhedron blocker = createRegularHexahedron(TPoint{2.0, 2.0, 2.0}, 0.5);
+    std::vector<TPolygon> polygons = cube.getFaces();
+    polygons.insert(polygons.end(), blocker.getFaces().begin(), blocker.getFaces().end());
+    const TMesh mesh{polygons};
+    const std::vector<TLight> lights = {TLight::point(TPoint{4.0, 4.0, 4.0}, TColor{20.0, 10.0, 10.0}),
+                                        TLight::directional(TVector{0.0, -1.0, -2.0}, TColor{0.3, 0.3, 0.6})};
+
+    TCamera perPixel = makeTestCamera({32, 32});
+    perPixel.setLights(lights);
+    TCamera wavefront = makeTestCamera({32, 32});
+    wavefront.setLights(lights);
+    EXPECT_EQ(renderPicture(wavefront, TRenderMode::Wavefront, {&mesh}),
+              renderPicture(perPixel, TRenderMode::PerPixel, {&mesh}));
+    EXPECT_EQ(wavefront.getRenderStats().ShadowRaysCount, perPixel.getRenderStats().ShadowRaysCount);
+}
+
+TEST_F(TMirrorFloorTest, WavefrontMatchesPerPixel) {
+    const TPolyhedron glass = createRegularHexahedron(TPoint{0.5, 0.0, 0.5}, 1.0);
+    Camera.setMaterial(glass, TPhongMaterial::glass());
+    const std::vector<const TFigure*> figures = {&Floor, &Cube, &glass};
+    const TImageData perPixel = renderPicture(Camera, TRenderMode::PerPixel, figures);
+    const TRenderStats perPixelStats = Camera.getRenderStats();
+
+    TCamera wavefront = makeTestCamera({17, 17});
+    wavefront.setLights({TLight::directional(TVector{0.0, 0.0, -1.0}, TColor{1.0, 1.0, 1.0})});
+    wavefront.setMaterial(Floor, flatMaterial(TColor{}, 1.0));
+    wavefront.setMaterial(Cube, flatMaterial(TColor{1.0, 0.0, 0.0}, 0.0));
+    wavefront.setMaterial(glass, TPhongMaterial::glass());
+    EXPECT_EQ(renderPicture(wavefront, TRenderMode::Wavefront, figures), perPixel);
+    EXPECT_EQ(wavefront.getRenderStats().RaysPerBounce, perPixelStats.RaysPerBounce);
+    EXPECT_GT(perPixelStats.RaysPerBounce[2], 0u);
+
+    wavefront.setRaySorting(false);
+    EXPECT_EQ(renderPicture(wavefront, TRenderMode::Wavefront, figures), perPixel);
+}
+
+TEST(TCamera, PixelOrderDoesNotChangePicture) {
+    const TPolyhedron cube = createRegularHexahedron(TPoint{0.0, 0.0, 0.0}, 1.0);
+    const TPolyhedron mirror = createRegularHexahedron(TPoint{1.5, -1.0, 0.0}, 1.0);
+    const TPlane floor{TPoint{0.0, 0.0, -1.0}, TVector{0.0, 0.0, 1.0}};
+    const std::vector<const TFigure*> figures = {&cube, &mirror, &floor};
+    for (const bool lit : {false, true}) {
+        std::optional<TImageData> expected;
+        for (const TRenderMode mode : {TRenderMode::PerPixel, TRenderMode::Wavefront}) {
+            for (const TPixelOrder order : {TPixelOrder::RowMajor, TPixelOrder::Morton, TPixelOrder::Hilbert}) {
+                // the size is not a multiple of the tile size
+                TCamera camera = makeTestCamera({37, 21});
+                if (lit) {
+                    camera.setLights({TLight::point(TPoint{3.0, 4.0, 5.0}, TColor{30.0, 30.0, 30.0})});
+                    camera.setMaterial(mirror, TPhongMaterial::mirror());
+                }
+                camera.setPixelOrder(order);
+                const TImageData picture = renderPicture(camera, mode, figures);
+                if (!expected.has_value()) {
+                    expected = picture;
+                }
+                EXPECT_EQ(picture, expected.value());
+                EXPECT_EQ(camera.getRenderStats().RaysPerBounce[0], 37u * 21u);
+            }
+        }
+    }
+}
+
+TEST(TCamera, TiledPictureDoesNotAllocatePerPixel) {
+    const TPolyhedron figure = createRegularDodecahedron(TPoint{0.0, 0.0, 0.0}, 1.0);
+    TCamera camera = makeTestCamera({16, 16});
+    camera.setPixelOrder(TPixelOrder::Hilbert);
+    camera.setLights({TLight::point(TPoint{5.0, 0.0, 5.0}, TColor{30.0, 30.0, 30.0})});
+
+    const size_t allocationsBefore = ALLOCATIONS_COUNT;
+    camera.makePicture(figure);
+    const size_t allocationsAfter = ALLOCATIONS_COUNT;
+
+    EXPECT_EQ(allocationsAfter - allocationsBefore, 0u);
+}
+
+TEST(TCamera, PixelOrderChangeKeepsImage) {
+    const TPolyhedron figure = createRegularDodecahedron(TPoint{0.0, 0.0, 0.0}, 1.0);
+    TCamera camera = makeTestCamera({37, 21});
+    camera.makePicture(figure);
+    const TImageData picture = camera.getImageData();
+
+    const uint8_t* placedData = camera.getImageData().data();
+    camera.setPixelOrder(TPixelOrder::RowMajor);
+    EXPECT_EQ(camera.getImageData().data(), placedData);
+    for (const TPixelOrder order : {TPixelOrder::Morton, TPixelOrder::Hilbert, TPixelOrder::RowMajor}) {
+        camera.setPixelOrder(order);
+        EXPECT_EQ(camera.getImageData(), picture);
+    }
+}
+
+TEST(TCamera, ProgressivePictureWithoutDeadlineMatchesPicture) {
+    const TPolyhedron cube = createRegularHexahedron(TPoint{0.0, 0.0, 0.0}, 1.0);
+    const TPlane floor{TPoint{0.0, 0.0, -1.0}, TVector{0.0, 0.0, 1.0}};
+    const std::vector<const TFigure*> figures = {&cube, &floor};
+    for (const bool lit : {false, true}) {
+        TCamera camera = makeTestCamera({37, 21});
+        TCamera progressive = makeTestCamera({37, 21});
+        if (lit) {
+            camera.setLights({TLight::point(TPoint{3.0, 4.0, 5.0}, TColor{30.0, 30.0, 30.0})});
+            progressive.setLights({TLight::point(TPoint{3.0, 4.0, 5.0}, TColor{30.0, 30.0, 30.0})});
+        }
+        camera.makePicture(figures);
+        const TProgressiveStats stats = progressive.makeProgressivePicture(figures, std::chrono::hours{1});
+
+        EXPECT_TRUE(stats.Complete);
+        EXPECT_EQ(stats.Step, 1u);
+        EXPECT_EQ(stats.PassesCount, 5u);
+        // every pixel is traced exactly once
+        EXPECT_EQ(stats.TracedPixelsCount, 37u * 21u);
+        EXPECT_EQ(progressive.getRenderStats().RaysPerBounce[0], 37u * 21u);
+        EXPECT_EQ(progressive.getImageData(), camera.getImageData());
+    }
+}
+
+TEST(TCamera, ProgressivePictureClearsCopiedColorsOnMisses) {
+    // without a floor most rays miss, the colors the coarse passes copy around the cube have to be cleared
+    const TPolyhedron cube = createRegularHexahedron(TPoint{0.0, 0.0, 0.0}, 1.0);
+    for (const bool lit : {false, true}) {
+        TCamera camera = makeTestCamera({37, 21});
+        TCamera progressive = makeTestCamera({37, 21});
+        if (lit) {
+            camera.setLights({TLight::point(TPoint{3.0, 4.0, 5.0}, TColor{30.0, 30.0, 30.0})});
+            progressive.setLights({TLight::point(TPoint{3.0, 4.0, 5.0}, TColor{30.0, 30.0, 30.0})});
+        }
+        camera.makePicture(cube);
+        const TProgressiveStats stats = progressive.makeProgressivePicture(cube, std::chrono::hours{1});
+
+        EXPECT_TRUE(stats.Complete);
+        EXPECT_EQ(progressive.getImageData(), camera.getImageData());
+    }
+}
+
+TEST(TCamera, ProgressivePictureFillsCoarsePassAtDeadline) {
+    const TPolyhedron figure = createRegularDodecahedron(TPoint{0.0, 0.0, 0.0}, 1.0);
+    TCamera camera = makeTestCamera({40, 33});
+    TCamera full = makeTestCamera({40, 33});
+    full.makePicture(figure);
+
+    const TProgressiveStats stats = camera.makeProgressivePicture(figure, std::chrono::seconds{0});
+
+    EXPECT_FALSE(stats.Complete);
+    EXPECT_EQ(stats.PassesCount, 1u);
+    EXPECT_EQ(stats.Step, PROGRESSIVE_FIRST_STEP);
+    // columns 0, 16, 32 of rows 0, 16, 32
+    EXPECT_EQ(stats.TracedPixelsCount, 9u);
+    const auto imagePixel = [](const TCamera& camera, size_t row, size_t column) {
+        const size_t idx = (row * 40 + column) * 3;
+        const TImageData& image = camera.getImageData();
+        return std::array<uint8_t, 3>{image[idx], image[idx + 1], image[idx + 2]};
+    };
+    const auto pixel = [&](size_t row, size_t column) { return imagePixel(camera, row, column); };
+    const auto fullPixel = [&](size_t row, size_t column) { return imagePixel(full, row, column); };
+    EXPECT_EQ(pixel(16, 16), fullPixel(16, 16));
+    // pixels take the color of the nearest traced one, the last grid row and column reach the borders
+    EXPECT_EQ(pixel(23, 9), fullPixel(16, 16));
+    EXPECT_EQ(pixel(24, 24), fullPixel(32, 32));
+    EXPECT_EQ(pixel(32, 39), fullPixel(32, 32));
+    EXPECT_EQ(pixel(7, 7), fullPixel(0, 0));
+}
+
+TEST(TCamera, RegionsMatchFullPicture) {
+    const TPolyhedron cube = createRegularHexahedron(TPoint{0.0, 0.0, 0.0}, 1.0);
+    const TPolyhedron mirror = createRegularHexahedron(TPoint{1.5, -1.0, 0.0}, 1.0);
+    const TPlane floor{TPoint{0.0, 0.0, -1.0}, TVector{0.0, 0.0, 1.0}};
+    const std::vector<const TFigure*> figures = {&cube, &mirror, &floor};
+    const std::vector<TPixelRect> regions = {{3, 20, 10, 17}, {0, 0, 21, 5}, {15, 9, 2, 2}};
+    const size_t regionsArea = 10 * 17 + 21 * 5 + 2 * 2;
+    for (const TRenderMode mode : {TRenderMode::PerPixel, TRenderMode::Wavefront}) {
+        for (const TPixelOrder order : {TPixelOrder::RowMajor, TPixelOrder::Hilbert}) {
+            TCamera full = makeTestCamera({37, 21});
+            TCamera partial = makeTestCamera({37, 21});
+            for (TCamera* camera : {&full, &partial}) {
+                camera->setLights({TLight::point(TPoint{3.0, 4.0, 5.0}, TColor{30.0, 30.0, 30.0})});
+                camera->setMaterial(mirror, TPhongMaterial::mirror());
+                camera->setRenderMode(mode);
+                camera->setPixelOrder(order);
+            }
+            full.makePicture(figures);
+            partial.makePicture(figures, regions);
+
+            EXPECT_EQ(partial.getRenderStats().RaysPerBounce[0], regionsArea);
+            const TImageData& fullImage = full.getImageData();
+            const TImageData& partialImage = partial.getImageData();
+            for (size_t i = 0; i < 21; i++) {
+                for (size_t j = 0; j < 37; j++) {
+                    const bool inRegion = std::any_of(regions.begin(), regions.end(), [i, j](const TPixelRect& region) {
+                        return region.contains(i, j);
+                    });
+                    for (size_t channel = 0; channel < 3; channel++) {
+                        const size_t idx = (i * 37 + j) * 3 + channel;
+                        EXPECT_EQ(partialImage[idx], inRegion ? fullImage[idx] : 0);
+                    }
+                }
+            }
+            for (const TPixelRect& region : regions) {
+                EXPECT_EQ(partial.getRegionData(region), full.getRegionData(region));
+            }
+        }
+    }
+}
+
+TEST(TCamera, RegionDataIsCompact) {
+    const TPolyhedron figure = createRegularDodecahedron(TPoint{0.0, 0.0, 0.0}, 1.0);
+    TCamera camera = makeTestCamera({16, 16});
+    camera.makePicture(figure, {{6, 5, 2, 3}});
+
+    const std::vector<uint8_t> region = camera.getRegionData({6, 5, 2, 3});
+    ASSERT_EQ(region.size(), 2u * 3u * 3u);
+    const TImageData& image = camera.getImageData();
+    EXPECT_TRUE(std::equal(region.begin(), region.begin() + 9, image.begin() + (6 * 16 + 5) * 3));
+    EXPECT_TRUE(std::equal(region.begin() + 9, region.end(), image.begin() + (7 * 16 + 5) * 3));
+}
+
+TEST(TCamera, InvalidRegionsThrow) {
+    const TPolyhedron figure = createRegularDodecahedron(TPoint{0.0, 0.0, 0.0}, 1.0);
+    TCamera camera = makeTestCamera({16, 16});
+    EXPECT_THROW(camera.makePicture(figure, {{0, 0, 0, 4}}), std::runtime_error);
+    EXPECT_THROW(camera.makePicture(figure, {{10, 0, 7, 4}}), std::runtime_error);
+    EXPECT_THROW(camera.makePicture(figure, {{0, 0, 4, 4}, {3, 3, 4, 4}}), std::runtime_error);
+    EXPECT_THROW(camera.getRegionData({0, 15, 1, 2}), std::runtime_error);
+    // touching regions do not overlap
+    EXPECT_NO_THROW(camera.makePicture(figure, {{0, 0, 4, 4}, {4, 0, 4, 4}, {0, 4, 4, 4}}));
+}
+
+TEST(TCamera, EmptyRegionsListTracesNothing) {
+    const TPolyhedron small = createRegularDodecahedron(TPoint{0.0, 0.0, 0.0}, 0.5);
+    const TPolyhedron large = createRegularDodecahedron(TPoint{0.0, 0.0, 0.0}, 1.0);
+    for (const TRenderMode mode : {TRenderMode::PerPixel, TRenderMode::Wavefront}) {
+        TCamera camera = makeTestCamera({16, 16});
+        camera.setRenderMode(mode);
+        camera.makePicture(small);
+        const TImageData before = camera.getImageData();
+        camera.makePicture(large, {});
+        EXPECT_EQ(camera.getImageData(), before);
+        EXPECT_EQ(camera.getRenderStats().RaysPerBounce[0], 0u);
+        camera.makePicture({&large}, {});
+        EXPECT_EQ(camera.getImageData(), before);
+        EXPECT_EQ(camera.getActiveFiguresCount(), 0u);
+    }
+}
+
+TEST(TCamera, FiguresOutOfRegionsAreCulled) {
+    std::vector<TPolyhedron> figures;
+    for (int x = -5; x <= 5; x++) {
+        for (int y = -5; y <= 5; y++) {
+            figures.push_back(createRegularHexahedron(TPoint{1.0 * x, 1.0 * y, 0.0}, 0.2));
+        }
+    }
+    std::vector<const TFigure*> scene;
+    for (const auto& figure : figures) {
+        scene.push_back(&figure);
+    }
+    TCamera full = makeTestCamera({32, 32});
+    full.makePicture(scene);
+    TCamera corner = makeTestCamera({32, 32});
+    const TPixelRect region{0, 0, 8, 8};
+    corner.makePicture(scene, {region});
+
+    EXPECT_GT(corner.getActiveFiguresCount(), 0u);
+    EXPECT_LT(corner.getActiveFiguresCount(), full.getActiveFiguresCount() / 4);
+    EXPECT_EQ(corner.getRegionData(region), full.getRegionData(region));
+}
+
+TEST(TCamera, PublishedTilesCoverPictureWithFinalPixels) {
+    const TPolyhedron cube = createRegularHexahedron(TPoint{0.0, 0.0, 0.0}, 1.0);
+    const TPlane floor{TPoint{0.0, 0.0, -1.0}, TVector{0.0, 0.0, 1.0}};
+    const std::vector<const TFigure*> figures = {&cube, &floor};
+    for (const TRenderMode mode : {TRenderMode::PerPixel, TRenderMode::Wavefront}) {
+        for (const TPixelOrder order : {TPixelOrder::RowMajor, TPixelOrder::Hilbert}) {
+            TCamera camera = makeTestCamera({37, 21});
+            camera.setLights({TLight::point(TPoint{3.0, 4.0, 5.0}, TColor{30.0, 30.0, 30.0})});
+            camera.setRenderMode(mode);
+            camera.setPixelOrder(order);
+            // pixels of every tile copied when it is published
+            std::mutex mutex;
+            std::vector<std::pair<TPixelRect, std::vector<uint8_t>>> tiles;
+            camera.setTileCallback([&](const TPixelRect& rect) {
+                std::vector<uint8_t> data = camera.getRegionData(rect);
+                const std::lock_guard lock{mutex};
+                tiles.emplace_back(rect, std::move(data));
+            });
+            camera.makePicture(figures);
+
+            size_t area = 0;
+            for (const auto& [rect, data] : tiles) {
+                area += rect.Height * rect.Width;
+                EXPECT_EQ(data, camera.getRegionData(rect));
+            }
+            EXPECT_EQ(area, 37u * 21u);
+        }
+    }
+}
+
+TEST(TCamera, TileQueueIsDrainedWhileRendering) {
+    const TPolyhedron figure = createRegularDodecahedron(TPoint{0.0, 0.0, 0.0}, 1.0);
+    TCamera camera = makeTestCamera({64, 64});
+    camera.setPixelOrder(TPixelOrder::Morton);
+    // far fewer cells than tiles, the tiles the consumer does not keep up with are dropped
+    TMpscQueue<TPixelRect> queue{2};
+    camera.setTileQueue(&queue);
+    std::atomic<bool> done = false;
+    size_t tilesCount = 0;
+    std::thread consumer([&]() {
+        while (true) {
+            const bool finished = done;
+            while (const std::optional<TPixelRect> rect = queue.pop()) {
+                EXPECT_EQ(rect->Height * rect->Width, 64u);
+                tilesCount++;
+            }
+            if (finished) {
+                return;
+            }
+            std::this_thread::yield();
+        }
+    });
+    camera.makePicture(figure);
+    done = true;
+    consumer.join();
+    EXPECT_EQ(tilesCount + camera.getDroppedTilesCount(), 64u);
+}
+
+TEST(TCamera, FullTileQueueDoesNotHoldUpPicture) {
+    const TPolyhedron figure = createRegularDodecahedron(TPoint{0.0, 0.0, 0.0}, 1.0);
+    TCamera camera = makeTestCamera({64, 64});
+    // nobody drains the queue while the picture is made
+    TMpscQueue<TPixelRect> queue{16};
+    camera.setTileQueue(&queue);
+    camera.makePicture(figure);
+    EXPECT_EQ(camera.getDroppedTilesCount(), 64u - 16u);
+
+    // a queue holding every row gets all of them
+    TMpscQueue<TPixelRect> largeQueue{64};
+    camera.setTileQueue(&largeQueue);
+    camera.makePicture(figure);
+    EXPECT_EQ(camera.getDroppedTilesCount(), 0u);
+    size_t area = 0;
+    while (const std::optional<TPixelRect> rect = largeQueue.pop()) {
+        area += rect->Height * rect->Width;
+    }
+    EXPECT_EQ(area, 64u * 64u);
+}
+
+TEST(TCamera, SpanCostsAreRecorded) {
+    const TPolyhedron figure = createRegularDodecahedron(TPoint{0.0, 0.0, 0.0}, 1.0);
+    TCamera camera = makeTestCamera({40, 24});
+    camera.setLights({TLight::point(TPoint{5.0, 0.0, 5.0}, TColor{30.0, 30.0, 30.0})});
+    EXPECT_EQ(camera.getSpanCosts(), std::vector<double>(24, 0.0));
+    camera.makePicture(figure);
+    const std::vector<double>& costs = camera.getSpanCosts();
+    ASSERT_EQ(costs.size(), 24u);
+    EXPECT_GT(costs[12], 0.0);
+
+    const TCostHistogram histogram = camera.getSpanCostHistogram(4);
+    EXPECT_EQ(histogram.MinCost, *std::min_element(costs.begin(), costs.end()));
+    EXPECT_EQ(histogram.MaxCost, *std::max_element(costs.begin(), costs.end()));
+    ASSERT_EQ(histogram.Counts.size(), 4u);
+    EXPECT_EQ(std::accumulate(histogram.Counts.begin(), histogram.Counts.end(), size_t{0}), 24u);
+    EXPECT_GT(histogram.Counts.back(), 0u);
+    EXPECT_THROW(camera.getSpanCostHistogram(0), std::runtime_error);
+
+    // tiles are the spans of the other orders
+    camera.setPixelOrder(TPixelOrder::Hilbert);
+    EXPECT_EQ(camera.getSpanCosts().size(), 5u * 3u);
+}
+
+TEST(TCamera, CostSchedulingDoesNotChangePicture) {
+    const TPolyhedron cube = createRegularHexahedron(TPoint{0.0, 0.0, 0.0}, 1.0);
+    const TPlane floor{TPoint{0.0, 0.0, -1.0}, TVector{0.0, 0.0, 1.0}};
+    for (const TPixelOrder order : {TPixelOrder::RowMajor, TPixelOrder::Hilbert}) {
+        TCamera expected = makeTestCamera({37, 21});
+        TCamera scheduled = makeTestCamera({37, 21});
+        for (TCamera* camera : {&expected, &scheduled}) {
+            camera->setLights({TLight::point(TPoint{3.0, 4.0, 5.0}, TColor{30.0, 30.0, 30.0})});
+            camera->setPixelOrder(order);
+        }
+        scheduled.setCostScheduling(true);
+        expected.makePicture({&cube, &floor});
+        // the second picture takes its spans by the costs of the first one
+        for (size_t i = 0; i < 2; i++) {
+            scheduled.makePicture({&cube, &floor});
+            EXPECT_EQ(scheduled.getImageData(), expected.getImageData());
+        }
+    }
+}
+
+TEST(TCamera, CostScheduledPictureDoesNotAllocatePerPixel) {
+    const TPolyhedron figure = createRegularDodecahedron(TPoint{0.0, 0.0, 0.0}, 1.0);
+    TCamera camera = makeTestCamera({16, 16});
+    camera.setPixelOrder(TPixelOrder::Hilbert);
+    camera.setCostScheduling(true);
+    camera.makePicture(figure);
+
+    const size_t allocationsBefore = ALLOCATIONS_COUNT;
+    camera.makePicture(figure);
+    const size_t allocationsAfter = ALLOCATIONS_COUNT;
+
+    EXPECT_EQ(allocationsAfter - allocationsBefore, 0u);
+}
+
+TEST(TCamera, MovedCameraMatchesNewCamera) {
+    const TPolyhedron figure = createRegularDodecahedron(TPoint{0.0, 0.0, 0.0}, 1.0);
+    for (const TRenderMode mode : {TRenderMode::PerPixel, TRenderMode::Wavefront}) {
+        TCamera moved = makeTestCamera({24, 16});
+        moved.setRenderMode(mode);
+        moved.makePicture(figure);
+        const TImageData first = moved.getImageData();
+        // the figure moves to the side of the view, out of the pixels it covered
+        moved.setPose(TPoint{10.0, 10.0, 10.0}, TVector{-10.0, -8.0, -10.0});
+        moved.makePicture(figure);
+        TCamera expected{TPoint{10.0, 10.0, 10.0}, TVector{-10.0, -8.0, -10.0}, {TAngle{15.0}, TAngle{15.0}}, {24, 16}};
+        expected.makePicture(figure);
+        EXPECT_EQ(moved.getImageData(), expected.getImageData());
+
+        size_t uncoveredCount = 0;
+        for (size_t pixel = 0; pixel < 24 * 16; pixel++) {
+            const auto background = [pixel](const TImageData& image) {
+                return std::all_of(image.begin() + pixel * 3, image.begin() + pixel * 3 + 3,
+                                   [](uint8_t byte) { return byte == 0; });
+            };
+            uncoveredCount += !background(first) && background(expected.getImageData());
+        }
+        EXPECT_GT(uncoveredCount, 0u);
+    }
+}
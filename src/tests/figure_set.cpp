@@ -0,0 +1,69 @@
+#include "../ray_tracing_lib/all.h"
+
+#include <gtest/gtest.h>
+
+using namespace NRayTracingLib;
+
+//=== TFigureSet Tests ===
+
+TEST(TFigureSet, EmptySetHasNoHits) {
+    const TFigureSet figures;
+    EXPECT_EQ(figures.size(), 0u);
+    EXPECT_FALSE(figures.hit(TRay{TPoint{0, 0, 0}, TVector{1, 0, 0}}, 0.0, INF).has_value());
+}
+
+TEST(TFigureSet, AddKeepsEveryFigureType) {
+    TFigureSet figures;
+    figures.add(TPlane{TPoint{0, 0, -5}, TVector{0, 0, 1}});
+    figures.add(TPolygon{{TPoint{0, 0, 3}, TPoint{1, 0, 3}, TPoint{0, 1, 3}}});
+    figures.add(createRegularHexahedron(TPoint{0, 0, 0}, 2.0));
+    EXPECT_EQ(figures.size(), 3u);
+}
+
+TEST(TFigureSet, HitReturnsNearestOverAllTypes) {
+    const TFigureSet figures{{
+        TPlane{TPoint{0, 0, -5}, TVector{0, 0, 1}},
+        createRegularHexahedron(TPoint{0, 0, 0}, 2.0),
+        TPolygon{{TPoint{-1, -1, 3}, TPoint{1, -1, 3}, TPoint{0, 1, 3}}},
+    }};
+
+    const TRay down{TPoint{0, 0, 10}, TVector{0, 0, -1}};
+    std::optional<THit> hit = figures.hit(down, 0.0, INF);
+    ASSERT_TRUE(hit.has_value());
+    EXPECT_EQ(hit.value().Point, (TPoint{0, 0, 3}));
+    EXPECT_EQ(hit.value().T, 7.0);
+
+    const TRay up{TPoint{0, 0, -10}, TVector{0, 0, 1}};
+    hit = figures.hit(up, 0.0, INF);
+    ASSERT_TRUE(hit.has_value());
+    EXPECT_EQ(hit.value().Point, (TPoint{0, 0, -5}));
+}
+
+TEST(TFigureSet, MatchesVirtualDispatch) {
+    const TPolyhedron dodecahedron = createRegularDodecahedron(TPoint{0, 0, 0}, 1.0);
+    const TFigureSet figures{{dodecahedron}};
+    const TFigure& figure = dodecahedron;
+
+    const TRay ray{TPoint{3, 2, 1}, TVector{-3, -2.1, -0.9}};
+    std::optional<THit> expected = figure.hit(ray, 0.0, INF);
+    std::optional<THit> actual = figures.hit(ray, 0.0, INF);
+    ASSERT_TRUE(expected.has_value());
+    ASSERT_TRUE(actual.has_value());
+    EXPECT_EQ(actual.value().T, expected.value().T);
+    EXPECT_EQ(actual.value().Point, expected.value().Point);
+}
+
+TEST(TFigureSet, AnyHitAgreesWithHit) {
+    const TFigureSet figures{{
+        createRegularHexahedron(TPoint{0, 0, 0}, 2.0),
+        TPolygon{{TPoint{-1, -1, 3}, TPoint{1, -1, 3}, TPoint{0, 1, 3}}},
+    }};
+
+    const TRay down{TPoint{0, 0, 10}, TVector{0, 0, -1}};
+    const std::optional<THit> any = figures.anyHit(down, 0.0, INF);
+    ASSERT_TRUE(any.has_value());
+    EXPECT_GE(any.value().T, 7.0);
+
+    EXPECT_FALSE(figures.anyHit(TRay{TPoint{0, 0, 10}, TVector{0, 0, 1}}, 0.0, INF).has_value());
+    EXPECT_FALSE(figures.anyHit(down, 0.0, 6.0).has_value());
+}
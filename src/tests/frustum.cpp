@@ -0,0 +1,87 @@
+#include "../ray_tracing_lib/all.h"
+
+#include <gtest/gtest.h>
+
+using namespace NRayTracingLib;
+
+namespace {
+
+// looking along X with a 90 degrees square window
+TFrustum makeTestFrustum() {
+    return TFrustum{TPoint{0, 0, 0},
+                    TVector{1, 0, 0},
+                    {TVector{1, 1, 1}, TVector{1, -1, 1}, TVector{1, -1, -1}, TVector{1, 1, -1}}};
+}
+
+} // namespace
+
+//=== TFrustum Tests ===
+
+TEST(TFrustum, ParallelCornersThrow) {
+    EXPECT_THROW((TFrustum{TPoint{0, 0, 0},
+                           TVector{1, 0, 0},
+                           {TVector{1, 1, 1}, TVector{2, 2, 2}, TVector{1, -1, -1}, TVector{1, 1, -1}}}),
+                 std::runtime_error);
+}
+
+TEST(TFrustum, NormalsPointInside) {
+    const TFrustum frustum = makeTestFrustum();
+    for (const auto& plane : frustum.Planes) {
+        EXPECT_GT(plane.Normal * TVector(1, 0, 0), 0.0);
+    }
+}
+
+TEST(TFrustum, ContainsPoint) {
+    const TFrustum frustum = makeTestFrustum();
+    EXPECT_TRUE(frustum.containsPoint(TPoint{5, 0, 0}));
+    EXPECT_TRUE(frustum.containsPoint(TPoint{5, 4.9, -4.9}));
+    EXPECT_TRUE(frustum.containsPoint(TPoint{5, 5, 5}));
+    EXPECT_FALSE(frustum.containsPoint(TPoint{5, 5.1, 0}));
+    EXPECT_FALSE(frustum.containsPoint(TPoint{-1, 0, 0}));
+}
+
+TEST(TFrustum, BoxClassification) {
+    const TFrustum frustum = makeTestFrustum();
+
+    const TBoundingBox inside{TPoint{4, -1, -1}, TPoint{6, 1, 1}};
+    EXPECT_TRUE(frustum.intersects(inside));
+    EXPECT_TRUE(frustum.contains(inside));
+
+    const TBoundingBox crossing{TPoint{4, 3, -1}, TPoint{6, 7, 1}};
+    EXPECT_TRUE(frustum.intersects(crossing));
+    EXPECT_FALSE(frustum.contains(crossing));
+
+    const TBoundingBox aside{TPoint{4, 8, -1}, TPoint{6, 9, 1}};
+    EXPECT_FALSE(frustum.intersects(aside));
+
+    const TBoundingBox behind{TPoint{-6, -1, -1}, TPoint{-4, 1, 1}};
+    EXPECT_FALSE(frustum.intersects(behind));
+}
+
+TEST(TFrustum, UnboundedAndEmptyBoxes) {
+    const TFrustum frustum = makeTestFrustum();
+    EXPECT_TRUE(frustum.intersects(TBoundingBox::infinite()));
+    EXPECT_FALSE(frustum.contains(TBoundingBox::infinite()));
+    EXPECT_FALSE(frustum.intersects(TBoundingBox{}));
+}
+
+TEST(TFrustum, BvhCullKeepsVisibleBoxes) {
+    const TFrustum frustum = makeTestFrustum();
+    std::vector<TBoundingBox> boxes;
+    for (int x = -10; x <= 10; x++) {
+        for (int y = -10; y <= 10; y++) {
+            boxes.emplace_back(TPoint{x - 0.25, y - 0.25, -0.25}, TPoint{x + 0.25, y + 0.25, 0.25});
+        }
+    }
+    const TBvh bvh{boxes};
+
+    const std::vector<uint32_t> visible = cull(bvh, frustum);
+    const std::unordered_set<uint32_t> visibleSet(visible.begin(), visible.end());
+    EXPECT_EQ(visibleSet.size(), visible.size());
+    EXPECT_LT(visible.size(), boxes.size() / 2);
+    for (size_t i = 0; i < boxes.size(); i++) {
+        if (frustum.intersects(boxes[i])) {
+            EXPECT_TRUE(visibleSet.contains(static_cast<uint32_t>(i)));
+        }
+    }
+}
@@ -0,0 +1,142 @@
+#include "../ray_tracing_lib/all.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+using namespace NRayTracingLib;
+
+namespace {
+
+std::vector<TPolygon> polygonsCloud() {
+    std::vector<TPolygon> polygons;
+    for (int x = -2; x <= 2; x++) {
+        for (int y = -2; y <= 2; y++) {
+            const TPolyhedron cube = createRegularHexahedron(TPoint{3.0 * x, 3.0 * y, 0.5 * (x + y)}, 1.0);
+            polygons.insert(polygons.end(), cube.getFaces().begin(), cube.getFaces().end());
+        }
+    }
+    return polygons;
+}
+
+std::optional<THit> bruteForceHit(const std::vector<TPolygon>& polygons, const TLine& line, TSafeDouble tMin,
+                                  TSafeDouble tMax) {
+    std::optional<THit> nearest;
+    for (const auto& polygon : polygons) {
+        std::optional<THit> hit = polygon.rayHit(line.Point, line.Vector, tMin, tMax);
+        if (hit != std::nullopt && (nearest == std::nullopt || hit.value().T.Value < nearest.value().T.Value)) {
+            nearest = hit;
+        }
+    }
+    return nearest;
+}
+
+template <typename TGrid>
+void expectMatchesBruteForce(const TGrid& grid) {
+    std::mt19937 generator{42};
+    std::uniform_real_distribution<double> coordinate{-10.0, 10.0};
+    for (size_t i = 0; i < 500; i++) {
+        const TRay ray{TPoint{coordinate(generator), coordinate(generator), coordinate(generator)},
+                       TVector{coordinate(generator), coordinate(generator), coordinate(generator)}};
+        const std::optional<THit> expected = bruteForceHit(grid.getPolygons(), ray, 0.0, INF);
+        const std::optional<THit> actual = grid.hit(ray, 0.0, INF);
+        ASSERT_EQ(actual.has_value(), expected.has_value());
+        if (expected.has_value()) {
+            EXPECT_EQ(actual.value().T, expected.value().T);
+            EXPECT_EQ(actual.value().Point, expected.value().Point);
+        }
+    }
+}
+
+} // namespace
+
+//=== TVoxelGrid Tests ===
+
+TEST(TVoxelGrid, CreationWithoutPolygonsThrows) {
+    EXPECT_THROW(TUniformGrid{{}}, std::runtime_error);
+    EXPECT_THROW(TSpatialHashGrid{{}}, std::runtime_error);
+}
+
+TEST(TVoxelGrid, ResolutionGrowsWithPolygonsCount) {
+    const std::vector<TPolygon> polygons = polygonsCloud();
+    const TUniformGrid single{{polygons.front()}};
+    const TUniformGrid cloud{polygons};
+
+    size_t singleCells = 1;
+    size_t cloudCells = 1;
+    for (size_t axis = 0; axis < 3; axis++) {
+        singleCells *= single.getResolution()[axis];
+        cloudCells *= cloud.getResolution()[axis];
+    }
+    EXPECT_LT(singleCells, cloudCells);
+    EXPECT_EQ(cloud.getStoredCellsCount(), cloudCells);
+}
+
+TEST(TVoxelGrid, HashStoresOnlyOccupiedCells) {
+    const std::vector<TPolygon> polygons = polygonsCloud();
+    const TUniformGrid dense{polygons};
+    const TSpatialHashGrid hashed{polygons};
+    EXPECT_EQ(dense.getResolution(), hashed.getResolution());
+    EXPECT_LT(hashed.getStoredCellsCount(), dense.getStoredCellsCount());
+}
+
+TEST(TVoxelGrid, UniformGridMatchesBruteForce) { expectMatchesBruteForce(TUniformGrid{polygonsCloud()}); }
+
+TEST(TVoxelGrid, SpatialHashGridMatchesBruteForce) { expectMatchesBruteForce(TSpatialHashGrid{polygonsCloud()}); }
+
+TEST(TVoxelGrid, HitReportsPolygonIndex) {
+    const std::vector<TPolygon> polygons = polygonsCloud();
+    const TUniformGrid grid{polygons};
+
+    const TRay ray{TPoint{0, 0, 10}, TVector{0, 0, -1}};
+    const std::optional<THit> hit = grid.hit(ray, 0.0, INF);
+    ASSERT_TRUE(hit.has_value());
+    EXPECT_EQ(hit.value().Point, (TPoint{0, 0, 0.5}));
+    ASSERT_LT(hit.value().FaceIndex, polygons.size());
+    const std::optional<THit> polygonHit = polygons[hit.value().FaceIndex].rayHit(ray.Point, ray.Vector, 0.0, INF);
+    ASSERT_TRUE(polygonHit.has_value());
+    EXPECT_EQ(polygonHit.value().T, hit.value().T);
+}
+
+TEST(TVoxelGrid, RespectsParameterInterval) {
+    const TUniformGrid grid{polygonsCloud()};
+    const TRay ray{TPoint{0, 0, 10}, TVector{0, 0, -1}};
+
+    EXPECT_FALSE(grid.hit(ray, 0.0, 5.0).has_value());
+    const std::optional<THit> hit = grid.hit(ray, 10.0, INF);
+    ASSERT_TRUE(hit.has_value());
+    EXPECT_EQ(hit.value().Point, (TPoint{0, 0, -0.5}));
+}
+
+TEST(TVoxelGrid, LineHitsOnBothSides) {
+    const TUniformGrid grid{polygonsCloud()};
+    const TLine line{TPoint{0, 0, -0.25}, TVector{0, 0, 1}};
+
+    const std::optional<THit> hit = grid.hit(line, line.minParameter(), INF);
+    ASSERT_TRUE(hit.has_value());
+    EXPECT_EQ(hit.value().T, -0.25);
+    EXPECT_EQ(hit.value().Point, (TPoint{0, 0, -0.5}));
+}
+
+TEST(TVoxelGrid, MissOutsideBox) {
+    const TSpatialHashGrid grid{polygonsCloud()};
+    EXPECT_FALSE(grid.hit(TRay{TPoint{0, 0, 10}, TVector{0, 0, 1}}, 0.0, INF).has_value());
+    EXPECT_FALSE(grid.hit(TRay{TPoint{100, 0, 0}, TVector{0, 1, 0}}, 0.0, INF).has_value());
+}
+
+TEST(TVoxelGrid, AnyHitAgreesWithHit) {
+    const TSpatialHashGrid grid{polygonsCloud()};
+    std::mt19937 generator{3};
+    std::uniform_real_distribution<double> coordinate{-10.0, 10.0};
+    for (size_t i = 0; i < 200; i++) {
+        const TLine line{TPoint{coordinate(generator), coordinate(generator), coordinate(generator)},
+                         TVector{coordinate(generator), coordinate(generator), coordinate(generator)}};
+        const std::optional<THit> nearest = grid.hit(line, line.minParameter(), INF);
+        const std::optional<THit> any = grid.anyHit(line, line.minParameter(), INF);
+        ASSERT_EQ(any.has_value(), nearest.has_value());
+        if (any.has_value()) {
+            EXPECT_GE(any.value().T.abs(), nearest.value().T.abs());
+            EXPECT_EQ(any.value().Point, line.pointAt(any.value().T));
+        }
+    }
+}
@@ -0,0 +1,109 @@
+#include "../ray_tracing_lib/all.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+using namespace NRayTracingLib;
+
+namespace {
+
+const std::shared_ptr<const TFigure> DODECAHEDRON =
+    std::make_shared<const TPolyhedron>(createRegularDodecahedron(TPoint{0, 0, 0}, 1.0));
+
+std::vector<TTransform> scatteredTransforms(size_t count) {
+    std::mt19937 generator{5};
+    std::uniform_real_distribution<double> coordinate{-20.0, 20.0};
+    std::uniform_real_distribution<double> degrees{0.0, 360.0};
+    std::vector<TTransform> transforms;
+    for (size_t i = 0; i < count; i++) {
+        transforms.push_back(TTransform::translation(TVector{coordinate(generator), coordinate(generator),
+                                                             coordinate(generator)}) *
+                             TTransform::rotation(TVector{1, 2, 3}, TAngle{degrees(generator)}));
+    }
+    return transforms;
+}
+
+} // namespace
+
+//=== TInstance Tests ===
+
+TEST(TInstance, CreationWithoutFigureThrows) {
+    EXPECT_THROW((TInstance{nullptr, TTransform{}}), std::runtime_error);
+}
+
+TEST(TInstance, MatchesTransformedCopy) {
+    const TTransform transform = TTransform::translation(TVector{3, -1, 2}) *
+                                 TTransform::rotation(TVector{0, 1, 1}, TAngle{40.0}) * TTransform::scaling(1.5);
+    const TInstance instance{DODECAHEDRON, transform};
+
+    const TRay ray{TPoint{10, 10, 10}, TVector{3, -1, 2} - TVector{10, 10, 10}};
+    const std::optional<THit> hit = instance.hit(ray, 0.0, INF);
+    ASSERT_TRUE(hit.has_value());
+
+    const std::optional<THit> objectHit = DODECAHEDRON->hit(
+        TLine{transform.inverse().apply(ray.Point), transform.inverse().apply(ray.Vector)}, 0.0, INF);
+    ASSERT_TRUE(objectHit.has_value());
+    EXPECT_EQ(hit.value().T, objectHit.value().T);
+    EXPECT_EQ(hit.value().Point, ray.pointAt(hit.value().T));
+    EXPECT_EQ(hit.value().Point, transform.apply(objectHit.value().Point));
+    EXPECT_EQ(hit.value().Normal.length(), 1.0);
+    EXPECT_LT(hit.value().Normal * ray.Vector, 0.0);
+}
+
+TEST(TInstance, BoundsFollowTransform) {
+    const TInstance instance{DODECAHEDRON, TTransform::translation(TVector{100, 0, 0})};
+    const TBoundingBox box = instance.bounds().Box;
+    EXPECT_GT(box.Min.X, 98.0);
+    EXPECT_LT(box.Max.X, 102.0);
+    EXPECT_FALSE(instance.hit(TRay{TPoint{0, 0, 10}, TVector{0, 0, -1}}, 0.0, INF).has_value());
+}
+
+//=== TScene Tests ===
+
+TEST(TScene, InstancesShareFigure) {
+    std::vector<TInstance> instances;
+    for (const auto& transform : scatteredTransforms(100)) {
+        instances.emplace_back(DODECAHEDRON, transform);
+    }
+    const TScene scene{instances};
+    EXPECT_EQ(&scene.getInstances()[0].getFigure(), &scene.getInstances()[99].getFigure());
+    EXPECT_EQ(&scene.getInstances()[0].getFigure(), DODECAHEDRON.get());
+}
+
+TEST(TScene, MatchesInstanceByInstance) {
+    std::vector<TInstance> instances;
+    for (const auto& transform : scatteredTransforms(200)) {
+        instances.emplace_back(DODECAHEDRON, transform);
+    }
+    const TScene scene{instances};
+
+    std::mt19937 generator{9};
+    std::uniform_real_distribution<double> coordinate{-25.0, 25.0};
+    for (size_t i = 0; i < 200; i++) {
+        const TRay ray{TPoint{coordinate(generator), coordinate(generator), coordinate(generator)},
+                       TVector{coordinate(generator), coordinate(generator), coordinate(generator)}};
+        std::optional<THit> expected;
+        size_t expectedInstance = NO_INDEX;
+        for (size_t j = 0; j < instances.size(); j++) {
+            std::optional<THit> hit = instances[j].hit(ray, 0.0, INF);
+            if (hit != std::nullopt && (expected == std::nullopt || hit.value().T.Value < expected.value().T.Value)) {
+                expected = hit;
+                expectedInstance = j;
+            }
+        }
+
+        const std::optional<THit> actual = scene.hit(ray, 0.0, INF);
+        ASSERT_EQ(actual.has_value(), expected.has_value());
+        EXPECT_EQ(scene.anyHit(ray, 0.0, INF).has_value(), expected.has_value());
+        if (expected.has_value()) {
+            EXPECT_EQ(actual.value().T, expected.value().T);
+            EXPECT_EQ(actual.value().InstanceIndex, expectedInstance);
+        }
+    }
+}
+
+TEST(TScene, UnboundedInstanceThrows) {
+    const TInstance plane{std::make_shared<const TPlane>(TPoint{0, 0, 0}, TVector{0, 0, 1}), TTransform{}};
+    EXPECT_THROW(TScene{{plane}}, std::runtime_error);
+}
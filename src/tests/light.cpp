@@ -0,0 +1,115 @@
+#include "../ray_tracing_lib/all.h"
+
+#include <gtest/gtest.h>
+
+using namespace NRayTracingLib;
+
+//=== TColor Tests ===
+
+TEST(TColor, Arithmetic) {
+    const TColor color{0.5, 0.25, 1.0};
+    EXPECT_EQ(color + TColor(0.5, 0.5, 0.5), (TColor{1.0, 0.75, 1.5}));
+    EXPECT_EQ(color * 2.0, (TColor{1.0, 0.5, 2.0}));
+    EXPECT_EQ(color * TColor(0.5, 2.0, 0.0), (TColor{0.25, 0.5, 0.0}));
+
+    TColor sum;
+    sum += color;
+    sum += color;
+    EXPECT_EQ(sum, (TColor{1.0, 0.5, 2.0}));
+}
+
+TEST(TColor, ToBytesClamps) {
+    EXPECT_EQ(TColor{}.toBytes(), (std::array<uint8_t, 3>{0, 0, 0}));
+    EXPECT_EQ((TColor{1.0, 0.5, 2.0}.toBytes()), (std::array<uint8_t, 3>{255, 128, 255}));
+    EXPECT_EQ((TColor{-1.0, 0.0, 0.2}.toBytes()), (std::array<uint8_t, 3>{0, 0, 51}));
+}
+
+//=== TPhongMaterial Tests ===
+
+TEST(TPhongMaterial, LambertFollowsCosine) {
+    TPhongMaterial material;
+    material.Diffuse = TColor{1.0, 1.0, 1.0};
+    material.Specular = TColor{};
+    const TVector normal{0.0, 0.0, 1.0};
+    const TVector toViewer{0.0, 0.0, 1.0};
+    const TColor light{1.0, 0.5, 0.0};
+
+    EXPECT_EQ(material.reflect(light, normal, normal, toViewer), light);
+    const TVector slanted = TVector{1.0, 0.0, 1.0}.getNormalized();
+    EXPECT_EQ(material.reflect(light, normal, slanted, toViewer), light * std::sqrt(0.5));
+    EXPECT_EQ(material.reflect(light, normal, TVector{1.0, 0.0, 0.0}, toViewer), TColor{});
+    EXPECT_EQ(material.reflect(light, normal, -normal, toViewer), TColor{});
+}
+
+TEST(TPhongMaterial, HighlightAlongMirroredDirection) {
+    TPhongMaterial material;
+    material.Diffuse = TColor{};
+    material.Specular = TColor{1.0, 1.0, 1.0};
+    material.Shininess = 16.0;
+    const TVector normal{0.0, 0.0, 1.0};
+    const TVector toLight = TVector{1.0, 0.0, 1.0}.getNormalized();
+    const TColor light{1.0, 1.0, 1.0};
+
+    EXPECT_EQ(material.reflect(light, normal, toLight, TVector{-1.0, 0.0, 1.0}.getNormalized()), light);
+    const TColor offMirror = material.reflect(light, normal, toLight, normal);
+    EXPECT_EQ(offMirror, light * std::pow(std::sqrt(0.5), 16.0));
+    EXPECT_EQ(material.reflect(light, normal, toLight, toLight), TColor{});
+}
+
+//=== TLight Tests ===
+
+TEST(TLight, PointLightShadowRayEndsAtLight) {
+    const TLight light = TLight::point(TPoint{0.0, 0.0, 4.0}, TColor{16.0, 16.0, 16.0});
+    const TPoint point{0.0, 0.0, 2.0};
+    const auto [direction, tMax] = light.shadowRay(point);
+    EXPECT_EQ(point + direction * tMax, (TPoint{0.0, 0.0, 4.0}));
+    EXPECT_EQ(light.getType(), TLightType::Point);
+    // inverse square falloff
+    EXPECT_EQ(light.intensityAt(point), (TColor{4.0, 4.0, 4.0}));
+    EXPECT_EQ(light.intensityAt(TPoint{0.0, 0.0, 0.0}), (TColor{1.0, 1.0, 1.0}));
+}
+
+TEST(TLight, DirectionalLightShadowRayIsUnbounded) {
+    const TLight light = TLight::directional(TVector{0.0, 0.0, -2.0}, TColor{0.5, 0.5, 0.5});
+    const auto [direction, tMax] = light.shadowRay(TPoint{1.0, 2.0, 3.0});
+    EXPECT_EQ(direction, (TVector{0.0, 0.0, 1.0}));
+    EXPECT_EQ(tMax, INF);
+    EXPECT_EQ(light.intensityAt(TPoint{100.0, 0.0, 0.0}), light.getIntensity());
+    EXPECT_THROW(TLight::directional(TVector{0.0, 0.0, 0.0}, TColor{}), std::runtime_error);
+}
+
+TEST(TPhongMaterial, MirrorAndGlass) {
+    EXPECT_EQ(TPhongMaterial{}.localWeight(), 1.0);
+    EXPECT_NEAR(TPhongMaterial::mirror().localWeight(), 0.1, ACCURACY);
+    EXPECT_EQ(TPhongMaterial::glass().localWeight(), 0.0);
+    EXPECT_EQ(TPhongMaterial::glass(1.33).RefractiveIndex, 1.33);
+    EXPECT_THROW(TPhongMaterial::glass(0.0), std::runtime_error);
+}
+
+//=== Secondary Directions Tests ===
+
+TEST(SecondaryDirections, Reflection) {
+    const TVector normal{0.0, 0.0, 1.0};
+    EXPECT_EQ(reflectDirection(TVector{1.0, 2.0, -3.0}, normal), (TVector{1.0, 2.0, 3.0}));
+    EXPECT_EQ(reflectDirection(TVector{0.0, 0.0, -1.0}, normal), normal);
+}
+
+TEST(SecondaryDirections, RefractionFollowsSnellLaw) {
+    const TVector normal{0.0, 0.0, 1.0};
+    const TVector direction = TVector{1.0, 0.0, -1.0}.getNormalized();
+    EXPECT_EQ(refractDirection(direction * 3.0, normal, 1.0), direction);
+
+    const std::optional<TVector> refracted = refractDirection(direction, normal, 1.0 / 1.5);
+    ASSERT_TRUE(refracted.has_value());
+    EXPECT_EQ(refracted.value().length(), 1.0);
+    // sin of the refraction angle is the sin of the incidence angle divided by 1.5
+    EXPECT_EQ(refracted.value().X, std::sqrt(0.5) / 1.5);
+    EXPECT_LT(refracted.value().Z, 0.0);
+}
+
+TEST(SecondaryDirections, TotalInternalReflection) {
+    const TVector normal{0.0, 0.0, 1.0};
+    // 60 degrees from glass to air is past the critical angle of about 42 degrees
+    EXPECT_FALSE(refractDirection(TVector{std::sqrt(3.0), 0.0, -1.0}, normal, 1.5).has_value());
+    EXPECT_TRUE(refractDirection(TVector{1.0, 0.0, -3.0}, normal, 1.5).has_value());
+}
@@ -0,0 +1,77 @@
+#include "../ray_tracing_lib/all.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+using namespace NRayTracingLib;
+
+//=== TMpscQueue Tests ===
+
+TEST(TMpscQueue, RoundsCapacityUpToPowerOfTwo) {
+    EXPECT_EQ(TMpscQueue<int>{0}.capacity(), 2u);
+    EXPECT_EQ(TMpscQueue<int>{5}.capacity(), 8u);
+    EXPECT_EQ(TMpscQueue<int>{16}.capacity(), 16u);
+}
+
+TEST(TMpscQueue, PopsInPushOrder) {
+    TMpscQueue<int> queue{4};
+    EXPECT_FALSE(queue.pop().has_value());
+    // several laps over the ring
+    for (int lap = 0; lap < 3; lap++) {
+        for (int i = 0; i < 3; i++) {
+            EXPECT_TRUE(queue.push(lap * 10 + i));
+        }
+        for (int i = 0; i < 3; i++) {
+            EXPECT_EQ(queue.pop(), lap * 10 + i);
+        }
+        EXPECT_FALSE(queue.pop().has_value());
+    }
+}
+
+TEST(TMpscQueue, FullQueueRejectsPush) {
+    TMpscQueue<int> queue{4};
+    for (int i = 0; i < 4; i++) {
+        EXPECT_TRUE(queue.push(i));
+    }
+    EXPECT_FALSE(queue.push(4));
+    EXPECT_EQ(queue.pop(), 0);
+    EXPECT_TRUE(queue.push(4));
+    for (int i = 1; i <= 4; i++) {
+        EXPECT_EQ(queue.pop(), i);
+    }
+}
+
+TEST(TMpscQueue, KeepsOrderOfEveryProducer) {
+    static constexpr size_t PRODUCERS_COUNT = 4;
+    static constexpr size_t VALUES_COUNT = 10000;
+    // the queue is much smaller than the values, so producers wait for the consumer
+    TMpscQueue<std::pair<size_t, size_t>> queue{64};
+    std::vector<std::thread> producers;
+    for (size_t producer = 0; producer < PRODUCERS_COUNT; producer++) {
+        producers.emplace_back([&queue, producer]() {
+            for (size_t i = 0; i < VALUES_COUNT; i++) {
+                while (!queue.push({producer, i})) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    std::vector<size_t> nextValues(PRODUCERS_COUNT, 0);
+    size_t poppedCount = 0;
+    while (poppedCount < PRODUCERS_COUNT * VALUES_COUNT) {
+        const std::optional<std::pair<size_t, size_t>> value = queue.pop();
+        if (!value.has_value()) {
+            std::this_thread::yield();
+            continue;
+        }
+        ASSERT_EQ(value->second, nextValues[value->first]);
+        nextValues[value->first]++;
+        poppedCount++;
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    EXPECT_EQ(nextValues, std::vector<size_t>(PRODUCERS_COUNT, VALUES_COUNT));
+    EXPECT_FALSE(queue.pop().has_value());
+}
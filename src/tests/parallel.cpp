@@ -0,0 +1,148 @@
+#include "../ray_tracing_lib/all.h"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+
+using namespace NRayTracingLib;
+
+//=== Topology Tests ===
+
+TEST(NumaTopology, ParsesCpuList) {
+    EXPECT_EQ(parseCpuList("0-3,8,10-11\n"), (std::vector<size_t>{0, 1, 2, 3, 8, 10, 11}));
+    EXPECT_EQ(parseCpuList("5"), (std::vector<size_t>{5}));
+    // nodes without processors have an empty list
+    EXPECT_TRUE(parseCpuList("\n").empty());
+    EXPECT_THROW(parseCpuList("0-x"), std::runtime_error);
+}
+
+TEST(NumaTopology, ReadsNodeDirectories) {
+    const std::filesystem::path root = std::filesystem::temp_directory_path() / "ray_tracing_numa_test";
+    std::filesystem::remove_all(root);
+    for (const auto& [name, cpus] : {std::pair{"node1", "4-7"}, std::pair{"node0", "0-3"}}) {
+        std::filesystem::create_directories(root / name);
+        std::ofstream{root / name / "cpulist"} << cpus << '\n';
+    }
+    // other entries of the directory are not nodes
+    std::filesystem::create_directories(root / "power");
+    std::ofstream{root / "possible"} << "0-1\n";
+
+    const std::vector<TNumaNode> nodes = readNumaNodes(root.string());
+    ASSERT_EQ(nodes.size(), 2u);
+    EXPECT_EQ(nodes[0].Id, 0u);
+    EXPECT_EQ(nodes[0].Cpus, (std::vector<size_t>{0, 1, 2, 3}));
+    EXPECT_EQ(nodes[1].Id, 1u);
+    EXPECT_EQ(nodes[1].Cpus, (std::vector<size_t>{4, 5, 6, 7}));
+    std::filesystem::remove_all(root);
+
+    EXPECT_TRUE(readNumaNodes((root / "missing").string()).empty());
+}
+
+TEST(NumaTopology, AllowedNodesAreNotEmpty) {
+    const std::vector<TNumaNode> nodes = allowedNumaNodes();
+    ASSERT_FALSE(nodes.empty());
+    for (const TNumaNode& node : nodes) {
+        EXPECT_FALSE(node.Cpus.empty());
+    }
+}
+
+//=== Thread Pool Tests ===
+
+// two nodes over the first allowed processor, workers are pinned to it in turn
+static std::vector<TNumaNode> twoNodes() {
+    const size_t cpu = allowedNumaNodes()[0].Cpus[0];
+    return {TNumaNode{0, {cpu}}, TNumaNode{1, {cpu}}};
+}
+
+TEST(TThreadPool, RunsEveryTaskOnce) {
+    TThreadPool pool{4, twoNodes()};
+    EXPECT_EQ(pool.getThreadsCount(), 4u);
+    EXPECT_EQ(pool.getNodesCount(), 2u);
+    for (const size_t tasksCount : {0, 1, 2, 7, 1000}) {
+        std::vector<std::atomic<size_t>> runs(tasksCount);
+        std::vector<size_t> threads(tasksCount);
+        pool.run(tasksCount, [&](size_t task) {
+            runs[task]++;
+            threads[task] = pool.currentThread();
+        });
+        for (size_t task = 0; task < tasksCount; task++) {
+            EXPECT_EQ(runs[task], 1u);
+            EXPECT_LT(threads[task], pool.getThreadsCount());
+        }
+    }
+    // threads not belonging to the pool have index 0
+    EXPECT_EQ(pool.currentThread(), 0u);
+}
+
+TEST(TThreadPool, RunsNestedJobs) {
+    TThreadPool pool{3};
+    std::atomic<size_t> sum = 0;
+    pool.run(10, [&](size_t outer) {
+        pool.run(10, [&](size_t inner) { sum += outer * 10 + inner; });
+    });
+    EXPECT_EQ(sum, 99u * 100u / 2u);
+}
+
+TEST(TThreadPool, RethrowsTaskException) {
+    TThreadPool pool{3};
+    std::atomic<size_t> started = 0;
+    EXPECT_THROW(pool.run(100,
+                          [&](size_t task) {
+                              started++;
+                              if (task == 0) {
+                                  throw std::runtime_error("Error: task failed");
+                              }
+                          }),
+                 std::runtime_error);
+    EXPECT_LE(started, 100u);
+    // the pool keeps working after a failed job
+    std::atomic<size_t> count = 0;
+    pool.run(50, [&](size_t) { count++; });
+    EXPECT_EQ(count, 50u);
+}
+
+TEST(TThreadPool, PostedTasksRunOnWorkers) {
+    std::atomic<size_t> count = 0;
+    std::atomic<size_t> workerRuns = 0;
+    {
+        TThreadPool pool{3};
+        for (size_t i = 0; i < 20; i++) {
+            pool.post([&]() {
+                // posted tasks may run jobs of their own
+                pool.run(10, [&](size_t) { count++; });
+                workerRuns += pool.currentThread() != 0;
+            });
+        }
+        // the tasks still waiting are run by the destructor
+    }
+    EXPECT_EQ(count, 200u);
+    EXPECT_EQ(workerRuns, 20u);
+
+    // without workers the task runs before post returns
+    TThreadPool single{1};
+    bool done = false;
+    single.post([&done]() { done = true; });
+    EXPECT_TRUE(done);
+}
+
+TEST(TThreadPool, ForChunksCoversRange) {
+    std::vector<uint32_t> values(1001, 0);
+    std::vector<size_t> chunks(values.size());
+    forChunks(0, static_cast<uint32_t>(values.size()), 4, [&](uint32_t begin, uint32_t end, size_t chunk) {
+        for (uint32_t i = begin; i < end; i++) {
+            values[i]++;
+            chunks[i] = chunk;
+        }
+    });
+    EXPECT_EQ(std::accumulate(values.begin(), values.end(), 0u), values.size());
+    EXPECT_TRUE(std::is_sorted(chunks.begin(), chunks.end()));
+    EXPECT_EQ(chunks.back(), 3u);
+}
+
+TEST(TFirstTouchAllocator, KeepsValueInitialization) {
+    std::vector<int, TFirstTouchAllocator<int>> values(3, 7);
+    values.push_back(1);
+    EXPECT_EQ(values, (std::vector<int, TFirstTouchAllocator<int>>{7, 7, 7, 1}));
+}
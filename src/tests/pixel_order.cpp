@@ -0,0 +1,72 @@
+#include "../ray_tracing_lib/all.h"
+
+#include <gtest/gtest.h>
+
+using namespace NRayTracingLib;
+
+//=== Curve Index Tests ===
+
+TEST(PixelOrder, MortonIndexInterleavesBits) {
+    EXPECT_EQ(mortonIndex(0, 0), 0u);
+    EXPECT_EQ(mortonIndex(1, 0), 1u);
+    EXPECT_EQ(mortonIndex(0, 1), 2u);
+    EXPECT_EQ(mortonIndex(1, 1), 3u);
+    EXPECT_EQ(mortonIndex(2, 0), 4u);
+    EXPECT_EQ(mortonIndex(0b101, 0b011), 0b011011u);
+    EXPECT_EQ(mortonIndex(0xffffffff, 0), 0x5555555555555555u);
+}
+
+TEST(PixelOrder, HilbertCurveVisitsNeighbours) {
+    const size_t bits = 4;
+    const size_t side = 1 << bits;
+    std::vector<std::pair<uint32_t, uint32_t>> cells(side * side);
+    std::vector<bool> seen(side * side, false);
+    for (uint32_t x = 0; x < side; x++) {
+        for (uint32_t y = 0; y < side; y++) {
+            const uint64_t index = hilbertIndex(x, y, bits);
+            ASSERT_LT(index, cells.size());
+            ASSERT_FALSE(seen[index]);
+            seen[index] = true;
+            cells[index] = {x, y};
+        }
+    }
+    EXPECT_EQ(cells.front(), (std::pair<uint32_t, uint32_t>{0, 0}));
+    for (size_t i = 1; i < cells.size(); i++) {
+        const int dx = std::abs(static_cast<int>(cells[i].first) - static_cast<int>(cells[i - 1].first));
+        const int dy = std::abs(static_cast<int>(cells[i].second) - static_cast<int>(cells[i - 1].second));
+        EXPECT_EQ(dx + dy, 1) << "step " << i;
+    }
+}
+
+TEST(PixelOrder, GridOrderCoversEveryCellOnce) {
+    for (const TPixelOrder order : {TPixelOrder::RowMajor, TPixelOrder::Morton, TPixelOrder::Hilbert}) {
+        std::vector<uint32_t> cells = gridOrder(13, 5, order);
+        ASSERT_EQ(cells.size(), 65u);
+        std::sort(cells.begin(), cells.end());
+        for (uint32_t i = 0; i < cells.size(); i++) {
+            EXPECT_EQ(cells[i], i);
+        }
+    }
+    EXPECT_TRUE(gridOrder(0, 4, TPixelOrder::Hilbert).empty());
+}
+
+TEST(PixelOrder, GridOrderFollowsCurve) {
+    EXPECT_EQ(gridOrder(3, 2, TPixelOrder::RowMajor), (std::vector<uint32_t>{0, 1, 2, 3, 4, 5}));
+    // Z over the 4x4 grid covering the 3x2 one
+    EXPECT_EQ(gridOrder(3, 2, TPixelOrder::Morton), (std::vector<uint32_t>{0, 1, 3, 4, 2, 5}));
+    EXPECT_EQ(gridOrder(2, 2, TPixelOrder::Hilbert), (std::vector<uint32_t>{0, 2, 3, 1}));
+}
+
+TEST(PixelOrder, CostliestFirstKeepsIndexOrderOfTies) {
+    std::vector<uint32_t> order;
+    costliestFirst({0.5, 2.0, 0.5, 3.0, 0.0}, order);
+    EXPECT_EQ(order, (std::vector<uint32_t>{3, 1, 0, 2, 4}));
+    costliestFirst({0.0, 0.0, 0.0}, order);
+    EXPECT_EQ(order, (std::vector<uint32_t>{0, 1, 2}));
+}
+
+TEST(PixelOrder, CostliestFirstSortsWithinNodeBlocks) {
+    std::vector<uint32_t> order;
+    costliestFirst({0.5, 2.0, 1.0, 0.5, 3.0, 0.0, 4.0}, order, 2);
+    EXPECT_EQ(order, (std::vector<uint32_t>{1, 2, 0, 6, 4, 3, 5}));
+}
@@ -379,3 +379,21 @@ TEST(TPlane, Intersection_WithVerticalPlaneAndHorizontalPlane) {
     EXPECT_EQ(line.Point, (TPoint{0, 0, 0}));
     EXPECT_EQ(line.Vector, (TVector{1, 0, 0} ^ TVector{0, 0, 1}));
 }
+
+TEST(TPlane, Hit_ReturnsParameterAndNormal) {
+    TPlane plane(TPoint{0, 0, 0}, TVector{0, 0, 2});
+    TLine line(TPoint{1, 1, 2}, TVector{0, 0, -1});
+    std::optional<THit> result = plane.hit(line, -INF, INF);
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result.value().T, 2.0);
+    EXPECT_EQ(result.value().Point, (TPoint{1, 1, 0}));
+    EXPECT_EQ(result.value().Normal, (TVector{0, 0, 1}));
+}
+
+TEST(TPlane, Hit_OutsideParameterIntervalIsRejected) {
+    TPlane plane(TPoint{0, 0, 0}, TVector{0, 0, 1});
+    TLine line(TPoint{1, 1, 2}, TVector{0, 0, -1});
+    EXPECT_TRUE(plane.hit(line, 0.0, 2.0).has_value());
+    EXPECT_FALSE(plane.hit(line, 0.0, 1.5).has_value());
+    EXPECT_FALSE(plane.hit(line, 2.5, INF).has_value());
+}
@@ -446,4 +446,53 @@ TEST(TPolygon, HashDifferentPolygons) {
     size_t hash1 = std::hash<TPolygon>()(p1);
     size_t hash2 = std::hash<TPolygon>()(p2);
     EXPECT_NE(hash1, hash2);
-}
\ No newline at end of file
+}
+TEST(TPolygon, HitReportsNearestEdge) {
+    TPolygon square = CreateSquare();
+    TLine line(TPoint(0.9, 0.3, -1), TPoint(0.9, 0.3, 1));
+    std::optional<THit> hit = square.hit(line, -INF, INF);
+    ASSERT_TRUE(hit.has_value());
+    EXPECT_EQ(hit.value().Containment, TPointContainment::Inside);
+    EXPECT_EQ(hit.value().EdgeDistance, 0.1);
+    const TPoint edgeStart = square.getPoints()[hit.value().EdgeIndex];
+    const TPoint edgeEnd = square.getPoints()[(hit.value().EdgeIndex + 1) % square.getPoints().size()];
+    EXPECT_EQ(edgeStart.X, 1.0);
+    EXPECT_EQ(edgeEnd.X, 1.0);
+}
+
+TEST(TPolygon, MovePointsRecomputesShape) {
+    TPolygon polygon({TPoint(0, 0, 0), TPoint(1, 0, 0), TPoint(1, 1, 0), TPoint(0, 1, 0)});
+    EXPECT_TRUE(polygon.getEdgesIsEqual());
+    const TVector normal = polygon.getPlane().Normal;
+
+    // stretched along x and lifted as a whole
+    std::vector<TPoint> moved;
+    for (const TPoint& point : polygon.getPoints()) {
+        moved.emplace_back(point.X * 2.0, point.Y, point.Z + 1.0);
+    }
+    polygon.movePoints(moved);
+    EXPECT_EQ(polygon.getPoints(), moved);
+    EXPECT_FALSE(polygon.getEdgesIsEqual());
+    EXPECT_TRUE(polygon.getAnglesIsEqual());
+    EXPECT_EQ(polygon.getPlane().Normal, normal);
+    EXPECT_EQ(polygon.containsPoint(TPoint(1.5, 0.5, 1)), TPointContainment::Inside);
+    EXPECT_EQ(polygon.containsPoint(TPoint(0.5, 0.5, 0)), TPointContainment::Outside);
+}
+
+TEST(TPolygon, MovePointsOutOfPlaneOrConvexityThrows) {
+    TPolygon polygon({TPoint(0, 0, 0), TPoint(1, 0, 0), TPoint(1, 1, 0), TPoint(0, 1, 0)});
+    const std::vector<TPoint> points = polygon.getPoints();
+
+    std::vector<TPoint> bent = points;
+    bent[3].Z = 0.5;
+    EXPECT_THROW(polygon.movePoints(bent), std::runtime_error);
+
+    // the third point pulled past the diagonal of its neighbours makes a dent
+    std::vector<TPoint> dented = points;
+    const TPoint middle = points[1] + (points[3] - points[1]) * 0.5;
+    dented[2] = middle + (middle - points[2]) * 0.5;
+    EXPECT_THROW(polygon.movePoints(dented), std::runtime_error);
+
+    EXPECT_EQ(polygon.getPoints(), points);
+    EXPECT_TRUE(polygon.getEdgesIsEqual());
+}
@@ -216,3 +216,155 @@ TEST(TPolyhedron, CreateRegularIcosahedron) {
         EXPECT_EQ(face.getPoints()[0].distToPoint(face.getPoints()[1]), 16.0);
     }
 }
+
+TEST(TPolyhedron, HitReportsParameterFaceAndNormal) {
+    TPolyhedron poly(FACES);
+    TRay ray(TPoint(0.5, 0.5, -1), TVector(0, 0, 2));
+    std::optional<THit> hit = poly.hit(ray, 0.0, INF);
+    ASSERT_TRUE(hit.has_value());
+    EXPECT_EQ(hit.value().T, 0.5);
+    EXPECT_EQ(hit.value().Point, TPoint(0.5, 0.5, 0));
+    EXPECT_TRUE(hit.value().Normal.isParallel(TVector(0, 0, 1)));
+    ASSERT_LT(hit.value().FaceIndex, poly.getFaces().size());
+    EXPECT_EQ(poly.getFaces()[hit.value().FaceIndex].getPlane().distToPoint(hit.value().Point), 0.0);
+    EXPECT_EQ(hit.value().EdgeDistance, 0.5);
+}
+
+TEST(TPolyhedron, HitRespectsParameterInterval) {
+    TPolyhedron poly(FACES);
+    TRay ray(TPoint(0.5, 0.5, -1), TVector(0, 0, 2));
+    EXPECT_FALSE(poly.hit(ray, 0.0, 0.4).has_value());
+    std::optional<THit> farHit = poly.hit(ray, 0.6, INF);
+    ASSERT_TRUE(farHit.has_value());
+    EXPECT_EQ(farHit.value().T, 1.0);
+    EXPECT_EQ(farHit.value().Point.Z, 1.0);
+}
+
+TEST(TPolyhedron, FaceNormalsLookOutward) {
+    const std::vector<TPolyhedron> solids{
+        TPolyhedron(FACES),
+        createRegularTetrahedron(TPoint{1, 2, 3}, 1.0),
+        createRegularOctahedron(TPoint(), 4.0),
+        createRegularDodecahedron(TPoint{-1, 2, -3.2}, 8.0),
+        createRegularIcosahedron(TPoint(), 16.0),
+    };
+    for (const auto& solid : solids) {
+        for (const auto& face : solid.getFaces()) {
+            for (const auto& otherFace : solid.getFaces()) {
+                for (const auto& point : otherFace.getPoints()) {
+                    EXPECT_LE((point - face.getPlane().Point) * face.getPlane().Normal, 0.0);
+                }
+            }
+        }
+    }
+}
+
+TEST(TPolyhedron, OrientedFacesKeepAdjacentPoints) {
+    const TPolyhedron dodecahedron = createRegularDodecahedron(TPoint{-1, 2, -3.2}, 8.0);
+    for (const auto& face : dodecahedron.getFaces()) {
+        const std::vector<TPoint>& points = face.getPoints();
+        for (size_t i = 0; i < points.size(); i++) {
+            EXPECT_EQ(points[i].distToPoint(points[(i + 1) % points.size()]), 8.0);
+        }
+    }
+}
+
+TEST(TPolyhedron, BackFaceCullingKeepsHitsFromOutside) {
+    TPolyhedron dodecahedron = createRegularDodecahedron(TPoint{0, 0, 0}, 1.0);
+    const TRay ray{TPoint{3, 2, 1}, TVector{-3, -2.1, -0.9}};
+    const std::optional<THit> expected = dodecahedron.hit(ray, 0.0, INF);
+
+    dodecahedron.setBackFaceCulling(true);
+    EXPECT_TRUE(dodecahedron.getBackFaceCulling());
+    const std::optional<THit> culled = dodecahedron.hit(ray, 0.0, INF);
+
+    ASSERT_TRUE(expected.has_value());
+    ASSERT_TRUE(culled.has_value());
+    EXPECT_EQ(culled.value().Point, expected.value().Point);
+    EXPECT_EQ(culled.value().FaceIndex, expected.value().FaceIndex);
+    EXPECT_LT(ray.Vector * culled.value().Normal, 0.0);
+}
+
+TEST(TPolyhedron, BackFaceCullingSkipsExitFaces) {
+    TPolyhedron poly(FACES);
+    const TRay ray(TPoint(0.5, 0.5, 0.5), TVector(0, 0, 1));
+    EXPECT_TRUE(poly.hit(ray, 0.0, INF).has_value());
+
+    poly.setBackFaceCulling(true);
+    EXPECT_FALSE(poly.hit(ray, 0.0, INF).has_value());
+    EXPECT_FALSE(poly.anyHit(ray, 0.0, INF).has_value());
+}
+
+static std::optional<THit> nearestFaceHit(const TPolyhedron& poly, const TRay& ray) {
+    std::optional<THit> nearest;
+    for (const auto& face : poly.getFaces()) {
+        std::optional<THit> faceHit = face.hit(ray, 0.0, INF);
+        if (faceHit.has_value() && (!nearest.has_value() || faceHit.value().T < nearest.value().T)) {
+            nearest = faceHit;
+        }
+    }
+    return nearest;
+}
+
+TEST(TPolyhedron, RegularSolidsAreConvex) {
+    EXPECT_TRUE(TPolyhedron(FACES).getIsConvex());
+    EXPECT_TRUE(createRegularTetrahedron(TPoint{1, 2, 3}, 1.0).getIsConvex());
+    EXPECT_TRUE(createRegularDodecahedron(TPoint(), 1.0).getIsConvex());
+    EXPECT_TRUE(createRegularIcosahedron(TPoint(), 1.0).getIsConvex());
+}
+
+TEST(TPolyhedron, ConvexHitMatchesNearestFaceHit) {
+    const TPolyhedron dodecahedron = createRegularDodecahedron(TPoint{0.2, -0.1, 0.3}, 1.0);
+    for (size_t i = 0; i < 50; i++) {
+        const double angle = 0.37 * static_cast<double>(i);
+        const TRay ray{TPoint{4 * std::cos(angle), 4 * std::sin(angle), 1.5 - 0.06 * static_cast<double>(i)},
+                       TVector{-4 * std::cos(angle), -4 * std::sin(angle), -1.0}};
+        const std::optional<THit> expected = nearestFaceHit(dodecahedron, ray);
+        const std::optional<THit> actual = dodecahedron.hit(ray, 0.0, INF);
+        ASSERT_EQ(actual.has_value(), expected.has_value());
+        if (actual.has_value()) {
+            EXPECT_EQ(actual.value().T, expected.value().T);
+            EXPECT_EQ(actual.value().Point, expected.value().Point);
+            EXPECT_EQ(actual.value().Containment, expected.value().Containment);
+            EXPECT_LT(ray.Vector * actual.value().Normal, 0.0);
+        }
+    }
+}
+
+TEST(TPolyhedron, ConvexHitReportsEdges) {
+    TPolyhedron poly(FACES);
+    const std::optional<THit> edgeHit = poly.hit(TRay(TPoint(0.5, 0.001, -1), TVector(0, 0, 1)), 0.0, INF);
+    ASSERT_TRUE(edgeHit.has_value());
+    EXPECT_EQ(edgeHit.value().Containment, TPointContainment::OnBoundary);
+    EXPECT_EQ(edgeHit.value().EdgeDistance, 0.001);
+
+    const std::optional<THit> innerHit = poly.hit(TRay(TPoint(0.5, 0.5, -1), TVector(0, 0, 1)), 0.0, INF);
+    ASSERT_TRUE(innerHit.has_value());
+    EXPECT_EQ(innerHit.value().Containment, TPointContainment::Inside);
+}
+
+TEST(TPolyhedron, DentedPolyhedronUsesFaceLoop) {
+    const TPoint b1(0, 0, 0), b2(2, 0, 0), b3(2, 2, 0), b4(0, 2, 0);
+    const TPoint top(1, 1, 2), dent(1, 1, 1);
+    const TPolyhedron dented({TPolygon{{b1, b2, top}}, TPolygon{{b2, b3, top}}, TPolygon{{b3, b4, top}},
+                              TPolygon{{b4, b1, top}}, TPolygon{{b1, b2, dent}}, TPolygon{{b2, b3, dent}},
+                              TPolygon{{b3, b4, dent}}, TPolygon{{b4, b1, dent}}});
+    EXPECT_FALSE(dented.getIsConvex());
+
+    const TRay ray(TPoint(0.8, 1.1, -5), TVector(0, 0, 1));
+    const std::optional<THit> expected = nearestFaceHit(dented, ray);
+    const std::optional<THit> actual = dented.hit(ray, 0.0, INF);
+    ASSERT_TRUE(expected.has_value());
+    ASSERT_TRUE(actual.has_value());
+    EXPECT_EQ(actual.value().Point, expected.value().Point);
+    EXPECT_EQ(actual.value().Point.Z, 0.8);
+    // the edge is the one of the nearest face
+    EXPECT_EQ(actual.value().EdgeIndex, expected.value().EdgeIndex);
+    EXPECT_EQ(actual.value().EdgeDistance, expected.value().EdgeDistance);
+
+    std::vector<std::optional<THit>> hits(1);
+    dented.intersect(std::span<const TRay>{&ray, 1}, hits);
+    ASSERT_TRUE(hits[0].has_value());
+    EXPECT_EQ(hits[0].value().EdgeIndex, expected.value().EdgeIndex);
+    EXPECT_EQ(hits[0].value().EdgeDistance, expected.value().EdgeDistance);
+}
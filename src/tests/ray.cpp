@@ -265,3 +265,17 @@ TEST(TRay, DistToPoint_VeryFarPoint) {
     TRay ray{p, v};
     EXPECT_EQ(ray.distToPoint(TPoint{1e6, 1e6, 1e6}).Value, std::sqrt(1e6 * 1e6 + 1e6 * 1e6));
 }
+
+TEST(TRay, MinParameter) {
+    TRay ray{TPoint{0.0, 0.0, 0.0}, TVector{1.0, 0.0, 0.0}};
+    TLine line{TPoint{0.0, 0.0, 0.0}, TVector{1.0, 0.0, 0.0}};
+    EXPECT_EQ(ray.minParameter(), 0.0);
+    EXPECT_EQ(line.minParameter(), -INF);
+}
+
+TEST(TRay, Parameter_BehindOrigin) {
+    TRay ray{TPoint{0.0, 0.0, 0.0}, TVector{0.0, 0.0, 2.0}};
+    TPlane plane{TPoint{0, 0, -1}, TVector{0, 0, 1}};
+    EXPECT_EQ(ray.parameter(plane).value(), -0.5);
+    EXPECT_FALSE(ray.intersection(plane).has_value());
+}
@@ -0,0 +1,140 @@
+#include "../ray_tracing_lib/all.h"
+
+#include <gtest/gtest.h>
+
+using namespace NRayTracingLib;
+
+//=== TRayBatch Tests ===
+
+static std::vector<TRay> makeFanOfRays(const TPoint& origin, size_t count) {
+    std::vector<TRay> rays;
+    for (size_t i = 0; i < count; i++) {
+        const double shift = -1.0 + 2.0 * static_cast<double>(i) / static_cast<double>(count - 1);
+        rays.emplace_back(origin, TPoint{shift, 0.3 * shift, 0.0} - origin);
+    }
+    return rays;
+}
+
+static void expectSameHits(const TFigure& figure, std::span<const TRay> rays,
+                           std::span<const std::optional<THit>> hits) {
+    for (size_t i = 0; i < rays.size(); i++) {
+        const std::optional<THit> expected = figure.hit(rays[i], 0.0, INF);
+        ASSERT_EQ(hits[i].has_value(), expected.has_value());
+        if (expected.has_value()) {
+            EXPECT_EQ(hits[i].value().T, expected.value().T);
+            EXPECT_EQ(hits[i].value().Point, expected.value().Point);
+            EXPECT_EQ(hits[i].value().FaceIndex, expected.value().FaceIndex);
+        }
+    }
+}
+
+TEST(TRayBatch, DifferentCoordinateSizesThrow) {
+    const std::vector<double> three{0.0, 0.0, 0.0};
+    const std::vector<double> two{0.0, 0.0};
+    EXPECT_THROW(TRayBatch(three, three, three, three, two, three), std::runtime_error);
+}
+
+TEST(TRayBatch, DifferentRaysAndHitsSizesThrow) {
+    const TPlane plane{TPoint{0, 0, 0}, TVector{0, 0, 1}};
+    const std::vector<TRay> rays = makeFanOfRays(TPoint{0, 0, 5}, 4);
+    std::vector<std::optional<THit>> hits(3);
+    EXPECT_THROW(plane.intersect(rays, hits), std::runtime_error);
+}
+
+TEST(TRayBatch, PlaneMatchesSingleRayQueries) {
+    const TPlane plane{TPoint{0, 0, 0}, TVector{0, 0, 1}};
+    std::vector<TRay> rays = makeFanOfRays(TPoint{0, 0, 5}, 9);
+    rays.emplace_back(TPoint{0, 0, 5}, TVector{0, 0, 1});
+    std::vector<std::optional<THit>> hits(rays.size());
+    plane.intersect(rays, hits);
+    expectSameHits(plane, rays, hits);
+    EXPECT_FALSE(hits.back().has_value());
+}
+
+TEST(TRayBatch, RayInPlaneIsMiss) {
+    const TPlane plane{TPoint{0, 0, 0}, TVector{0, 0, 1}};
+    const std::vector<TRay> rays{TRay{TPoint{0, 0, 0}, TVector{1, 0, 0}}};
+    std::vector<std::optional<THit>> hits(rays.size());
+    EXPECT_NO_THROW(plane.intersect(rays, hits));
+    EXPECT_FALSE(hits[0].has_value());
+    EXPECT_THROW(plane.hit(rays[0], 0.0, INF), TLineInPlaneError);
+}
+
+// figure whose intersections always fail with an error other than a ray lying in its plane
+class TBrokenFigure : public TFigure {
+  public:
+    std::optional<THit> hit(const TLine&, TSafeDouble, TSafeDouble) const override {
+        throw std::runtime_error("Error: broken figure");
+    }
+};
+
+TEST(TRayBatch, OtherIntersectionErrorsAreThrown) {
+    const TBrokenFigure figure;
+    const std::vector<TRay> rays{TRay{TPoint{0, 0, 0}, TVector{1, 0, 0}}};
+    std::vector<std::optional<THit>> hits(rays.size());
+    EXPECT_THROW(figure.intersect(rays, hits), std::runtime_error);
+    EXPECT_THROW(figure.intersectAny(rays, hits), std::runtime_error);
+    std::vector<uint8_t> occluded(rays.size(), false);
+    EXPECT_THROW(figure.occluded(rays, std::vector<double>{INF}, occluded), std::runtime_error);
+}
+
+TEST(TRayBatch, PolygonMatchesSingleRayQueries) {
+    const TPolygon triangle{{TPoint{-0.5, -0.5, 0}, TPoint{0.5, -0.5, 0}, TPoint{0, 0.5, 0}}};
+    const std::vector<TRay> rays = makeFanOfRays(TPoint{0, 0, 5}, 17);
+    std::vector<std::optional<THit>> hits(rays.size());
+    triangle.intersect(rays, hits);
+    expectSameHits(triangle, rays, hits);
+}
+
+TEST(TRayBatch, PolyhedronMatchesSingleRayQueries) {
+    const TPolyhedron dodecahedron = createRegularDodecahedron(TPoint{0, 0, 0}, 1.0);
+    const std::vector<TRay> rays = makeFanOfRays(TPoint{0.1, 0.2, 5}, 33);
+    std::vector<std::optional<THit>> hits(rays.size());
+    dodecahedron.intersect(rays, hits);
+    expectSameHits(dodecahedron, rays, hits);
+}
+
+TEST(TRayBatch, StructureOfArraysMatchesRays) {
+    const TPolyhedron icosahedron = createRegularIcosahedron(TPoint{0, 0, 0}, 1.0);
+    const std::vector<TRay> rays = makeFanOfRays(TPoint{0.1, 0.2, 5}, 33);
+
+    std::vector<double> ox, oy, oz, dx, dy, dz;
+    for (const auto& ray : rays) {
+        ox.push_back(ray.Point.X.Value);
+        oy.push_back(ray.Point.Y.Value);
+        oz.push_back(ray.Point.Z.Value);
+        dx.push_back(ray.Vector.X.Value);
+        dy.push_back(ray.Vector.Y.Value);
+        dz.push_back(ray.Vector.Z.Value);
+    }
+    const TRayBatch batch{ox, oy, oz, dx, dy, dz};
+    EXPECT_EQ(batch.size(), rays.size());
+
+    std::vector<std::optional<THit>> hits(rays.size());
+    icosahedron.intersect(batch, hits);
+    expectSameHits(icosahedron, rays, hits);
+}
+
+TEST(TRayBatch, AnyHitFindsHitForEveryOccludedRay) {
+    const TPolyhedron hexahedron = createRegularHexahedron(TPoint{0, 0, 0}, 1.0);
+    const std::vector<TRay> rays = makeFanOfRays(TPoint{0, 0, 5}, 21);
+    std::vector<std::optional<THit>> closest(rays.size());
+    std::vector<std::optional<THit>> any(rays.size());
+    hexahedron.intersect(rays, closest);
+    hexahedron.intersectAny(rays, any);
+    for (size_t i = 0; i < rays.size(); i++) {
+        EXPECT_EQ(any[i].has_value(), closest[i].has_value());
+        if (any[i].has_value()) {
+            EXPECT_GE(any[i].value().T, closest[i].value().T);
+        }
+    }
+}
+
+TEST(TRayBatch, FigureSetUsesDefaultBatchQueries) {
+    const TFigureSet figures{
+        {createRegularHexahedron(TPoint{0, 0, 0}, 1.0), TPlane{TPoint{0, 0, -3}, TVector{0, 0, 1}}}};
+    const std::vector<TRay> rays = makeFanOfRays(TPoint{0, 0, 5}, 9);
+    std::vector<std::optional<THit>> hits(rays.size());
+    figures.intersect(rays, hits);
+    expectSameHits(figures, rays, hits);
+}
@@ -0,0 +1,112 @@
+#include "../ray_tracing_lib/all.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+using namespace NRayTracingLib;
+
+//=== Ray Key Tests ===
+
+TEST(RayKey, OctantGoesFirst) {
+    const TBoundingBox bounds{TPoint{0, 0, 0}, TPoint{1, 1, 1}};
+    const uint32_t positive = rayKey(TPoint{1, 1, 1}, TVector{1, 1, 1}, bounds);
+    const uint32_t negative = rayKey(TPoint{0, 0, 0}, TVector{1, 1, -1}, bounds);
+    EXPECT_LT(positive, negative);
+    EXPECT_EQ(negative >> (3 * RAY_KEY_ORIGIN_BITS), 4u);
+    EXPECT_EQ(rayKey(TPoint{0, 0, 0}, TVector{-1, -1, -1}, bounds), 7u << (3 * RAY_KEY_ORIGIN_BITS));
+}
+
+TEST(RayKey, OriginMortonCode) {
+    const TBoundingBox bounds{TPoint{0, 0, 0}, TPoint{8, 8, 8}};
+    const TVector direction{1, 1, 1};
+    EXPECT_EQ(rayKey(TPoint{0, 0, 0}, direction, bounds), 0u);
+    // the highest cell of the x axis sets every third bit starting from the lowest one
+    EXPECT_EQ(rayKey(TPoint{8, 0, 0}, direction, bounds), 0x09249249u & ((1u << (3 * RAY_KEY_ORIGIN_BITS)) - 1));
+    EXPECT_EQ(rayKey(TPoint{0, 8, 0}, direction, bounds), rayKey(TPoint{8, 0, 0}, direction, bounds) << 1);
+    // points out of the bounds are clamped to them
+    EXPECT_EQ(rayKey(TPoint{-1, 20, 0}, direction, bounds), rayKey(TPoint{0, 8, 0}, direction, bounds));
+    // flat bounds do not divide by zero
+    EXPECT_EQ(rayKey(TPoint{1, 1, 1}, direction, TBoundingBox{TPoint{1, 1, 1}, TPoint{1, 1, 1}}), 0u);
+}
+
+//=== Radix Sort Tests ===
+
+static void expectSortedStable(const std::vector<uint32_t>& keys, size_t threadsCount) {
+    std::vector<uint32_t> order;
+    radixSort(keys, order, threadsCount);
+    ASSERT_EQ(order.size(), keys.size());
+    std::vector<uint32_t> expected(keys.size());
+    for (uint32_t i = 0; i < expected.size(); i++) {
+        expected[i] = i;
+    }
+    std::stable_sort(expected.begin(), expected.end(), [&](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+    EXPECT_EQ(order, expected);
+}
+
+TEST(RadixSort, SortsStable) {
+    std::mt19937 generator{1};
+    std::uniform_int_distribution<uint32_t> key{0, 1000};
+    std::vector<uint32_t> keys(5000);
+    for (auto& value : keys) {
+        value = key(generator);
+    }
+    expectSortedStable(keys, 1);
+}
+
+TEST(RadixSort, ParallelSortMatchesSingleThread) {
+    std::mt19937 generator{2};
+    std::uniform_int_distribution<uint32_t> key;
+    std::vector<uint32_t> keys(200'000);
+    for (auto& value : keys) {
+        // few distinct high bytes check the stability of the parallel scatter
+        value = key(generator) & 0x0300ffff;
+    }
+    expectSortedStable(keys, 4);
+}
+
+TEST(RadixSort, EmptyAndEqualKeys) {
+    expectSortedStable({}, 4);
+    expectSortedStable(std::vector<uint32_t>(100, 7), 1);
+}
+
+//=== Coherent Order Tests ===
+
+TEST(CoherentOrder, GroupsRaysByOctantAndOrigin) {
+    std::mt19937 generator{3};
+    std::uniform_real_distribution<double> coordinate{-10.0, 10.0};
+    std::vector<TRay> rays;
+    for (size_t i = 0; i < 1000; i++) {
+        rays.emplace_back(TPoint{coordinate(generator), coordinate(generator), coordinate(generator)},
+                          TVector{coordinate(generator), coordinate(generator), coordinate(generator)});
+    }
+    const std::vector<uint32_t> order = coherentOrder(rays);
+    ASSERT_EQ(order.size(), rays.size());
+    std::vector<bool> seen(rays.size(), false);
+    size_t octantChanges = 0;
+    for (size_t k = 0; k < order.size(); k++) {
+        ASSERT_FALSE(seen[order[k]]);
+        seen[order[k]] = true;
+        if (k > 0) {
+            const TVector& previous = rays[order[k - 1]].Vector;
+            const TVector& current = rays[order[k]].Vector;
+            octantChanges += (previous.X < 0.0) != (current.X < 0.0) || (previous.Y < 0.0) != (current.Y < 0.0) ||
+                             (previous.Z < 0.0) != (current.Z < 0.0);
+        }
+    }
+    EXPECT_EQ(octantChanges, 7u);
+}
+
+TEST(CoherentOrder, SortRaysPermutesWholeQueue) {
+    TRayQueue queue;
+    queue.push(TPoint{0, 0, 0}, TVector{-1, -1, -1}, 10, 0.5, true);
+    queue.push(TPoint{1, 1, 1}, TVector{1, 1, 1}, 20, 0.25, false);
+    queue.push(TPoint{0, 0, 0}, TVector{1, 1, 1}, 30, 1.0, false);
+    sortRays(queue);
+
+    EXPECT_EQ(queue.Pixel, (std::vector<size_t>{30, 20, 10}));
+    EXPECT_EQ(queue.Weight, (std::vector<double>{1.0, 0.25, 0.5}));
+    EXPECT_EQ(queue.Inside, (std::vector<uint8_t>{false, false, true}));
+    EXPECT_EQ(queue.ray(1).Point, (TPoint{1, 1, 1}));
+    EXPECT_EQ(queue.ray(2).Vector, (TVector{-1, -1, -1}));
+}
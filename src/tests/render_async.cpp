@@ -0,0 +1,146 @@
+#include "../ray_tracing_lib/all.h"
+
+#include <gtest/gtest.h>
+
+#include <future>
+#include <mutex>
+#include <thread>
+
+using namespace NRayTracingLib;
+
+//=== Coroutine helpers ===
+
+// coroutine started at once and never awaited, as an event loop task would be
+class TDetachedTask {
+  public:
+    class promise_type {
+      public:
+        TDetachedTask get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+static TDetachedTask renderTo(std::promise<TRenderStatus>& result, TCamera& camera, const TFigure& figure,
+                              std::stop_token stopToken = {}) {
+    result.set_value(co_await renderAsync(camera, figure, std::move(stopToken)));
+}
+
+static TDetachedTask recordResumingThread(std::promise<std::thread::id>& result, TCamera& camera,
+                                          const TFigure& figure, TExecutor executor) {
+    co_await renderAsync(camera, figure, {}, std::move(executor));
+    result.set_value(std::this_thread::get_id());
+}
+
+static TCamera makeTestCamera(const std::pair<uint16_t, uint16_t>& resolution) {
+    return TCamera{TPoint{10.0, 10.0, 10.0}, TVector{-10.0, -10.0, -10.0}, {TAngle{15.0}, TAngle{15.0}}, resolution};
+}
+
+//=== renderAsync Tests ===
+
+TEST(RenderAsync, MatchesBlockingPicture) {
+    const TPolyhedron figure = createRegularDodecahedron(TPoint{0.0, 0.0, 0.0}, 1.0);
+    TCamera expected = makeTestCamera({32, 32});
+    expected.makePicture(figure);
+
+    TCamera camera = makeTestCamera({32, 32});
+    std::promise<TRenderStatus> result;
+    renderTo(result, camera, figure);
+    EXPECT_EQ(result.get_future().get(), TRenderStatus::Done);
+    EXPECT_EQ(camera.getImageData(), expected.getImageData());
+    EXPECT_FALSE(camera.isStopped());
+}
+
+TEST(RenderAsync, ManyRendersInFlight) {
+    std::vector<TPolyhedron> figures;
+    std::vector<TCamera> cameras;
+    for (size_t i = 0; i < 4; i++) {
+        figures.push_back(createRegularDodecahedron(TPoint{0.0, 0.0, 0.0}, 0.5 + 0.2 * i));
+        cameras.push_back(makeTestCamera({24, 24}));
+    }
+    std::vector<std::promise<TRenderStatus>> results(cameras.size());
+    for (size_t i = 0; i < cameras.size(); i++) {
+        renderTo(results[i], cameras[i], figures[i]);
+    }
+    for (size_t i = 0; i < cameras.size(); i++) {
+        EXPECT_EQ(results[i].get_future().get(), TRenderStatus::Done);
+        TCamera expected = makeTestCamera({24, 24});
+        expected.makePicture(figures[i]);
+        EXPECT_EQ(cameras[i].getImageData(), expected.getImageData());
+    }
+}
+
+TEST(RenderAsync, StopBeforeStartKeepsPicture) {
+    const TPolyhedron figure = createRegularDodecahedron(TPoint{0.0, 0.0, 0.0}, 1.0);
+    TCamera camera = makeTestCamera({16, 16});
+    std::stop_source stopSource;
+    stopSource.request_stop();
+    std::promise<TRenderStatus> result;
+    renderTo(result, camera, figure, stopSource.get_token());
+    EXPECT_EQ(result.get_future().get(), TRenderStatus::Stopped);
+    EXPECT_TRUE(std::all_of(camera.getImageData().begin(), camera.getImageData().end(),
+                            [](uint8_t byte) { return byte == 0; }));
+
+    // the token is not kept by the camera after the picture
+    camera.makePicture(figure);
+    EXPECT_FALSE(camera.isStopped());
+}
+
+TEST(RenderAsync, StopDuringPictureSkipsRemainingRows) {
+    const TPolyhedron figure = createRegularDodecahedron(TPoint{0.0, 0.0, 0.0}, 1.0);
+    // each pool thread starts a row at most before the stop, so the picture is many times taller than the pool
+    const size_t height = std::max<size_t>(64, 16 * threadPool().getThreadsCount());
+    TCamera camera = makeTestCamera({16, static_cast<uint16_t>(height)});
+    camera.makePicture(figure);
+    const std::vector<double> previousCosts = camera.getSpanCosts();
+    std::stop_source stopSource;
+    std::atomic<size_t> rowsCount = 0;
+    camera.setTileCallback([&](const TPixelRect&) {
+        rowsCount++;
+        stopSource.request_stop();
+    });
+    std::promise<TRenderStatus> result;
+    renderTo(result, camera, figure, stopSource.get_token());
+    EXPECT_EQ(result.get_future().get(), TRenderStatus::Stopped);
+    // only the rows already taken by the pool threads are finished
+    EXPECT_LT(rowsCount, height);
+    EXPECT_TRUE(camera.isStopped());
+    // skipped rows keep the costs of the previous picture
+    const std::vector<double>& costs = camera.getSpanCosts();
+    size_t keptCount = 0;
+    for (size_t row = 0; row < height; row++) {
+        keptCount += costs[row] == previousCosts[row] ? 1 : 0;
+    }
+    EXPECT_GE(keptCount, height - rowsCount);
+}
+
+TEST(RenderAsync, ResumesThroughExecutor) {
+    const TPolyhedron figure = createRegularDodecahedron(TPoint{0.0, 0.0, 0.0}, 1.0);
+    TCamera camera = makeTestCamera({32, 32});
+    // event loop of this thread
+    std::mutex mutex;
+    std::vector<std::function<void()>> tasks;
+    const TExecutor executor = [&](std::function<void()> task) {
+        const std::lock_guard lock{mutex};
+        tasks.push_back(std::move(task));
+    };
+
+    std::promise<std::thread::id> result;
+    std::future<std::thread::id> resumingThread = result.get_future();
+    recordResumingThread(result, camera, figure, executor);
+    while (resumingThread.wait_for(std::chrono::milliseconds{1}) != std::future_status::ready) {
+        std::vector<std::function<void()>> readyTasks;
+        {
+            const std::lock_guard lock{mutex};
+            readyTasks.swap(tasks);
+        }
+        for (const auto& task : readyTasks) {
+            task();
+        }
+    }
+    // either resumed by the loop or never suspended, as without pool workers
+    EXPECT_EQ(resumingThread.get(), std::this_thread::get_id());
+    EXPECT_FALSE(camera.isStopped());
+}
@@ -0,0 +1,65 @@
+#include "../ray_tracing_lib/all.h"
+
+#include <gtest/gtest.h>
+
+using namespace NRayTracingLib;
+
+//=== TTransform Tests ===
+
+TEST(TTransform, DefaultIsIdentity) {
+    const TTransform identity;
+    EXPECT_EQ(identity.apply(TPoint{1, 2, 3}), (TPoint{1, 2, 3}));
+    EXPECT_EQ(identity.apply(TVector{1, 2, 3}), (TVector{1, 2, 3}));
+}
+
+TEST(TTransform, TranslationMovesPointsOnly) {
+    const TTransform shift = TTransform::translation(TVector{1, -2, 3});
+    EXPECT_EQ(shift.apply(TPoint{0, 0, 0}), (TPoint{1, -2, 3}));
+    EXPECT_EQ(shift.apply(TVector{1, 1, 1}), (TVector{1, 1, 1}));
+}
+
+TEST(TTransform, Rotation) {
+    const TTransform rotation = TTransform::rotation(TVector{0, 0, 1}, TAngle{90.0});
+    EXPECT_EQ(rotation.apply(TPoint{1, 0, 0}), (TPoint{0, 1, 0}));
+    EXPECT_EQ(rotation.apply(TVector{0, 1, 0}), (TVector{-1, 0, 0}));
+    EXPECT_EQ(rotation.apply(TVector{0, 0, 2}), (TVector{0, 0, 2}));
+}
+
+TEST(TTransform, CompositionAppliesRightFirst) {
+    const TTransform shift = TTransform::translation(TVector{1, 0, 0});
+    const TTransform scale = TTransform::scaling(2.0);
+    EXPECT_EQ((scale * shift).apply(TPoint{0, 0, 0}), (TPoint{2, 0, 0}));
+    EXPECT_EQ((shift * scale).apply(TPoint{0, 0, 0}), (TPoint{1, 0, 0}));
+}
+
+TEST(TTransform, InverseUndoesTransform) {
+    const TTransform transform = TTransform::translation(TVector{1, 2, 3}) *
+                                 TTransform::rotation(TVector{1, 1, 0}, TAngle{30.0}) * TTransform::scaling(0.5);
+    const TTransform inverse = transform.inverse();
+    EXPECT_EQ(inverse.apply(transform.apply(TPoint{-3, 4, 0.5})), (TPoint{-3, 4, 0.5}));
+    EXPECT_EQ(transform.apply(inverse.apply(TVector{1, 0, -1})), (TVector{1, 0, -1}));
+}
+
+TEST(TTransform, DegenerateTransformsThrow) {
+    EXPECT_THROW(TTransform::scaling(0.0), std::runtime_error);
+    EXPECT_THROW(TTransform::rotation(TVector{0, 0, 0}, TAngle{10.0}), std::runtime_error);
+    const TTransform flat{{{{1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 0, 0}}}};
+    EXPECT_THROW(flat.inverse(), std::runtime_error);
+}
+
+TEST(TTransform, NormalsStayPerpendicular) {
+    // stretching along X tilts the normal of the plane x + z = 0 towards Z
+    const TTransform stretch{{{{2, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}}}};
+    const TVector tangent = stretch.apply(TVector{1, 0, -1});
+    const TVector normal = stretch.inverse().applyTransposed(TVector{1, 0, 1});
+    EXPECT_TRUE(normal.isPerpendicular(tangent));
+}
+
+TEST(TTransform, BoxIsTransformedByCorners) {
+    const TTransform rotation = TTransform::rotation(TVector{0, 0, 1}, TAngle{45.0});
+    const TBoundingBox box = rotation.apply(TBoundingBox{TPoint{-1, -1, 0}, TPoint{1, 1, 1}});
+    EXPECT_EQ(box.Min, (TPoint{-std::sqrt(2.0), -std::sqrt(2.0), 0}));
+    EXPECT_EQ(box.Max, (TPoint{std::sqrt(2.0), std::sqrt(2.0), 1}));
+    EXPECT_TRUE(rotation.apply(TBoundingBox::infinite()).isInfinite());
+    EXPECT_TRUE(rotation.apply(TBoundingBox{}).isEmpty());
+}
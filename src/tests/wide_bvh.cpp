@@ -0,0 +1,183 @@
+#include "../ray_tracing_lib/all.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+using namespace NRayTracingLib;
+
+namespace {
+
+std::vector<TBoundingBox> randomBoxes(size_t count) {
+    std::mt19937 generator{11};
+    std::uniform_real_distribution<double> coordinate{-50.0, 50.0};
+    std::uniform_real_distribution<double> extent{0.0, 2.0};
+    std::vector<TBoundingBox> boxes;
+    for (size_t i = 0; i < count; i++) {
+        const TPoint min{coordinate(generator), coordinate(generator), coordinate(generator)};
+        boxes.emplace_back(min, min + TVector{extent(generator), extent(generator), extent(generator)});
+    }
+    return boxes;
+}
+
+bool contains(const TBoundingBox& outer, const TBoundingBox& inner) {
+    return outer.Min.X.Value <= inner.Min.X.Value && outer.Min.Y.Value <= inner.Min.Y.Value &&
+           outer.Min.Z.Value <= inner.Min.Z.Value && outer.Max.X.Value >= inner.Max.X.Value &&
+           outer.Max.Y.Value >= inner.Max.Y.Value && outer.Max.Z.Value >= inner.Max.Z.Value;
+}
+
+} // namespace
+
+//=== TWideBvh Tests ===
+
+TEST(TWideBvh, NodeFitsCacheLine) {
+    EXPECT_EQ(sizeof(TWideBvhNode), 64u);
+    EXPECT_EQ(alignof(TWideBvhNode), 64u);
+}
+
+TEST(TWideBvh, EmptyBvhHasNoNodes) {
+    const TWideBvh wide{TBvh{{}}};
+    EXPECT_TRUE(wide.getNodes().empty());
+}
+
+TEST(TWideBvh, SingleLeafRoot) {
+    const TBvh bvh{randomBoxes(1)};
+    const TWideBvh wide{bvh};
+    ASSERT_EQ(wide.getNodes().size(), 1u);
+    EXPECT_EQ(wide.getNodes()[0].ChildCount[0], 1u);
+    EXPECT_EQ(wide.getNodes()[0].ChildCount[1], TWideBvhNode::EMPTY_CHILD);
+}
+
+TEST(TWideBvh, QuantizedLeavesContainPrimitives) {
+    const std::vector<TBoundingBox> boxes = randomBoxes(5000);
+    const TBvh bvh{boxes};
+    const TWideBvh wide{bvh};
+    EXPECT_LT(wide.getNodes().size(), bvh.getNodes().size() / 2);
+    EXPECT_LT(wide.getMemorySize(), bvh.getMemorySize());
+
+    size_t inLeaves = 0;
+    for (const auto& node : wide.getNodes()) {
+        for (size_t child = 0; child < WIDE_BVH_WIDTH; child++) {
+            if (node.ChildCount[child] == 0 || node.ChildCount[child] == TWideBvhNode::EMPTY_CHILD) {
+                continue;
+            }
+            for (uint32_t i = node.Child[child]; i < node.Child[child] + node.ChildCount[child]; i++) {
+                EXPECT_TRUE(contains(node.childBox(child), boxes[wide.getPrimitives()[i]]));
+                inLeaves++;
+            }
+        }
+    }
+    EXPECT_EQ(inLeaves, boxes.size());
+}
+
+TEST(TWideBvh, SimdAndScalarTestsAgree) {
+    const TWideBvh wide{TBvh{randomBoxes(2000)}};
+
+    std::mt19937 generator{13};
+    std::uniform_real_distribution<double> coordinate{-60.0, 60.0};
+    for (size_t i = 0; i < 100; i++) {
+        const TPoint origin{coordinate(generator), coordinate(generator), coordinate(generator)};
+        // axis aligned directions check the handling of infinite inverse coordinates
+        const TVector direction = (i % 4 == 0) ? TVector{0, 0, 1}
+                                                : TVector{coordinate(generator), coordinate(generator),
+                                                          coordinate(generator)};
+        const TWideBvhRay ray{origin, direction};
+        for (const auto& node : wide.getNodes()) {
+            std::array<float, WIDE_BVH_WIDTH> entries;
+            std::array<float, WIDE_BVH_WIDTH> scalarEntries;
+            const float tMax = std::numeric_limits<float>::infinity();
+            const uint32_t mask = node.intersectChildren(ray, 0.0f, tMax, entries);
+            ASSERT_EQ(mask, node.intersectChildrenScalar(ray, 0.0f, tMax, scalarEntries));
+            for (size_t child = 0; child < WIDE_BVH_WIDTH; child++) {
+                if (mask & (1u << child)) {
+                    EXPECT_FLOAT_EQ(entries[child], scalarEntries[child]);
+                }
+            }
+        }
+    }
+}
+
+TEST(TWideBvh, TraversalVisitsSameLeavesAsBinary) {
+    const std::vector<TBoundingBox> boxes = randomBoxes(3000);
+    const TBvh bvh{boxes};
+    const TWideBvh wide{bvh};
+
+    std::mt19937 generator{17};
+    std::uniform_real_distribution<double> coordinate{-60.0, 60.0};
+    for (size_t i = 0; i < 100; i++) {
+        const TPoint origin{coordinate(generator), coordinate(generator), coordinate(generator)};
+        const TVector direction{coordinate(generator), coordinate(generator), coordinate(generator)};
+
+        // every primitive whose exact box is crossed must be visited by both trees
+        std::vector<bool> binaryVisited(boxes.size());
+        std::vector<bool> wideVisited(boxes.size());
+        bvh.traverse(origin, direction, 0.0, INF, [&](uint32_t primitive, double&, double&) {
+            binaryVisited[primitive] = true;
+        });
+        wide.traverse(origin, direction, 0.0, INF, [&](uint32_t primitive, double&, double&) {
+            wideVisited[primitive] = true;
+        });
+        for (size_t primitive = 0; primitive < boxes.size(); primitive++) {
+            if (boxes[primitive].intersects(origin, direction, 0.0, INF)) {
+                EXPECT_TRUE(binaryVisited[primitive]);
+                EXPECT_TRUE(wideVisited[primitive]);
+            }
+        }
+    }
+}
+
+TEST(TWideBvh, TraversalVisitsNearerLeavesFirst) {
+    std::vector<TBoundingBox> row;
+    for (int x = 0; x < 64; x++) {
+        row.emplace_back(TPoint{x - 0.25, -0.25, -0.25}, TPoint{x + 0.25, 0.25, 0.25});
+    }
+    const TWideBvh wide{TBvh{row}};
+
+    for (const double sign : {1.0, -1.0}) {
+        std::vector<uint32_t> visited;
+        wide.traverse(TPoint{31.5 - sign * 100, 0, 0}, TVector{sign, 0, 0}, 0.0, INF,
+                      [&](uint32_t primitive, double&, double&) { visited.push_back(primitive); });
+        ASSERT_EQ(visited.size(), row.size());
+        for (size_t i = 1; i < visited.size(); i++) {
+            EXPECT_GT(sign * visited[i], sign * visited[i - 1]);
+        }
+    }
+}
+
+TEST(TWideBvh, VisitorCanStopTraversal) {
+    const std::vector<TBoundingBox> boxes = randomBoxes(1000);
+    const TWideBvh wide{TBvh{boxes}};
+    size_t visited = 0;
+    const TPoint origin{-60, 0, 0};
+    wide.traverse(origin, boxes[0].center() - origin, 0.0, INF, [&](uint32_t, double&, double&) {
+        visited++;
+        return true;
+    });
+    EXPECT_EQ(visited, 1u);
+}
+
+TEST(TWideBvh, RayTouchingQuantizedUpperBoundIsNotLost) {
+    // far from the origin a float step is coarser than the grid of small children, so decoded bounds are rounded
+    std::vector<TBoundingBox> boxes;
+    for (size_t i = 0; i < 256; i++) {
+        const double x = 100000.0 + std::ldexp(static_cast<double>(i * 3), -10);
+        const double y = 100000.0 + std::ldexp(static_cast<double>(i % 16 * 5), -9);
+        boxes.emplace_back(TPoint{x, y, -100000.0},
+                           TPoint{x + std::ldexp(1.0, -10), y + std::ldexp(3.0, -10), -99999.0});
+    }
+    const TBvh bvh{boxes};
+    const TWideBvh wide{bvh};
+
+    for (size_t primitive = 0; primitive < boxes.size(); primitive++) {
+        const TBoundingBox& box = boxes[primitive];
+        // the ray enters the box through its upper x face exactly at tMax
+        const TPoint origin{box.Max.X.Value + 1.0, (box.Min.Y.Value + box.Max.Y.Value) / 2.0, -99999.5 - 1.0};
+        const TVector direction{-1.0, 0.0, 1.0};
+        ASSERT_TRUE(box.intersects(origin, direction, 0.0, 1.0));
+        bool visited = false;
+        wide.traverse(origin, direction, 0.0, 1.0, [&](uint32_t visitedPrimitive, double&, double&) {
+            visited = visited || visitedPrimitive == primitive;
+        });
+        EXPECT_TRUE(visited) << primitive;
+    }
+}